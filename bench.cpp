@@ -0,0 +1,2428 @@
+#include "stdio.h"
+#include "stdint.h"
+#include "malloc.h"
+#include "assert.h"
+#include "stdarg.h"
+#include "math.h"
+#include "string.h"
+#include <chrono>
+
+#define global_variable static
+#define internal static
+#define ArrayCount(Array) ((sizeof(Array)) / (sizeof(Array[0])))
+#define Assert(Expression) if(!(Expression)) {*(int *)0=0;}
+
+typedef char utf8;
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef s32 b32;
+typedef float r32;
+typedef double r64;
+
+// note: build with -DLS_SVG_TRACE for the parser zones in --trace, without it the trace is empty
+#include "ls_svg_trace.h"
+
+#define LS_STRING_IMPLEMENTATION
+#include "ls_string.h"
+#include "ls_svg.h"
+#include "ls_svg_hit.h"
+#include "ls_svg_raster.h"
+#include "ls_svg_jobs.h"
+#include "ls_svg_tiles.h"
+#include "ls_svg_stream.h"
+#include "ls_svg_sdf.h"
+#include "ls_svg_atlas.h"
+#include "ls_svg_tess.h"
+#include "ls_svg_measure.h"
+#include "ls_svg_stroke.h"
+#include "ls_svg_simplify.h"
+#include "ls_svg_lod.h"
+#include "ls_svg_pack.h"
+#include "ls_svg_dedup.h"
+#include "ls_svg_write.h"
+#include "ls_svg_alloc.h"
+#include "ls_svg_edit.h"
+
+struct file {
+    u8 *Data;
+    u32 Size;
+};
+
+b32
+ReadFile(char *Name, file *File_out)
+{
+    file File = {};
+
+    FILE *F = fopen(Name, "rb");
+
+    if (!F) {
+        return false;
+    }
+
+    fseek(F, 0, SEEK_END);
+    File.Size = ftell(F);
+    fseek(F, 0, SEEK_SET);
+
+    File.Data = (u8 *)malloc(File.Size);
+    fread(File.Data, 1, File.Size, F);
+    fclose(F);
+
+    *File_out = File;
+
+    return true;
+}
+
+r64
+BenchSeconds()
+{
+    auto Now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<r64>(Now).count();
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+RASTERIZER */
+
+// note: budget for one 64px icon render, the bench reports whether it holds
+#define BENCH_RASTER_TARGET_US 40.0
+
+void
+BenchRaster(svg *Svg, u32 Size, u32 Iterations)
+{
+    svg_image Image = {};
+    Image.Width = Size;
+    Image.Height = Size;
+    Image.Pitch = Size * 4;
+    Image.Pixels = (u8 *)malloc(Size * Size * 4);
+
+    svg_rasterizer Rasterizer = {};
+    svg_transform Transform = SvgScaleTransform(Size / 64.0f);
+
+    r64 Best = 1e9;
+
+    for (u32 Run=0; Run<5; ++Run) {
+        r64 Start = BenchSeconds();
+
+        for (u32 i=0; i<Iterations; ++i) {
+            memset(Image.Pixels, 0, Size * Size * 4);
+            SvgRasterize(&Rasterizer, Svg, &Image, Transform);
+        }
+
+        r64 Elapsed = (BenchSeconds() - Start) / Iterations;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    r64 Us = Best * 1e6;
+    r64 MPixels = (Size * Size) / Best / 1e6;
+
+    if (Size == 64) {
+        printf("raster %4upx: %9.2f us  %8.1f Mpx/s  (target %.1f us: %s)\n", Size, Us, MPixels,
+               BENCH_RASTER_TARGET_US, Us <= BENCH_RASTER_TARGET_US ? "ok" : "MISSED");
+    } else {
+        printf("raster %4upx: %9.2f us  %8.1f Mpx/s\n", Size, Us, MPixels);
+    }
+
+    free(Image.Pixels);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+TILED RENDERER */
+
+// note: xorshift32, the generated documents have to be the same on every run
+u32
+BenchRandom(u32 *State)
+{
+    u32 X = *State;
+    X ^= X << 13;
+    X ^= X >> 17;
+    X ^= X << 5;
+    *State = X;
+    return X;
+}
+
+r32
+BenchRandomRange(u32 *State, r32 Min, r32 Max)
+{
+    return Min + (Max - Min) * (BenchRandom(State) >> 8) * (1.0f / 16777216.0f);
+}
+
+// note: Count overlapping blobs and rings spread over a Size x Size canvas
+void
+BenchDenseSvg(ls_stringbuf *Out, u32 Count, r32 Size, u32 Seed)
+{
+    u32 State = Seed ? Seed : 1;
+
+    Out->AppendF("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 %.0f %.0f\">\n", Size, Size);
+
+    for (u32 i=0; i<Count; ++i) {
+        r32 X = BenchRandomRange(&State, 0.0f, Size);
+        r32 Y = BenchRandomRange(&State, 0.0f, Size);
+        r32 R = BenchRandomRange(&State, 4.0f, Size / 32.0f);
+        u32 Color = BenchRandom(&State) & 0xffffff;
+
+        Out->AppendF("<path fill=\"#%06x\" d=\"M %.2f %.2f", Color, X + R, Y);
+
+        if (i % 4 == 0) {
+            // note: ring, inner contour winds the other way so nonzero leaves a hole
+            Out->AppendF(" A %.2f %.2f 0 1 1 %.2f %.2f A %.2f %.2f 0 1 1 %.2f %.2f Z", R, R, X - R, Y, R, R, X + R, Y);
+            Out->AppendF(" M %.2f %.2f A %.2f %.2f 0 1 0 %.2f %.2f A %.2f %.2f 0 1 0 %.2f %.2f Z",
+                         X + R * 0.5f, Y, R * 0.5f, R * 0.5f, X - R * 0.5f, Y, R * 0.5f, R * 0.5f, X + R * 0.5f, Y);
+        } else {
+            // note: four cubics around the center with jittered control points
+            svg_v2 P = {X + R, Y};
+            for (u32 q=1; q<=4; ++q) {
+                r32 A0 = (q - 1) * 1.5707963f;
+                r32 A1 = q * 1.5707963f;
+                r32 K = 0.5523f * R * BenchRandomRange(&State, 0.6f, 1.6f);
+                svg_v2 End = {X + R * cosf(A1), Y + R * sinf(A1)};
+                svg_v2 C1 = {P.x - K * sinf(A0), P.y + K * cosf(A0)};
+                svg_v2 C2 = {End.x + K * sinf(A1), End.y - K * cosf(A1)};
+                Out->AppendF(" C %.2f %.2f %.2f %.2f %.2f %.2f", C1.x, C1.y, C2.x, C2.y, End.x, End.y);
+                P = End;
+            }
+            Out->AppendF(" Z");
+        }
+
+        Out->AppendF("\"/>\n");
+    }
+
+    Out->AppendF("</svg>\n");
+}
+
+// note: bytes that differ by more than rounding, and the largest difference
+internal u32
+BenchImageDifferences(u8 *A, u8 *B, size_t Bytes, u32 *MaxDifference)
+{
+    u32 Result = 0;
+    *MaxDifference = 0;
+
+    for (size_t i=0; i<Bytes; ++i) {
+        u32 Difference = (A[i] > B[i]) ? A[i] - B[i] : B[i] - A[i];
+        if (Difference > 1) {
+            ++Result;
+        }
+        if (Difference > *MaxDifference) {
+            *MaxDifference = Difference;
+        }
+    }
+
+    return Result;
+}
+
+/*  Tiled against scanline rendering of shapes with corners and horizontal lines on the tile borders,
+    where the backdrops and the border steps have to agree exactly. Random polygons on a 32 pixel
+    grid, half of them with horizontal runs. */
+void
+BenchTiledCheck(u32 Count)
+{
+    const char *Fixed[] = {
+        "M0 0 H64 V64 H0 Z",
+        "M100 100 L150 128 L100 128 Z",
+        "M64 64 L128 64 L128 128 L64 128 Z",
+        "M128 128 L128 0 L64 32 Z",
+    };
+
+    u32 Size = 192;
+    svg_image Scanline = {};
+    Scanline.Width = Size;
+    Scanline.Height = Size;
+    Scanline.Pitch = Size * 4;
+    Scanline.Pixels = (u8 *)malloc(Size * Size * 4);
+    svg_image Tiled = Scanline;
+    Tiled.Pixels = (u8 *)malloc(Size * Size * 4);
+
+    static svg_rasterizer Rasterizer;
+    static svg_tiler Tiler;
+    ls_stringbuf Text = {};
+    u32 State = 1;
+    u32 Failed = 0;
+    u32 Worst = 0;
+
+    for (u32 i=0; i<Count; ++i) {
+        Text.Size = 0;
+        Text.AppendF("<svg><path fill-rule=\"%s\" d=\"", (i & 1) ? "evenodd" : "nonzero");
+
+        if (i < ArrayCount(Fixed)) {
+            Text.AppendF("%s", Fixed[i]);
+        } else {
+            u32 Points = 3 + BenchRandom(&State) % 6;
+            for (u32 p=0; p<Points; ++p) {
+                u32 X = (BenchRandom(&State) % 6) * 32;
+                u32 Y = (BenchRandom(&State) % 6) * 32;
+                if (p && (i & 2) && !(BenchRandom(&State) % 3)) {
+                    Text.AppendF(" H%u", X);
+                } else {
+                    Text.AppendF("%s%u %u", p ? " L" : "M", X, Y);
+                }
+            }
+            Text.AppendF(" Z");
+        }
+        Text.AppendF("\"/></svg>");
+
+        svg Svg = SvgParse((u8 *)Text.Data, Text.Size);
+        memset(Scanline.Pixels, 0, Size * Size * 4);
+        memset(Tiled.Pixels, 0, Size * Size * 4);
+        SvgRasterize(&Rasterizer, &Svg, &Scanline, SvgScaleTransform(1.0f));
+        SvgRasterizeTiled(&Tiler, &Svg, &Tiled, SvgScaleTransform(1.0f), 0);
+        SvgFree(&Svg);
+
+        u32 MaxDifference;
+        if (BenchImageDifferences(Scanline.Pixels, Tiled.Pixels, Size * Size * 4, &MaxDifference)) {
+            if (!Failed) {
+                printf("tiled check: differs from scanline for %.*s\n", (int)Text.Size, Text.Data);
+            }
+            ++Failed;
+        }
+        Worst = (MaxDifference > Worst) ? MaxDifference : Worst;
+    }
+
+    printf("tiled check: %u shapes on tile borders, %u differ from scanline, max difference %u\n", Count, Failed, Worst);
+
+    free(Scanline.Pixels);
+    free(Tiled.Pixels);
+    Text.Free();
+}
+
+void
+BenchTiled(svg *Svg, u32 Size, r32 Scale)
+{
+    svg_image Image = {};
+    Image.Width = Size;
+    Image.Height = Size;
+    Image.Pitch = Size * 4;
+    Image.Pixels = (u8 *)malloc(Size * Size * 4);
+
+    svg_transform Transform = SvgScaleTransform(Scale);
+
+    r64 Serial = 1e9;
+    svg_rasterizer Rasterizer = {};
+    for (u32 Run=0; Run<3; ++Run) {
+        memset(Image.Pixels, 0, Size * Size * 4);
+        r64 Start = BenchSeconds();
+        SvgRasterize(&Rasterizer, Svg, &Image, Transform);
+        r64 Elapsed = BenchSeconds() - Start;
+        if (Elapsed < Serial) {
+            Serial = Elapsed;
+        }
+    }
+
+    printf("tiled %upx, %u elements, scanline reference: %.2f ms\n", Size, Svg->Elements.Count, Serial * 1e3);
+
+    // note: the last scanline render is the reference every tiled render is compared to
+    u8 *Reference = (u8 *)malloc(Size * Size * 4);
+    memcpy(Reference, Image.Pixels, Size * Size * 4);
+
+    static svg_tiler Tiler;
+    u32 Hardware = std::thread::hardware_concurrency();
+    u32 MaxThreads = (Hardware > 8) ? Hardware : 8;
+    r64 Single = 0.0;
+
+    for (u32 Threads=1; Threads<=MaxThreads; Threads*=2) {
+        svg_job_pool Pool;
+        SvgJobPoolStart(&Pool, Threads);
+
+        r64 Best = 1e9;
+        r64 BestBin = 0.0;
+
+        for (u32 Run=0; Run<3; ++Run) {
+            memset(Image.Pixels, 0, Size * Size * 4);
+
+            r64 Start = BenchSeconds();
+            SvgTilerBin(&Tiler, Svg, Transform, Size, Size);
+            r64 Binned = BenchSeconds();
+
+            Tiler.Svg = Svg;
+            Tiler.Image = &Image;
+            SvgParallelFor(&Pool, Tiler.Jobs.Count, SvgTileJob, &Tiler);
+
+            r64 Elapsed = BenchSeconds() - Start;
+            if (Elapsed < Best) {
+                Best = Elapsed;
+                BestBin = Binned - Start;
+            }
+        }
+
+        SvgJobPoolStop(&Pool);
+
+        if (Threads == 1) {
+            Single = Best;
+        }
+
+        u32 MaxDifference;
+        u32 Differences = BenchImageDifferences(Reference, Image.Pixels, Size * Size * 4, &MaxDifference);
+
+        printf("tiled %2u threads: %8.2f ms  (bin %6.2f ms, %u tiles)  speedup %5.2fx  %u bytes differ (max %u)%s\n",
+               Threads, Best * 1e3, BestBin * 1e3, Tiler.Jobs.Count, Single / Best, Differences, MaxDifference,
+               Threads > Hardware ? "  oversubscribed" : "");
+    }
+
+    free(Reference);
+    free(Image.Pixels);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+STREAMING */
+
+// note: stands in for a row-streaming image writer, it touches every pixel of the band
+void
+BenchChecksumSink(void *Data, svg_image *Band, u32 Y)
+{
+    u64 *Sum = (u64 *)Data;
+
+    for (u32 y=0; y<Band->Height; ++y) {
+        u8 *Row = Band->Pixels + y * Band->Pitch;
+        for (u32 x=0; x<Band->Width * 4; ++x) {
+            *Sum += Row[x];
+        }
+    }
+}
+
+void
+BenchStream(svg *Svg, u32 Size, u32 BandHeight)
+{
+    static svg_streamer Streamer;
+    svg_transform Transform = SvgScaleTransform(Size / 64.0f);
+
+    u64 Sum = 0;
+    r64 Start = BenchSeconds();
+    SvgRasterizeStreaming(&Streamer, Svg, Size, Size, BandHeight, Transform, BenchChecksumSink, &Sum);
+    r64 Elapsed = BenchSeconds() - Start;
+
+    svg_rasterizer *R = &Streamer.Rasterizer;
+    u64 Bytes = (u64)Streamer.Edges.Cap * sizeof(svg_stream_edge) + Streamer.Sorted.Cap * sizeof(svg_stream_edge) +
+                (Streamer.BandStarts.Cap + Streamer.Active.Cap + Streamer.Merged.Cap) * sizeof(u32) +
+                Streamer.Pixels.Cap + R->Cells.Cap * sizeof(r32) + R->Rows.Cap * sizeof(svg_row_extent) + R->Coverage.Cap;
+
+    printf("stream %upx, %u row bands: %8.2f ms  %8.1f Mpx/s  scratch %.1f MB (framebuffer would be %.1f MB)\n",
+           Size, BandHeight, Elapsed * 1e3, (r64)Size * Size / Elapsed / 1e6, Bytes / 1048576.0,
+           (r64)Size * Size * 4 / 1048576.0);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+DISTANCE FIELDS */
+
+void
+BenchDistanceField(svg *Svg, u32 Size, u32 Channels, svg_job_pool *Pool)
+{
+    static svg_sdf_generator Generator;
+
+    svg_field Field = {};
+    Field.Width = Size;
+    Field.Height = Size;
+    Field.Channels = Channels;
+    Field.Pitch = Size * Channels;
+    Field.Pixels = (u8 *)malloc(Size * Size * Channels);
+
+    r64 Best = 1e9;
+    for (u32 Run=0; Run<3; ++Run) {
+        r64 Start = BenchSeconds();
+        SvgGenerateDistanceField(&Generator, Svg, &Field, SvgScaleTransform(Size / 64.0f), Size / 16.0f, Pool);
+        r64 Elapsed = BenchSeconds() - Start;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    printf("%s %4upx: %9.2f ms  %8.2f Mpx/s  (%u threads)\n", Channels == 3 ? "msdf" : " sdf", Size, Best * 1e3,
+           (r64)Size * Size / Best / 1e6, Pool->WorkerCount);
+
+    free(Field.Pixels);
+}
+
+/*  Closest points on cubics against a dense-sampled reference, on random cubics that often loop and
+    a few with cusps. The reference takes the best of 16384 samples and refines it by golden section
+    within one sample step, so it is off by far less than the tolerance. A distance above the
+    reference means a local minimum was taken for the closest point. */
+void
+BenchDistanceCheck(u32 Count)
+{
+    u32 State = 777;
+    u32 Samples = 16384;
+    u32 Worse = 0;
+    r32 MaxError = 0.0f;
+
+    for (u32 i=0; i<Count; ++i) {
+        svg_path_segement S = {};
+        S.Type = SvgSegment_CubicBezier;
+
+        if (i % 8 == 0) {
+            // note: control polygon crossing itself symmetrically, a cusp or a tight loop
+            r32 K = BenchRandomRange(&State, 0.9f, 1.1f);
+            S.P1 = {0.0f, 0.0f};
+            S.C1 = {100.0f * K, 100.0f};
+            S.C2 = {0.0f, 100.0f};
+            S.P2 = {100.0f, 0.0f};
+        } else {
+            S.P1 = {BenchRandomRange(&State, 0.0f, 100.0f), BenchRandomRange(&State, 0.0f, 100.0f)};
+            S.C1 = {BenchRandomRange(&State, 0.0f, 100.0f), BenchRandomRange(&State, 0.0f, 100.0f)};
+            S.C2 = {BenchRandomRange(&State, 0.0f, 100.0f), BenchRandomRange(&State, 0.0f, 100.0f)};
+            S.P2 = {BenchRandomRange(&State, 0.0f, 100.0f), BenchRandomRange(&State, 0.0f, 100.0f)};
+        }
+
+        svg_v2 P = {BenchRandomRange(&State, -20.0f, 120.0f), BenchRandomRange(&State, -20.0f, 120.0f)};
+
+        r64 BestSq = 1e30;
+        u32 BestSample = 0;
+        for (u32 j=0; j<=Samples; ++j) {
+            svg_v2 D = SvgCubicAt(S.P1, S.C1, S.C2, S.P2, (r32)j / Samples) - P;
+            if (SvgDot(D, D) < BestSq) {
+                BestSq = SvgDot(D, D);
+                BestSample = j;
+            }
+        }
+
+        r32 Lo = (r32)(BestSample ? BestSample - 1 : 0) / Samples;
+        r32 Hi = (r32)(BestSample < Samples ? BestSample + 1 : Samples) / Samples;
+        for (u32 j=0; j<40; ++j) {
+            r32 T1 = Lo + 0.382f * (Hi - Lo);
+            r32 T2 = Lo + 0.618f * (Hi - Lo);
+            svg_v2 D1 = SvgCubicAt(S.P1, S.C1, S.C2, S.P2, T1) - P;
+            svg_v2 D2 = SvgCubicAt(S.P1, S.C1, S.C2, S.P2, T2) - P;
+            if (SvgDot(D1, D1) < SvgDot(D2, D2)) {
+                Hi = T2;
+            } else {
+                Lo = T1;
+            }
+        }
+
+        r32 Reference = SvgLength(SvgCubicAt(S.P1, S.C1, S.C2, S.P2, 0.5f * (Lo + Hi)) - P);
+        Reference = SvgMin(Reference, sqrtf((r32)BestSq));
+
+        r32 Distance = SvgLength(SvgSegmentAt(&S, SvgSegmentClosest(&S, P)) - P);
+        r32 Error = fabsf(Distance - Reference);
+        MaxError = SvgMax(MaxError, Error);
+
+        if (Distance > Reference + 1e-3f) {
+            ++Worse;
+        }
+    }
+
+    printf(" sdf cubic distance: %u points, %u farther than the sampled reference, max difference %g\n", Count, Worse,
+           MaxError);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+ICON ATLAS */
+
+// note: Count generated icons plus the one from the command line, baked at the usual UI sizes
+void
+BenchAtlas(svg *Svg, u32 Count, svg_job_pool *Pool)
+{
+    static svg_atlas Atlas;
+
+    svg **Icons = (svg **)malloc((Count + 1) * sizeof(svg *));
+    Icons[0] = Svg;
+
+    for (u32 i=1; i<=Count; ++i) {
+        ls_stringbuf Buffer;
+        BenchDenseSvg(&Buffer, 6, 64.0f, 0x9e3779b9u * i);
+        Icons[i] = (svg *)malloc(sizeof(svg));
+        *Icons[i] = SvgParse((u8 *)Buffer.Data, Buffer.Size);
+    }
+
+    u32 Sizes[] = {16, 24, 32, 48, 64};
+    u32 SizeCount = sizeof(Sizes) / sizeof(Sizes[0]);
+
+    r64 Best = 1e9;
+    for (u32 Run=0; Run<3; ++Run) {
+        r64 Start = BenchSeconds();
+        SvgBakeAtlas(&Atlas, Icons, Count + 1, Sizes, SizeCount, 1024, 1, Pool);
+        r64 Elapsed = BenchSeconds() - Start;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    u64 Used = 0;
+    for (u32 i=0; i<Atlas.Entries.Count; ++i) {
+        u64 Cell = Atlas.Entries.Data[i].Size + 2;
+        Used += Cell * Cell;
+    }
+
+    printf("atlas %u icons x %u sizes: %8.2f ms  %u pages of %upx  %.1f%% used  (%u threads)\n", Count + 1, SizeCount,
+           Best * 1e3, Atlas.PageCount, Atlas.PageSize, 100.0 * Used / ((u64)Atlas.PageCount * Atlas.PageSize * Atlas.PageSize),
+           Pool->WorkerCount);
+
+    // note: layouts whose pages don't fit in the pixel array are refused before anything is allocated
+    u32 Huge = 16000;
+    b32 BigPage = SvgBakeAtlas(&Atlas, Icons, 1, Sizes, 1, 65536, 1, Pool);
+    b32 ManyPages = SvgBakeAtlas(&Atlas, Icons, 3, &Huge, 1, 16384, 1, Pool);
+    printf("atlas over %.0f MB: 65536px page %s, 3 pages of 16384px %s\n", SVG_ATLAS_MAX_BYTES / 1048576.0,
+           BigPage ? "BAKED" : "refused", ManyPages ? "BAKED" : "refused");
+
+    free(Icons);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+TESSELLATION */
+
+void
+BenchTessellate(char *Name, svg *Svg, r32 Scale)
+{
+    static svg_tessellator Tessellator;
+    static svg_mesh Mesh;
+
+    r64 Best = 1e9;
+    for (u32 Run=0; Run<5; ++Run) {
+        r64 Start = BenchSeconds();
+        SvgTessellate(&Tessellator, Svg, SvgScaleTransform(Scale), SVG_RASTER_TOLERANCE, &Mesh);
+        r64 Elapsed = BenchSeconds() - Start;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    u32 Triangles = Mesh.Indices.Count / 3;
+    b32 Short = SvgMeshIndices16(&Mesh) != 0;
+
+    printf("tess %s: %9.3f ms  %u ranges  %u vertices  %u triangles  %.1f Mtri/s  %s indices\n", Name, Best * 1e3,
+           Mesh.Ranges.Count, Mesh.Vertices.Count, Triangles, Triangles / Best / 1e6, Short ? "16-bit" : "32-bit");
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+HIT TESTING */
+
+// note: budget for picking a point in a typical icon, the bench reports whether it holds
+#define BENCH_HIT_TARGET_NS 1000.0
+
+// note: SvgHitTest at random points inside the bounds of the document, a share of them misses
+void
+BenchHitTest(char *Name, svg *Svg, u32 Queries, b32 Icon)
+{
+    svg_bounds Bounds = {};
+    b32 First = true;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Type == SvgElement_Path && E->Path.Segments.Count) {
+            Bounds = First ? E->Path.Bounds : SvgBoundsUnion(Bounds, E->Path.Bounds);
+            First = false;
+        }
+    }
+
+    svg_v2 *Points = (svg_v2 *)malloc(Queries * sizeof(svg_v2));
+    u32 State = 4321;
+    for (u32 i=0; i<Queries; ++i) {
+        Points[i] = {BenchRandomRange(&State, Bounds.Min.x, Bounds.Max.x), BenchRandomRange(&State, Bounds.Min.y, Bounds.Max.y)};
+    }
+
+    r64 Best = 1e9;
+    u32 Hits = 0;
+
+    for (u32 Run=0; Run<5; ++Run) {
+        Hits = 0;
+        r64 Start = BenchSeconds();
+
+        for (u32 i=0; i<Queries; ++i) {
+            Hits += SvgHitTest(Svg, Points[i]) ? 1 : 0;
+        }
+
+        Best = fmin(Best, BenchSeconds() - Start);
+    }
+
+    r64 Ns = Best * 1e9 / Queries;
+
+    if (Icon) {
+        printf("hit %s: %9.1f ns/query  %u of %u hit  (target %.0f ns: %s)\n", Name, Ns, Hits, Queries,
+               BENCH_HIT_TARGET_NS, Ns <= BENCH_HIT_TARGET_NS ? "ok" : "MISSED");
+    } else {
+        printf("hit %s: %9.1f ns/query  %u of %u hit\n", Name, Ns, Hits, Queries);
+    }
+
+    free(Points);
+}
+
+// note: both fill rules on self intersecting contours, curves with loops, arcs whose radii get scaled
+//       up, an open contour and overlapping elements
+global_variable char BenchHitShapes[] =
+    "<svg>"
+    "<path d=\"M20 10 L44 70 L70 25 L5 45 L80 55 Z\"/>"
+    "<path fill-rule=\"evenodd\" d=\"M120 10 L144 70 L170 25 L105 45 L180 55 Z M150 20 h20 v20 h-20 Z\"/>"
+    "<path d=\"M10 110 C120 200 -30 200 80 110 Q110 150 60 190\"/>"
+    "<path fill-rule=\"evenodd\" d=\"M110 110 A10 20 30 0 1 190 170 A40 30 -20 1 0 110 110 Z M130 130 a15 15 0 1 0 30 0 a15 15 0 1 0 -30 0\"/>"
+    "<path d=\"M60 60 C90 20 150 100 130 60 S60 140 60 60 Z\"/>"
+    "</svg>";
+
+/*  SvgHitTest against rasterized coverage. Every element is rendered on its own through T, at pixel
+    centers where the topmost element covering the pixel fully has no partially covering element
+    above it the hit test has to return it, and where nothing covers the pixel at all it has to miss.
+    Other pixels are on an edge and skipped. The point is mapped back through the inverse of T. */
+void
+BenchHitCheck(char *Name, svg *Svg, svg_transform T, u32 Size)
+{
+    svg_image Image = {};
+    Image.Width = Size;
+    Image.Height = Size;
+    Image.Pitch = Size * 4;
+    Image.Pixels = (u8 *)malloc(Size * Size * 4);
+
+    u32 ElementCount = Svg->Elements.Count;
+    u8 *Coverage = (u8 *)malloc((size_t)ElementCount * Size * Size);
+    static svg_rasterizer Rasterizer;
+
+    for (u32 i=0; i<ElementCount; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        u32 Fill = E->Fill;
+        E->Fill = (Fill & 0xff) ? 0xffffffff : 0;
+
+        memset(Image.Pixels, 0, Size * Size * 4);
+        SvgRasterizerBegin(&Rasterizer, Size, Size);
+        SvgRasterizeElement(&Rasterizer, Svg, E, T, &Image);
+        E->Fill = Fill;
+
+        for (u32 p=0; p<Size * Size; ++p) {
+            Coverage[(size_t)i * Size * Size + p] = Image.Pixels[p * 4 + 3];
+        }
+    }
+
+    r32 Determinant = T.a * T.d - T.b * T.c;
+    svg_transform Inverse = {T.d / Determinant, -T.b / Determinant, -T.c / Determinant, T.a / Determinant, 0.0f, 0.0f};
+    svg_v2 Offset = SvgTransformPoint(Inverse, {T.e, T.f});
+    Inverse.e = -Offset.x;
+    Inverse.f = -Offset.y;
+
+    u32 Checked = 0;
+    u32 Hits = 0;
+    u32 Wrong = 0;
+
+    for (u32 y=0; y<Size; ++y) {
+        for (u32 x=0; x<Size; ++x) {
+            s32 Expected = -1;
+            b32 Clear = true;
+
+            for (s32 i=ElementCount - 1; i>=0; --i) {
+                u8 Alpha = Coverage[(size_t)i * Size * Size + y * Size + x];
+                if (Alpha == 255) {
+                    Expected = i;
+                    break;
+                }
+                if (Alpha) {
+                    Clear = false;
+                    break;
+                }
+            }
+
+            if (!Clear) {
+                continue;
+            }
+
+            svg_v2 P = SvgTransformPoint(Inverse, {x + 0.5f, y + 0.5f});
+            svg_element *Hit = SvgHitTest(Svg, P);
+            s32 Got = Hit ? (s32)(Hit - Svg->Elements.Data) : -1;
+
+            ++Checked;
+            Hits += (Expected >= 0) ? 1 : 0;
+            if (Got != Expected) {
+                if (!Wrong) {
+                    printf("hit check %s: pixel %u %u (%g %g) hits %d, coverage says %d\n", Name, x, y, P.x, P.y,
+                           Got, Expected);
+                }
+                ++Wrong;
+            }
+        }
+    }
+
+    printf("hit check %s: %u pixels off edges, %u inside, %u disagree with coverage\n", Name, Checked, Hits, Wrong);
+
+    free(Coverage);
+    free(Image.Pixels);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+ARC LENGTH */
+
+// note: measures every element, samples points at random distances and cuts the paths into dashes
+void
+BenchMeasure(char *Name, svg *Svg, u32 Samples)
+{
+    static svg_path_measure Measure;
+    static svg_path Dashed;
+
+    r64 MeasureTime = 0.0;
+    r64 SampleTime = 0.0;
+    r64 DashTime = 0.0;
+    r64 Length = 0.0;
+    u32 Segments = 0;
+    u32 Queries = 0;
+    u32 DashSegments = 0;
+    volatile r32 Sink = 0.0f; // note: keeps the sampling from being optimized away
+
+    r32 Dashes[] = {6.0f, 3.0f, 1.0f, 3.0f};
+    u32 State = 1234;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Type != SvgElement_Path || !E->Path.Segments.Count) {
+            continue;
+        }
+
+        r64 Start = BenchSeconds();
+        SvgMeasurePath(&Measure, &E->Path);
+        r64 Measured = BenchSeconds();
+
+        for (u32 q=0; q<Samples; ++q) {
+            svg_v2 P = SvgPointAt(&Measure, BenchRandomRange(&State, 0.0f, Measure.Length));
+            Sink += P.x + P.y;
+        }
+        r64 Sampled = BenchSeconds();
+
+        SvgResetPath(&Dashed);
+        SvgDashPath(&Measure, Dashes, ArrayCount(Dashes), 0.0f, &Dashed);
+        r64 Cut = BenchSeconds();
+
+        MeasureTime += Measured - Start;
+        SampleTime += Sampled - Measured;
+        DashTime += Cut - Sampled;
+        Length += Measure.Length;
+        Segments += E->Path.Segments.Count;
+        Queries += Samples;
+        DashSegments += Dashed.Segments.Count;
+    }
+
+    printf("measure %s: %9.3f ms  %u segments  length %.0f  %.1f ns/segment  point %.1f ns  dash %.3f ms  %u dash segments\n",
+           Name, MeasureTime * 1e3, Segments, Length, MeasureTime * 1e9 / Segments, SampleTime * 1e9 / Queries,
+           DashTime * 1e3, DashSegments);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+SIMPLIFICATION */
+
+// note: paths flattened into many short lines, like the output of design tools
+void
+BenchLineSvg(svg *Out, svg *Svg, r32 Tolerance)
+{
+    svg_polyline Polyline = {};
+    *Out = {};
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Type != SvgElement_Path || !E->Path.Segments.Count) {
+            continue;
+        }
+
+        Polyline.Points.Count = 0;
+        Polyline.ContourEnds.Count = 0;
+        SvgFlattenPath(&E->Path, SvgScaleTransform(1.0f), Tolerance, &Polyline);
+
+        svg_element *Lines = Out->Elements.AllocN(1);
+        *Lines = *E;
+        Lines->Path = {};
+
+        u32 Start = 0;
+        for (u32 c=0; c<Polyline.ContourEnds.Count; ++c) {
+            u32 End = Polyline.ContourEnds.Data[c];
+            for (u32 p=Start; p<End; ++p) {
+                svg_v2 Next = (p + 1 < End) ? Polyline.Points.Data[p + 1] : Polyline.Points.Data[Start];
+                SvgAddLineSegment(&Lines->Path, Polyline.Points.Data[p], Next);
+            }
+            Start = End;
+        }
+    }
+}
+
+void
+BenchSimplify(char *Name, svg *Svg, r32 Tolerance, b32 FitCurves)
+{
+    static svg_simplifier Simplifier;
+
+    // note: simplifies a copy in place, building the copy is not timed
+    svg Lines;
+    BenchLineSvg(&Lines, Svg, 0.01f);
+
+    u32 Before = 0;
+    for (u32 i=0; i<Lines.Elements.Count; ++i) {
+        Before += Lines.Elements.Data[i].Path.Segments.Count;
+    }
+
+    r64 Start = BenchSeconds();
+    SvgSimplify(&Simplifier, &Lines, Tolerance, FitCurves);
+    r64 Elapsed = BenchSeconds() - Start;
+
+    u32 After = 0;
+    for (u32 i=0; i<Lines.Elements.Count; ++i) {
+        After += Lines.Elements.Data[i].Path.Segments.Count;
+    }
+
+    printf("simplify %s %s: %9.3f ms  %u -> %u segments (%.1f%%)  %.1f ns/segment\n", Name,
+           FitCurves ? "curves" : "lines", Elapsed * 1e3, Before, After, 100.0 * After / Before, Elapsed * 1e9 / Before);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+LEVEL OF DETAIL */
+
+struct bench_lod_frame {
+    svg_lod_cache *Cache;
+    svg *Svg;
+    r32 Scale;
+    b32 Flatten;
+    svg_polyline Polylines[SVG_MAX_WORKERS];
+    u32 Points[SVG_MAX_WORKERS];
+};
+
+internal void
+BenchLodJob(void *Data, u32 Index, u32 Worker)
+{
+    bench_lod_frame *Frame = (bench_lod_frame *)Data;
+
+    if (Frame->Flatten) {
+        svg_element *E = Frame->Svg->Elements.Data + Index;
+        if (E->Type == SvgElement_Path && E->Path.Segments.Count) {
+            svg_polyline *Polyline = Frame->Polylines + Worker;
+            Polyline->Points.Count = 0;
+            Polyline->ContourEnds.Count = 0;
+            SvgFlattenPath(&E->Path, SvgScaleTransform(Frame->Scale), SVG_RASTER_TOLERANCE, Polyline);
+            Frame->Points[Worker] += Polyline->Points.Count;
+        }
+    } else {
+        svg_polyline *Polyline = SvgLodGet(Frame->Cache, Index, Frame->Scale);
+        if (Polyline) {
+            Frame->Points[Worker] += Polyline->Points.Count;
+            SvgLodDone(Frame->Cache, Polyline);
+        }
+    }
+}
+
+// note: zooms in and out over the whole document, every frame asks for the geometry of every element
+void
+BenchLod(svg *Svg, u32 FrameCount, size_t Budget, svg_job_pool *Pool)
+{
+    static bench_lod_frame Frame;
+    svg_lod_cache Cache;
+    SvgLodInit(&Cache, Svg, 0.01f, Budget);
+
+    Frame.Cache = &Cache;
+    Frame.Svg = Svg;
+
+    r64 Times[2] = {};
+    u32 Points[2] = {};
+    size_t Kept = 0;
+
+    for (u32 Mode=0; Mode<2; ++Mode) {
+        Frame.Flatten = (Mode == 0);
+
+        for (u32 f=0; f<FrameCount; ++f) {
+            r32 Phase = (r32)f / FrameCount;
+            Frame.Scale = 0.1f * powf(40.0f, 1.0f - fabsf(2.0f * Phase - 1.0f));
+            memset(Frame.Points, 0, sizeof(Frame.Points));
+
+            r64 Start = BenchSeconds();
+            SvgParallelFor(Pool, Svg->Elements.Count, BenchLodJob, &Frame);
+            if (!Frame.Flatten) {
+                SvgLodTrim(&Cache);
+                Kept = (Cache.Bytes > Kept) ? (size_t)Cache.Bytes : Kept;
+            }
+            Times[Mode] += BenchSeconds() - Start;
+
+            for (u32 w=0; w<SVG_MAX_WORKERS; ++w) {
+                Points[Mode] += Frame.Points[w];
+            }
+        }
+    }
+
+    // note: peak is the most the cache held at any time, within frames too. Kept is the most after a frame
+    size_t Peak = Cache.Peak;
+    printf("lod %u frames: flatten %.3f ms/frame  cached %.3f ms/frame  %.1f / %.1f Mpoints  peak %.1f MB  kept %.1f MB  budget %.1f MB  (%u threads)\n",
+           FrameCount, Times[0] * 1e3 / FrameCount, Times[1] * 1e3 / FrameCount, Points[0] / 1e6, Points[1] / 1e6,
+           Peak / 1048576.0, Kept / 1048576.0, Budget / 1048576.0, Pool ? Pool->WorkerCount : 1);
+
+    SvgLodFree(&Cache);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+STROKES */
+
+// note: strokes every element of Svg with the given style for the run, then puts the fills back
+void
+BenchStroke(char *Name, svg *Svg, svg_stroke_style Style, svg_job_pool *Pool)
+{
+    static svg_stroke_batch Batch;
+    static svg Out;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        Svg->Elements.Data[i].Stroke = 0x000000ff;
+        Svg->Elements.Data[i].StrokeStyle = Style;
+    }
+
+    r64 Best = 1e9;
+    for (u32 Run=0; Run<5; ++Run) {
+        // note: outline paths are rebuilt from scratch, the previous run's segments are dropped
+        for (u32 i=0; i<Out.Elements.Count; ++i) {
+            SvgResetPath(&Out.Elements.Data[i].Path);
+        }
+
+        r64 Start = BenchSeconds();
+        SvgStrokeDocument(&Batch, Svg, &Out, SVG_RASTER_TOLERANCE, Pool);
+        r64 Elapsed = BenchSeconds() - Start;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    u32 Segments = 0;
+    u32 Outlines = 0;
+    for (u32 i=0; i<Batch.Slots.Count; ++i) {
+        if (Batch.Slots.Data[i] != SVG_STROKE_NONE) {
+            Segments += Out.Elements.Data[Batch.Slots.Data[i]].Path.Segments.Count;
+            Outlines++;
+        }
+    }
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        Svg->Elements.Data[i].Stroke = 0;
+    }
+
+    printf("stroke %s: %9.3f ms  %u outlines  %u segments  %.1f Mseg/s\n", Name, Best * 1e3, Outlines, Segments,
+           Segments / Best / 1e6);
+}
+
+// note: circles around 128 128 thicker and thinner than their radius, one of them made of cubics, and
+//       zero length subpaths that only have their caps. Areas are in BenchStrokeAreas, in order
+global_variable char BenchStrokeShapes[] =
+    "<svg>"
+    "<path stroke=\"#000\" stroke-width=\"80\" d=\"M108 128 A20 20 0 0 1 148 128 A20 20 0 0 1 108 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"80\" d=\"M98 128 A30 30 0 0 0 158 128 A30 30 0 0 0 98 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"40\" d=\"M108 128 A20 20 0 0 1 148 128 A20 20 0 0 1 108 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"20\" d=\"M88 128 A40 40 0 0 1 168 128 A40 40 0 0 1 88 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"30\" d=\"M178 128 A50 50 0 0 0 78 128 A50 50 0 0 0 178 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"80\" d=\"M148 128 C148 139.0457 139.0457 148 128 148 C116.9543 148 108 139.0457 "
+    "108 128 C108 116.9543 116.9543 108 128 108 C139.0457 108 148 116.9543 148 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"60\" stroke-linecap=\"round\" d=\"M128 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"60\" stroke-linecap=\"square\" d=\"M128 128 Z\"/>"
+    "<path stroke=\"#000\" stroke-width=\"60\" stroke-linecap=\"round\" d=\"M128 128 L128 128\"/>"
+    "<path stroke=\"#000\" stroke-width=\"60\" stroke-linecap=\"butt\" d=\"M128 128 Z\"/>"
+    "</svg>";
+
+global_variable r64 BenchStrokeAreas[] = {
+    SVG_PI * 60.0 * 60.0, SVG_PI * 70.0 * 70.0, SVG_PI * 40.0 * 40.0, 4.0 * SVG_PI * 40.0 * 10.0,
+    4.0 * SVG_PI * 50.0 * 15.0, SVG_PI * 60.0 * 60.0, SVG_PI * 30.0 * 30.0, 60.0 * 60.0, SVG_PI * 30.0 * 30.0, 0.0,
+};
+
+/*  Strokes BenchStrokeShapes and sums the coverage of every outline against the area of the disc or
+    annulus it should cover. Flattening cuts the curves a little short, more than a percent off is
+    counted as wrong. */
+void
+BenchStrokeAreaCheck(void)
+{
+    static svg_stroke_batch Batch;
+    static svg_rasterizer Rasterizer;
+    svg Out = {};
+
+    svg Svg = SvgParse((u8 *)BenchStrokeShapes, sizeof(BenchStrokeShapes) - 1);
+    SvgStrokeDocument(&Batch, &Svg, &Out, SVG_RASTER_TOLERANCE, 0);
+
+    u32 Size = 256;
+    svg_image Image = {};
+    Image.Width = Size;
+    Image.Height = Size;
+    Image.Pitch = Size * 4;
+    Image.Pixels = (u8 *)malloc(Size * Size * 4);
+
+    u32 Wrong = 0;
+    r64 MaxError = 0.0;
+
+    for (u32 i=0; i<Batch.Slots.Count; ++i) {
+        r64 Area = 0.0;
+
+        if (Batch.Slots.Data[i] != SVG_STROKE_NONE) {
+            svg_element *E = Out.Elements.Data + Batch.Slots.Data[i];
+            E->Fill = 0xffffffff;
+
+            memset(Image.Pixels, 0, Size * Size * 4);
+            SvgRasterizerBegin(&Rasterizer, Size, Size);
+            SvgRasterizeElement(&Rasterizer, &Out, E, SvgScaleTransform(1.0f), &Image);
+
+            for (u32 p=0; p<Size * Size; ++p) {
+                Area += Image.Pixels[p * 4 + 3] / 255.0;
+            }
+        }
+
+        r64 Expected = BenchStrokeAreas[i];
+        r64 Error = (Expected > 0.0) ? fabs(Area - Expected) / Expected : Area;
+        MaxError = (Error > MaxError) ? Error : MaxError;
+        if (Error > 0.01) {
+            printf("stroke area check: shape %u covers %.0f px, should be %.0f\n", i, Area, Expected);
+            ++Wrong;
+        }
+    }
+
+    printf("stroke area check: %u shapes, %u wrong, worst %.2f%% off\n", Batch.Slots.Count, Wrong, MaxError * 100.0);
+
+    // note: the fills in Out share their paths with Svg, only the outlines are its own
+    for (u32 i=0; i<Batch.Slots.Count; ++i) {
+        if (Batch.Slots.Data[i] != SVG_STROKE_NONE) {
+            svg_path *Path = &Out.Elements.Data[Batch.Slots.Data[i]].Path;
+            Path->Segments.Free();
+            Path->Subpaths.Free();
+        }
+    }
+
+    free(Image.Pixels);
+    Out.Elements.Free();
+    SvgFree(&Svg);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+PACKING */
+
+// note: packs every path with grid Quantum (0 for a 16 bit grid), reports size and decode speed
+void
+BenchPack(char *Name, svg *Svg, r32 Quantum)
+{
+    svg_pack Pack = {};
+
+    r64 Start = BenchSeconds();
+    SvgPackSvg(&Pack, Svg, Quantum);
+    r64 PackTime = BenchSeconds() - Start;
+
+    u32 Segments = 0;
+    u32 Points = 0;
+    r32 Error = 0.0f;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Type != SvgElement_Path) {
+            continue;
+        }
+
+        svg_unpacker U = SvgUnpacker(&Pack, i);
+        svg_path_segement S;
+
+        for (u32 s=0; SvgUnpackNext(&U, &S); ++s) {
+            svg_path_segement *R = E->Path.Segments.Data + s;
+            Error = SvgMax(Error, SvgLength(S.P1 - R->P1));
+            Error = SvgMax(Error, SvgLength(S.P2 - R->P2));
+            Points += (U.Verbs[s] & SVG_PACK_MOVE) ? 2 : 1;
+
+            if (S.Type == SvgSegment_QuadraticBezier || S.Type == SvgSegment_CubicBezier) {
+                Error = SvgMax(Error, SvgLength(S.C1 - R->C1));
+                Points++;
+            }
+            if (S.Type == SvgSegment_CubicBezier) {
+                Error = SvgMax(Error, SvgLength(S.C2 - R->C2));
+                Points++;
+            }
+        }
+
+        Segments += E->Path.Segments.Count;
+    }
+
+    r64 Best = 1e9;
+    r32 Checksum = 0.0f;
+
+    for (u32 Run=0; Run<5; ++Run) {
+        Start = BenchSeconds();
+
+        for (u32 i=0; i<Pack.PathCount; ++i) {
+            svg_unpacker U = SvgUnpacker(&Pack, i);
+            svg_path_segement S;
+            while (SvgUnpackNext(&U, &S)) {
+                Checksum += S.P2.x;
+            }
+        }
+
+        r64 Elapsed = BenchSeconds() - Start;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    size_t Raw = (size_t)Segments * sizeof(svg_path_segement);
+    size_t Packed = SvgPackedSize(&Pack);
+
+    // note: everything the pack holds counts, the block offsets and every path's header
+    printf("pack %s: %u segments  %.2f MB -> %.2f MB  %.2f bytes/point  max error %.4f  "
+           "pack %.1f ms  decode %.1f Mseg/s (%g)\n", Name, Segments, Raw / 1e6, Packed / 1e6,
+           (r64)Packed / Points, Error, PackTime * 1e3, Segments / Best / 1e6, Checksum);
+
+    SvgPackFree(&Pack);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+DEDUPLICATION */
+
+// note: a diagram, Count copies of a few arrowheads, markers and badges placed with relative commands
+void
+BenchRepeatSvg(ls_stringbuf *Out, u32 Count, r32 Size, u32 Seed)
+{
+    char *Glyphs[] = {
+        (char *)"l 12 4 l -12 4 l 3 -4 z",
+        (char *)"c 4 -6 12 -6 16 0 c -4 6 -12 6 -16 0 z m 5 0 a 3 3 0 1 1 6 0 a 3 3 0 1 1 -6 0 z",
+        (char *)"h 20 v 8 h -20 z m 2 2 h 16 v 4 h -16 z",
+        (char *)"q 6 -10 12 0 t 12 0 t 12 0 l 0 6 l -36 0 z",
+    };
+
+    u32 State = Seed ? Seed : 1;
+    Out->AppendF("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 %.0f %.0f\">\n", Size, Size);
+
+    for (u32 i=0; i<Count; ++i) {
+        r32 X = BenchRandomRange(&State, 0.0f, Size);
+        r32 Y = BenchRandomRange(&State, 0.0f, Size);
+        Out->AppendF("<path d=\"M %.2f %.2f %s\"/>\n", X, Y, Glyphs[BenchRandom(&State) % ArrayCount(Glyphs)]);
+    }
+
+    Out->AppendF("</svg>\n");
+}
+
+void
+BenchDedup(char *Name, svg *Svg, r32 Tolerance, b32 Translate, b32 Subpaths)
+{
+    svg_dedup D;
+    SvgDedupInit(&D, Tolerance, Translate, Subpaths);
+
+    r64 Start = BenchSeconds();
+    SvgDedupSvg(&D, Svg);
+    r64 DedupTime = BenchSeconds() - Start;
+
+    // note: the paths of the document against what is left of them after SvgDedupRelease, plus the instances
+    size_t Before = 0;
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_path *Path = &Svg->Elements.Data[i].Path;
+        Before += Path->Segments.Count * sizeof(svg_path_segement) + Path->Subpaths.Count * sizeof(svg_subpath);
+    }
+
+    size_t After = SvgDedupSize(&D, Svg);
+
+    // note: a flattening cache keyed by shape does the work once per shape instead of per instance
+    svg_polyline Polyline = {};
+    r64 BestElements = 1e9;
+    r64 BestShapes = 1e9;
+
+    for (u32 Run=0; Run<5; ++Run) {
+        Start = BenchSeconds();
+        for (u32 i=0; i<Svg->Elements.Count; ++i) {
+            svg_element *E = Svg->Elements.Data + i;
+            if (E->Type == SvgElement_Path) {
+                Polyline.Points.Count = 0;
+                Polyline.ContourEnds.Count = 0;
+                SvgFlattenPath(&E->Path, SvgScaleTransform(1.0f), SVG_RASTER_TOLERANCE, &Polyline);
+            }
+        }
+        BestElements = fmin(BestElements, BenchSeconds() - Start);
+
+        Start = BenchSeconds();
+        for (u32 i=0; i<D.Shapes.Count; ++i) {
+            svg_path Shape = SvgShapePath(&D, Svg, i);
+            Polyline.Points.Count = 0;
+            Polyline.ContourEnds.Count = 0;
+            SvgFlattenPath(&Shape, SvgScaleTransform(1.0f), SVG_RASTER_TOLERANCE, &Polyline);
+        }
+        BestShapes = fmin(BestShapes, BenchSeconds() - Start);
+    }
+
+    printf("dedup %s: %u instances -> %u shapes  %.2f MB -> %.2f MB  %.2f ms  flatten %.2f ms -> %.2f ms\n",
+           Name, D.Instances.Count, D.Shapes.Count, Before / 1e6, After / 1e6, DedupTime * 1e3,
+           BestElements * 1e3, BestShapes * 1e3);
+
+    free(Polyline.Points.Data);
+    free(Polyline.ContourEnds.Data);
+    SvgDedupFree(&D);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+WRITER */
+
+/*  Largest distance between the points of matching elements. Changed counts the elements whose
+    segments don't line up, an endpoint that comes back away from its subpath start gets a closing
+    line of its own. Shortest numbers read back exactly, rounded ones only to their precision. */
+internal r32
+BenchWriteError(svg *A, svg *B, u32 *Changed)
+{
+    r32 Error = 0.0f;
+    *Changed = 0;
+
+    for (u32 i=0; i<A->Elements.Count; ++i) {
+        svg_path *PathA = &A->Elements.Data[i].Path;
+        svg_path *PathB = (i < B->Elements.Count) ? &B->Elements.Data[i].Path : 0;
+        if (!PathB || PathA->Segments.Count != PathB->Segments.Count) {
+            ++*Changed;
+            continue;
+        }
+
+        for (u32 s=0; s<PathA->Segments.Count; ++s) {
+            svg_path_segement *SA = PathA->Segments.Data + s;
+            svg_path_segement *SB = PathB->Segments.Data + s;
+
+            svg_v2 Points[] = {SA->P1 - SB->P1, SA->P2 - SB->P2, SA->C1 - SB->C1, SA->C2 - SB->C2};
+            u32 Count = (SA->Type == SvgSegment_CubicBezier) ? 4 : (SA->Type == SvgSegment_QuadraticBezier) ? 3 : 2;
+            for (u32 p=0; p<Count; ++p) {
+                Error = SvgMax(Error, SvgMax(fabsf(Points[p].x), fabsf(Points[p].y)));
+            }
+        }
+    }
+
+    return Error;
+}
+
+// note: written text against the source it was parsed from, the error is after reading it back
+void
+BenchWrite(char *Name, svg *Svg, size_t SourceBytes, s32 Precision, b32 Absolute)
+{
+    ls_stringbuf Out;
+    r64 Best = 1e9;
+
+    for (u32 Run=0; Run<5; ++Run) {
+        Out.Size = 0;
+        svg_writer W;
+        SvgWriterInit(&W, &Out, Precision, Absolute);
+
+        r64 Start = BenchSeconds();
+        SvgWrite(&W, Svg);
+        Best = fmin(Best, BenchSeconds() - Start);
+    }
+
+    svg Read = SvgParse((u8 *)Out.Data, Out.Size);
+    u32 Changed;
+    r32 Error = BenchWriteError(Svg, &Read, &Changed);
+
+    printf("write %s: %zu -> %u bytes (%.1f%%)  %.2f ms  %.1f MB/s  max error %.2g  changed %u of %u\n", Name,
+           SourceBytes, Out.Size, 100.0 * Out.Size / SourceBytes, Best * 1e3, Out.Size / Best / 1e6, Error,
+           Changed, Svg->Elements.Count);
+    Out.Free();
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+SCALAR TYPES */
+
+// note: spans of the d attributes of an svg file
+void
+BenchPathData(u8 *Data, u32 Size, svg_array<ls_string> *Out)
+{
+    for (u32 i=0; i + 4 < Size; ++i) {
+        if (Data[i] == ' ' && Data[i + 1] == 'd' && Data[i + 2] == '=' && Data[i + 3] == '"') {
+            u32 Start = i + 4;
+            u32 End = Start;
+            while (End < Size && Data[End] != '"') {
+                ++End;
+            }
+
+            Out->Push(ls_string((char *)Data + Start, End - Start));
+            i = End;
+        }
+    }
+}
+
+// note: parses every path with the scalar type T, the error is the largest point distance from r64
+template <typename T>
+void
+BenchScalar(char *Name, svg_array<ls_string> *Paths, u32 Iterations)
+{
+    svg_path_t<T> Path = {};
+    svg_path_t<r64> Reference = {};
+    u64 Bytes = 0;
+    u32 Segments = 0;
+    r64 Error = 0.0;
+
+    for (u32 i=0; i<Paths->Count; ++i) {
+        SvgResetPath(&Path);
+        SvgResetPath(&Reference);
+        SvgParsePathData(Paths->Data[i], &Path);
+        SvgParsePathData(Paths->Data[i], &Reference);
+
+        for (u32 s=0; s<Path.Segments.Count; ++s) {
+            svg_path_segement_t<T> *S = Path.Segments.Data + s;
+            svg_path_segement_t<r64> *R = Reference.Segments.Data + s;
+            svg_v2_t<T> Points[] = {S->P1, S->P2, S->C1, S->C2};
+            svg_v2_t<r64> Expected[] = {R->P1, R->P2, R->C1, R->C2};
+            u32 Count = (S->Type == SvgSegment_Line || S->Type == SvgSegment_Elliptical) ? 2 : 4;
+
+            for (u32 p=0; p<Count; ++p) {
+                r64 Dx = SvgReal64(Points[p].x) - Expected[p].x;
+                r64 Dy = SvgReal64(Points[p].y) - Expected[p].y;
+                Error = fmax(Error, sqrt(Dx * Dx + Dy * Dy));
+            }
+        }
+
+        Bytes += Paths->Data[i].Size;
+        Segments += Path.Segments.Count;
+    }
+
+    r64 Best = 1e9;
+    for (u32 Run=0; Run<5; ++Run) {
+        r64 Start = BenchSeconds();
+
+        for (u32 It=0; It<Iterations; ++It) {
+            for (u32 i=0; i<Paths->Count; ++i) {
+                SvgResetPath(&Path);
+                SvgParsePathData(Paths->Data[i], &Path);
+            }
+        }
+
+        r64 Elapsed = (BenchSeconds() - Start) / Iterations;
+        if (Elapsed < Best) {
+            Best = Elapsed;
+        }
+    }
+
+    printf("scalar %-6s: %9.3f ms  %7.1f MB/s  %6.1f ns/segment  max error %.2g\n", Name, Best * 1e3,
+           Bytes / Best / 1e6, Best * 1e9 / Segments, Error);
+
+    free(Path.Segments.Data);
+    free(Path.Subpaths.Data);
+    free(Reference.Segments.Data);
+    free(Reference.Subpaths.Data);
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+PARSER */
+
+// note: what a generated corpus looks like, the command weights are relative to each other
+struct bench_corpus {
+    u32 PathCount;
+    u32 SegmentsPerPath;
+    r32 Size;
+    u32 Seed;
+    u32 Decimals;
+
+    u32 Lines; // L, H and V
+    u32 Curves; // C, S, Q and T
+    u32 Arcs;
+
+    b32 Relative; // lower case commands with offsets from the current point
+    b32 Compact; // no repeated letters, no separator the tokenizer doesn't need, no leading zero
+    b32 Editor; // wrapped like an editor export: prolog, comments, metadata, namespaced attributes
+};
+
+struct bench_writer {
+    ls_stringbuf *Out;
+    char Command;
+    b32 Number; // the text ends in a number
+    b32 Dot; // and it has a dot
+};
+
+internal void
+BenchWriteCommand(bench_writer *W, bench_corpus *Corpus, char Letter)
+{
+    Letter = Corpus->Relative ? (char)(Letter | 0x20) : Letter;
+
+    if (!Corpus->Compact || Letter != W->Command) {
+        W->Out->AppendF((W->Number && !Corpus->Compact) ? " %c" : "%c", Letter);
+        W->Number = false;
+    }
+    W->Command = Letter;
+}
+
+internal void
+BenchWriteNumber(bench_writer *W, bench_corpus *Corpus, r32 Value)
+{
+    char Buffer[64];
+    u32 Size = snprintf(Buffer, sizeof(Buffer), "%.*f", Corpus->Decimals, Value);
+    char *Text = Buffer;
+
+    if (Corpus->Compact) {
+        if (memchr(Text, '.', Size)) {
+            while (Text[Size - 1] == '0') {
+                --Size;
+            }
+            if (Text[Size - 1] == '.') {
+                --Size;
+            }
+        }
+        Text[Size] = 0;
+
+        if (!strcmp(Text, "-0")) {
+            Text[0] = '0';
+            Text[1] = 0;
+            Size = 1;
+        }
+
+        // note: "0.5" as ".5", "-0.5" as "-.5"
+        char *Zero = Text + (Text[0] == '-');
+        if (Zero[0] == '0' && Zero[1] == '.') {
+            memmove(Zero, Zero + 1, Size - (Zero - Text));
+            --Size;
+        }
+    }
+
+    b32 Dot = memchr(Text, '.', Size) != 0;
+    b32 Separate = !Corpus->Compact || (Text[0] != '-' && !(Text[0] == '.' && W->Dot));
+
+    // note: a space after the letter too, except in compact text
+    if (W->Number ? Separate : !Corpus->Compact) {
+        W->Out->AppendF(" ");
+    }
+
+    W->Out->AppendF("%.*s", Size, Text);
+    W->Number = true;
+    W->Dot = Dot;
+}
+
+// note: a point, relative to Current when the corpus is relative
+internal void
+BenchWritePoint(bench_writer *W, bench_corpus *Corpus, svg_v2 P, svg_v2 Current)
+{
+    svg_v2 Written = Corpus->Relative ? P - Current : P;
+    BenchWriteNumber(W, Corpus, Written.x);
+    BenchWriteNumber(W, Corpus, Written.y);
+}
+
+// note: rounds to the decimals the corpus writes, so relative offsets add up to the same points
+internal r32
+BenchCorpusRound(bench_corpus *Corpus, r32 Value)
+{
+    r32 Scale = powf(10.0f, (r32)Corpus->Decimals);
+    return floorf(Value * Scale + 0.5f) / Scale;
+}
+
+/*  Deterministic svg of random walks over a Size x Size canvas, one path per walk. Every segment
+    picks its command by the weights, the first control points of S and T are reflections, arcs
+    get random radii and flags. The same corpus always produces the same bytes. */
+void
+BenchCorpusSvg(ls_stringbuf *Out, bench_corpus *Corpus)
+{
+    u32 State = Corpus->Seed ? Corpus->Seed : 1;
+    u32 Total = Corpus->Lines + Corpus->Curves + Corpus->Arcs;
+    r32 Step = Corpus->Size / 16.0f;
+
+    if (Corpus->Editor) {
+        Out->AppendF("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+                     "<!-- Created with an editor (http://example.com/) -->\n"
+                     "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" "
+                     "\"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\" [\n"
+                     "  <!ENTITY ns_svg \"http://www.w3.org/2000/svg\">\n]>\n");
+        Out->AppendF("<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:inkscape=\"http://www.inkscape.org/namespaces/inkscape\" "
+                     "xmlns:sodipodi=\"http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd\" "
+                     "inkscape:version=\"1.3\" viewBox=\"0 0 %.0f %.0f\">\n", Corpus->Size, Corpus->Size);
+        Out->AppendF("<sodipodi:namedview id=\"base\" pagecolor=\"#ffffff\" inkscape:zoom=\"0.5\">\n"
+                     "  <inkscape:grid type=\"xygrid\" id=\"grid1\"/>\n</sodipodi:namedview>\n");
+
+        // note: editors keep history, thumbnails and licenses here, it is most of such a file
+        Out->AppendF("<metadata id=\"metadata1\">\n<rdf:RDF>\n");
+        for (u32 i=0; i<Corpus->PathCount * 8; ++i) {
+            Out->AppendF("  <rdf:li rdf:resource=\"#history-%u\">step %u: moved node &lt;%u&gt; by %u, %u</rdf:li>\n",
+                         i, i, BenchRandom(&State) % 1000, BenchRandom(&State) % 100, BenchRandom(&State) % 100);
+        }
+        Out->AppendF("</rdf:RDF>\n</metadata>\n<title>corpus</title>\n");
+    } else {
+        Out->AppendF("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 %.0f %.0f\">\n", Corpus->Size, Corpus->Size);
+    }
+
+    for (u32 i=0; i<Corpus->PathCount; ++i) {
+        bench_writer W = {Out};
+        if (Corpus->Editor && i % 16 == 0) {
+            Out->AppendF("<!-- layer %u -->\n", i / 16);
+        }
+        if (Corpus->Editor) {
+            Out->AppendF("<path inkscape:connector-curvature=\"0\" id=\"path%u\" fill=\"#%06x\" d=\"", i,
+                         BenchRandom(&State) & 0xffffff);
+        } else {
+            Out->AppendF("<path fill=\"#%06x\" d=\"", BenchRandom(&State) & 0xffffff);
+        }
+
+        svg_v2 Current = {BenchCorpusRound(Corpus, BenchRandomRange(&State, 0.0f, Corpus->Size)),
+                          BenchCorpusRound(Corpus, BenchRandomRange(&State, 0.0f, Corpus->Size))};
+        bench_corpus Absolute = *Corpus;
+        Absolute.Relative = false;
+        BenchWriteCommand(&W, &Absolute, 'M');
+        BenchWritePoint(&W, &Absolute, Current, Current);
+
+        for (u32 s=0; s<Corpus->SegmentsPerPath; ++s) {
+            u32 Pick = Total ? BenchRandom(&State) % Total : 0;
+            u32 Variant = BenchRandom(&State) % 4;
+
+            svg_v2 Points[3];
+            for (u32 p=0; p<3; ++p) {
+                Points[p].x = BenchCorpusRound(Corpus, Current.x + BenchRandomRange(&State, -Step, Step));
+                Points[p].y = BenchCorpusRound(Corpus, Current.y + BenchRandomRange(&State, -Step, Step));
+            }
+
+            if (Pick < Corpus->Lines) {
+                if (Variant == 0) {
+                    BenchWriteCommand(&W, Corpus, 'H');
+                    BenchWriteNumber(&W, Corpus, Corpus->Relative ? Points[0].x - Current.x : Points[0].x);
+                    Current.x = Points[0].x;
+                } else if (Variant == 1) {
+                    BenchWriteCommand(&W, Corpus, 'V');
+                    BenchWriteNumber(&W, Corpus, Corpus->Relative ? Points[0].y - Current.y : Points[0].y);
+                    Current.y = Points[0].y;
+                } else {
+                    BenchWriteCommand(&W, Corpus, 'L');
+                    BenchWritePoint(&W, Corpus, Points[0], Current);
+                    Current = Points[0];
+                }
+            } else if (Pick < Corpus->Lines + Corpus->Curves) {
+                static const char Letters[] = {'C', 'S', 'Q', 'T'};
+                u32 Count[] = {3, 2, 2, 1};
+                BenchWriteCommand(&W, Corpus, Letters[Variant]);
+
+                for (u32 p=0; p<Count[Variant]; ++p) {
+                    BenchWritePoint(&W, Corpus, Points[p], Current);
+                }
+                Current = Points[Count[Variant] - 1];
+            } else {
+                BenchWriteCommand(&W, Corpus, 'A');
+                BenchWriteNumber(&W, Corpus, BenchCorpusRound(Corpus, BenchRandomRange(&State, Step * 0.5f, Step * 2.0f)));
+                BenchWriteNumber(&W, Corpus, BenchCorpusRound(Corpus, BenchRandomRange(&State, Step * 0.5f, Step * 2.0f)));
+                BenchWriteNumber(&W, Corpus, (r32)(BenchRandom(&State) % 360));
+
+                // note: flags are single tokens, they always need a separator
+                Out->AppendF(" %u %u", Variant & 1, Variant >> 1);
+                W.Number = true;
+                W.Dot = false;
+
+                BenchWritePoint(&W, Corpus, Points[0], Current);
+                Current = Points[0];
+            }
+        }
+
+        Out->AppendF(Corpus->Compact ? "Z\"/>\n" : " Z\"/>\n");
+    }
+
+    Out->AppendF("</svg>\n");
+}
+
+struct bench_result {
+    char Name[64];
+    r64 MBPerSecond;
+    r64 NsPerItem; // per segment, token or number, whatever the benchmark counts
+    u64 Allocations;
+    u64 PeakBytes;
+};
+
+global_variable svg_array<bench_result> BenchResults;
+
+// note: the parse benchmarks allocate from this, it is reset for every run
+global_variable svg_counting_allocator BenchCounting;
+
+internal void
+BenchRecord(char *Name, r64 Seconds, u64 Bytes, u64 Items, u64 Allocations, u64 PeakBytes)
+{
+    bench_result *Result = BenchResults.AllocN(1);
+    snprintf(Result->Name, sizeof(Result->Name), "%s", Name);
+    Result->MBPerSecond = Bytes / Seconds / 1e6;
+    Result->NsPerItem = Items ? Seconds * 1e9 / Items : 0.0;
+    Result->Allocations = Allocations;
+    Result->PeakBytes = PeakBytes;
+
+    printf("parser %-28s: %8.3f ms  %8.1f MB/s  %7.2f ns/item  %8llu allocations  %6.2f MB peak\n", Name,
+           Seconds * 1e3, Result->MBPerSecond, Result->NsPerItem, (unsigned long long)Allocations, PeakBytes / 1e6);
+}
+
+// note: runs Body Iterations times per run, best of five runs. The counts are those of one iteration
+#define BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, Body) \
+    { \
+        Best = 1e9; \
+        for (u32 Run=0; Run<5; ++Run) { \
+            SvgCountingAllocatorInit(&BenchCounting, 0, 0); \
+            r64 Start = BenchSeconds(); \
+            for (u32 It=0; It<(Iterations); ++It) { Body; } \
+            Best = fmin(Best, (BenchSeconds() - Start) / (Iterations)); \
+            Allocations = BenchCounting.Allocations / (Iterations); \
+            PeakBytes = BenchCounting.PeakBytes; \
+        } \
+    }
+
+/*  Microbenchmarks of the tokenizer and the parser on one corpus. TrimLeft, GetToken and the path
+    data parser run over the d attributes (the tokenizer reads a quoted attribute as one string),
+    TokenToReal32 over their real tokens, SvgParse over the whole text. */
+void
+BenchParser(char *Name, ls_stringbuf *Text, u32 Iterations)
+{
+    char Label[64];
+    r64 Best;
+    u64 Allocations;
+    u64 PeakBytes;
+
+    svg_array<ls_string> Paths = {};
+    BenchPathData((u8 *)Text->Data, Text->Size, &Paths);
+
+    u64 PathBytes = 0;
+    svg_array<token> Reals = {};
+    for (u32 i=0; i<Paths.Count; ++i) {
+        PathBytes += Paths.Data[i].Size;
+
+        ls_parser P = Paths.Data[i];
+        while (P.RemainingBytes()) {
+            token Token = P.GetToken();
+            if (Token.Type == Token_Real) {
+                Reals.Push(Token);
+            }
+        }
+    }
+
+    // note: whitespace runs are short in path data, this is mostly the call and the first compare
+    u64 Calls = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        Calls = 0;
+        for (u32 i=0; i<Paths.Count; ++i) {
+            ls_parser P = Paths.Data[i];
+            while (P.RemainingBytes()) {
+                P.TrimLeft();
+                ++P.At;
+                ++Calls;
+            }
+        }
+    });
+    snprintf(Label, sizeof(Label), "%s trimleft", Name);
+    BenchRecord(Label, Best, PathBytes, Calls, Allocations, PeakBytes);
+
+    u64 Tokens = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        Tokens = 0;
+        for (u32 i=0; i<Paths.Count; ++i) {
+            ls_parser P = Paths.Data[i];
+            while (P.RemainingBytes()) {
+                P.GetToken();
+                ++Tokens;
+            }
+        }
+    });
+    snprintf(Label, sizeof(Label), "%s gettoken", Name);
+    BenchRecord(Label, Best, PathBytes, Tokens, Allocations, PeakBytes);
+
+    u64 RealBytes = 0;
+    for (u32 i=0; i<Reals.Count; ++i) {
+        RealBytes += Reals.Data[i].Text.Size;
+    }
+
+    // note: the sum keeps the conversions from being optimized away
+    volatile r32 Sink = 0.0f;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        r32 Sum = 0.0f;
+        for (u32 i=0; i<Reals.Count; ++i) {
+            Sum += ls_parser::TokenToReal32(Reals.Data[i]);
+        }
+        Sink += Sum;
+    });
+    snprintf(Label, sizeof(Label), "%s tokentoreal32", Name);
+    BenchRecord(Label, Best, RealBytes, Reals.Count, Allocations, PeakBytes);
+
+    // note: the path data read as a whitespace and comma list, the way list attributes are split
+    u64 Fields = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        Fields = 0;
+        for (u32 i=0; i<Paths.Count; ++i) {
+            ls_split_iterator Split(Paths.Data[i], (char *)" ,\t\r\n");
+            ls_string Field;
+            while (Split.Next(&Field)) {
+                ++Fields;
+            }
+        }
+    });
+    snprintf(Label, sizeof(Label), "%s split", Name);
+    BenchRecord(Label, Best, PathBytes, Fields, Allocations, PeakBytes);
+
+    u64 Lines = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        Lines = 0;
+        ls_line_iterator Iterator(ls_string(Text->Data, Text->Size));
+        ls_string Line;
+        while (Iterator.Next(&Line)) {
+            ++Lines;
+        }
+    });
+    snprintf(Label, sizeof(Label), "%s lines", Name);
+    BenchRecord(Label, Best, Text->Size, Lines, Allocations, PeakBytes);
+
+    u64 Segments = 0;
+    svg Svg = {};
+
+    // note: SvgParsePath is called by SvgParse, which sets up the command letters
+    SvgInitCommandMap();
+
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        Segments = 0;
+        Svg.Elements.Allocator = &BenchCounting.Allocator;
+        for (u32 i=0; i<Paths.Count; ++i) {
+            Svg.Elements.Count = 0;
+            SvgParsePath(&Svg, Paths.Data[i]);
+            Segments += Svg.Elements.Data[0].Path.Segments.Count;
+            Svg.Elements.Data[0].Path.Segments.Free();
+            Svg.Elements.Data[0].Path.Subpaths.Free();
+        }
+        Svg.Elements.Free();
+    });
+    snprintf(Label, sizeof(Label), "%s svgparsepath", Name);
+    BenchRecord(Label, Best, PathBytes, Segments, Allocations, PeakBytes);
+
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        svg Parsed = SvgParse((u8 *)Text->Data, Text->Size, &BenchCounting.Allocator);
+        SvgFree(&Parsed);
+    });
+    snprintf(Label, sizeof(Label), "%s svgparse", Name);
+    BenchRecord(Label, Best, Text->Size, Segments, Allocations, PeakBytes);
+
+    // note: the tag scan alone, then with every path decoded on first access
+    u32 Elements = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        svg Parsed = SvgParseLazy((u8 *)Text->Data, Text->Size, &BenchCounting.Allocator);
+        Elements = Parsed.Elements.Count;
+        SvgFree(&Parsed);
+    });
+    snprintf(Label, sizeof(Label), "%s lazy scan", Name);
+    BenchRecord(Label, Best, Text->Size, Elements, Allocations, PeakBytes);
+
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        svg Parsed = SvgParseLazy((u8 *)Text->Data, Text->Size, &BenchCounting.Allocator);
+        SvgDecodeAll(&Parsed);
+        SvgFree(&Parsed);
+    });
+    snprintf(Label, sizeof(Label), "%s lazy decode", Name);
+    BenchRecord(Label, Best, Text->Size, Segments, Allocations, PeakBytes);
+
+    /*  Typing over a digit of the middle path, the bytes are those a full parse per keystroke would
+        read. The document outlives the runs, which restart BenchCounting, so it uses malloc and the
+        allocations aren't counted. */
+    u32 Keystrokes = 100;
+    svg Edited = SvgParse((u8 *)Text->Data, Text->Size);
+    if (Edited.Elements.Count) {
+        ls_string Source = Edited.Elements.Data[Edited.Elements.Count / 2].Source;
+        char *Digit = Source.Data;
+        while (Digit < Source.Data + Source.Size && (*Digit < '0' || *Digit > '9')) {
+            ++Digit;
+        }
+
+        svg_edit Edit = {(u32)(Digit - Text->Data), 1, 1};
+        u32 Applied = 0;
+        BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+            for (u32 i=0; i<Keystrokes; ++i) {
+                *Digit = (char)('0' + (*Digit - '0' + 1) % 10);
+                Applied += SvgApplyEdit(&Edited, (u8 *)Text->Data, (u8 *)Text->Data, Text->Size, Edit);
+            }
+        });
+        snprintf(Label, sizeof(Label), "%s edit keystroke", Name);
+        BenchRecord(Label, Best, (u64)Text->Size * Keystrokes, Keystrokes, Allocations, PeakBytes);
+
+        u32 Typed = 5 * Iterations * Keystrokes;
+        if (Applied != Typed) {
+            printf("parser %-28s: %u of %u edits needed a full parse\n", Name, Typed - Applied, Typed);
+        }
+    }
+    SvgFree(&Edited);
+
+    svg_counting_allocator Counting;
+    SvgCountingAllocatorInit(&Counting, 0, 0);
+    svg Parsed = SvgParse((u8 *)Text->Data, Text->Size, &Counting.Allocator);
+    svg_memory_report Report = SvgMemoryReport(&Counting, &Parsed);
+    printf("parser %-28s: %llu allocations  %.2f MB held  %.2f MB peak  %.1f bytes/segment\n", Name,
+           (unsigned long long)Report.Allocations, Report.Bytes / 1e6, Report.PeakBytes / 1e6, Report.BytesPerSegment);
+    SvgFree(&Parsed);
+
+    free(Reals.Data);
+    free(Paths.Data);
+}
+
+/*  Strings the way documents and the writer build them: short ids, copies and moves of them and a
+    long output buffer on the heap and in an arena. The heap goes through BenchCounting, so the
+    allocation counts show which of them touch it. */
+
+internal char *
+BenchStringAlloc(void *Data, u32 Size)
+{
+    return (char *)SvgAllocate((svg_allocator *)Data, Size);
+}
+
+internal char *
+BenchStringRealloc(void *Data, void *String, u32 Size)
+{
+    ls_stringbuf *S = (ls_stringbuf *)String;
+    return (char *)SvgReallocate((svg_allocator *)Data, S->Data, S->Cap, Size);
+}
+
+internal void
+BenchStringFree(void *Data, void *String)
+{
+    ls_stringbuf *S = (ls_stringbuf *)String;
+    SvgDeallocate((svg_allocator *)Data, S->Data, S->Cap);
+}
+
+internal void
+BenchIdString(ls_stringbuf *Out, char *Prefix, u32 Index)
+{
+    char Digits[16];
+    u32 Count = 0;
+
+    do {
+        Digits[Count++] = (char)('0' + Index % 10);
+        Index /= 10;
+    } while (Index);
+
+    Out->AppendCString(Prefix);
+    while (Count) {
+        Out->AppendChar(Digits[--Count]);
+    }
+}
+
+internal void
+BenchOutputString(ls_stringbuf *Out, u32 Count)
+{
+    for (u32 i=0; i<Count; ++i) {
+        Out->AppendCString((char *)"<path id=\"");
+        BenchIdString(Out, (char *)"path-", i);
+        Out->AppendCString((char *)"\" class=\"icon\"/>\n");
+    }
+}
+
+/*  The r32 pipeline the scalar templates must not slow down: SvgParse of the dense document and
+    flattening all of its paths, at the tolerance the rasterizer uses. Recorded with the parser
+    results, so a baseline from before a change to the geometry types shows any regression. */
+internal void
+BenchFloatPath(u32 Iterations)
+{
+    r64 Best;
+    u64 Allocations;
+    u64 PeakBytes;
+
+    ls_stringbuf Dense;
+    BenchDenseSvg(&Dense, 20000, 4096.0f, 1234);
+    svg Svg = SvgParse((u8 *)Dense.Data, Dense.Size);
+
+    u64 Segments = 0;
+    for (u32 i=0; i<Svg.Elements.Count; ++i) {
+        svg_element *E = Svg.Elements.Data + i;
+        Segments += (E->Type == SvgElement_Path) ? SvgElementPath(&Svg, E)->Segments.Count : 0;
+    }
+
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        svg Parsed = SvgParse((u8 *)Dense.Data, Dense.Size, &BenchCounting.Allocator);
+        SvgFree(&Parsed);
+    });
+    BenchRecord((char *)"dense r32 parse", Best, Dense.Size, Segments, Allocations, PeakBytes);
+
+    // note: the polyline keeps its arrays between runs, flattening itself doesn't allocate
+    svg_polyline Polyline = {};
+    u64 Points = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        Points = 0;
+        for (u32 i=0; i<Svg.Elements.Count; ++i) {
+            svg_element *E = Svg.Elements.Data + i;
+            if (E->Type == SvgElement_Path) {
+                Polyline.Points.Count = 0;
+                Polyline.ContourEnds.Count = 0;
+                SvgFlattenPath(SvgElementPath(&Svg, E), SvgScaleTransform(1.0f), SVG_RASTER_TOLERANCE, &Polyline);
+                Points += Polyline.Points.Count;
+            }
+        }
+    });
+    BenchRecord((char *)"dense r32 flatten", Best, Points * sizeof(svg_v2), Segments, Allocations, PeakBytes);
+
+    Polyline.Points.Free();
+    Polyline.ContourEnds.Free();
+    SvgFree(&Svg);
+    Dense.Free();
+}
+
+internal void
+BenchStrings(u32 Count, u32 Iterations)
+{
+    r64 Best;
+    u64 Allocations;
+    u64 PeakBytes;
+
+    ls_string_allocator Heap = {&BenchCounting.Allocator, BenchStringAlloc, BenchStringRealloc, BenchStringFree};
+
+    u64 IdBytes = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        IdBytes = 0;
+        for (u32 i=0; i<Count; ++i) {
+            ls_stringbuf Id(Heap);
+            BenchIdString(&Id, (char *)"path-", i);
+            IdBytes += Id.Size;
+        }
+    });
+    BenchRecord((char *)"strings ids", Best, IdBytes, Count, Allocations, PeakBytes);
+
+    // note: a copy into a new string, a move out of it and an assignment over an existing one
+    u64 CopyBytes = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        CopyBytes = 0;
+        ls_stringbuf Class(Heap);
+        for (u32 i=0; i<Count; ++i) {
+            ls_stringbuf Id(Heap);
+            BenchIdString(&Id, (char *)"icon-button-", i);
+            ls_stringbuf Copy = Id;
+            ls_stringbuf Moved(static_cast<ls_stringbuf &&>(Copy));
+            Class = Moved;
+            CopyBytes += Class.Size;
+        }
+    });
+    BenchRecord((char *)"strings copy move", Best, CopyBytes, Count, Allocations, PeakBytes);
+
+    u64 OutputBytes = 0;
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        ls_stringbuf Out(Heap);
+        BenchOutputString(&Out, Count);
+        OutputBytes = Out.Size;
+    });
+    BenchRecord((char *)"strings output heap", Best, OutputBytes, Count, Allocations, PeakBytes);
+
+    // note: the arena has room for all of it, past that the string would spill to the heap
+    u32 ArenaSize = (u32)OutputBytes * 2;
+    void *ArenaMemory = malloc(ArenaSize);
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        ls_string_arena Arena(ArenaMemory, ArenaSize);
+        ls_stringbuf Out(&Arena);
+        Out.Allocator = Heap;
+        BenchOutputString(&Out, Count);
+    });
+    BenchRecord((char *)"strings output arena", Best, OutputBytes, Count, Allocations, PeakBytes);
+
+    free(ArenaMemory);
+}
+
+/*  Skipping over a large comment or metadata block, text with dashes and tags sprinkled through it
+    so the first-byte filter has candidates to reject. The bytewise loop is the search the parser
+    used before, for comparison. */
+internal void
+BenchSkip(u32 Size, u32 Iterations)
+{
+    r64 Best;
+    u64 Allocations;
+    u64 PeakBytes;
+
+    char *Text = (char *)malloc(Size);
+    u32 Seed = 11;
+    for (u32 i=0; i<Size; ++i) {
+        u32 R = BenchRandom(&Seed) % 64;
+        Text[i] = (R == 0) ? '-' : (R == 1) ? '/' : (R == 2) ? 'm' : (char)('a' + R % 26);
+    }
+
+    char *Tail = (char *)"--></metadata><";
+    u32 TailSize = (u32)strlen(Tail);
+    memcpy(Text + Size - TailSize, Tail, TailSize);
+
+    struct {
+        char *Name;
+        char *Needle;
+    } Searches[] = {
+        {(char *)"skip comment", (char *)"-->"},
+        {(char *)"skip metadata", (char *)"</metadata>"},
+        {(char *)"skip char", (char *)"<"},
+    };
+
+    u64 Found = 0;
+    for (u32 i=0; i<ArrayCount(Searches); ++i) {
+        BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+            ls_parser P(Text, Size);
+            Found += P.FFToStringEnd(Searches[i].Needle) ? 1 : 0;
+        });
+        BenchRecord(Searches[i].Name, Best, Size, Size, Allocations, PeakBytes);
+    }
+
+    BENCH_BEST_OF(Best, Allocations, PeakBytes, Iterations, {
+        ls_parser P(Text, Size);
+        while (P.RemainingBytes() >= 3 && !P.StartsWith((char *)"-->", 3)) {
+            ++P.At;
+        }
+        Found += P.RemainingBytes() >= 3;
+    });
+    BenchRecord((char *)"skip bytewise", Best, Size, Size, Allocations, PeakBytes);
+
+    if (Found != (ArrayCount(Searches) + 1) * 5 * Iterations) {
+        printf("skip: a search missed its needle\n");
+    }
+
+    free(Text);
+}
+
+// note: differences between an edited document and a full parse of its text, spans and dashes included
+internal u32
+BenchEditDifferences(svg *Edited, char *Text, u32 Size)
+{
+    svg Parsed = SvgParse((u8 *)Text, Size);
+    u32 Differences = (Edited->Elements.Count != Parsed.Elements.Count);
+
+    for (u32 i=0; !Differences && i<Parsed.Elements.Count; ++i) {
+        svg_element *A = Edited->Elements.Data + i;
+        svg_element *B = Parsed.Elements.Data + i;
+        svg_stroke_style *SA = &A->StrokeStyle;
+        svg_stroke_style *SB = &B->StrokeStyle;
+
+        Differences += (A->Markup.Data != B->Markup.Data || A->Markup.Size != B->Markup.Size);
+        Differences += (A->Source.Data != B->Source.Data || A->Id.Data != B->Id.Data);
+        Differences += (SA->Width != SB->Width || SA->DashCount != SB->DashCount);
+        Differences += (SA->DashFirst + SA->DashCount > Edited->Dashes.Count);
+        for (u32 d=0; !Differences && d<SA->DashCount; ++d) {
+            Differences += (Edited->Dashes.Data[SA->DashFirst + d] != Parsed.Dashes.Data[SB->DashFirst + d]);
+        }
+
+        svg_path *PA = SvgElementPath(Edited, A);
+        Differences += (PA->Segments.Count != B->Path.Segments.Count || PA->Subpaths.Count != B->Path.Subpaths.Count);
+        for (u32 s=0; !Differences && s<PA->Segments.Count; ++s) {
+            Differences += (PA->Segments.Data[s].P1 != B->Path.Segments.Data[s].P1 ||
+                            PA->Segments.Data[s].P2 != B->Path.Segments.Data[s].P2);
+        }
+    }
+
+    SvgFree(&Parsed);
+    return Differences;
+}
+
+/*  Keystrokes into a document with an inherited dasharray, each checked against a full parse. The
+    ones the parser can't read yet have to come back false with the document untouched, those are
+    tried on a copy and the text stays as it was. */
+internal void
+BenchEditCheck()
+{
+    struct {
+        char *After; // the edit starts right after the first match
+        u32 Removed;
+        char *Inserted;
+        b32 Applies;
+    } Edits[] = {
+        {(char *)"L10 ", 1, (char *)"2", true},
+        {(char *)"L10 20", 0, (char *)" ", true},
+        {(char *)"d=\"M0 0 L10", 3, (char *)"", false}, // "L10 L10 10", a point cut in half
+        {(char *)"L10 20 ", 0, (char *)"L", false},
+        {(char *)"L10 20 ", 0, (char *)"L5 5 Z", true},
+        {(char *)"<path", 0, (char *)" stroke-width=\"", false},
+        {(char *)"<path", 0, (char *)" stroke-width=\"\"", false},
+        {(char *)"<path", 0, (char *)" stroke-width=\"3\"", true},
+        {(char *)"<path id=\"b\"", 0, (char *)" stroke-dasharray=\"1 2 3\"", true},
+        {(char *)"<path id=\"b\"", 0, (char *)" fill", false},
+        {(char *)"<path id=\"b\"", 0, (char *)" fill=", false},
+        {(char *)"<path id=\"b\"", 0, (char *)" fill=\"#f00\"", true},
+        {(char *)"M1 1", 1, (char *)"7", true},
+    };
+
+    char Start[] = "<svg stroke=\"#000\" stroke-dasharray=\"4 2\">\n"
+                   "<path id=\"a\" d=\"M0 0 L10 0 L10 20\"/>\n"
+                   "<path id=\"b\" d=\"M1 1 h5 v5 z\"/>\n"
+                   "<path id=\"c\" d=\"M2 2 L3 3\"/>\n"
+                   "</svg>\n";
+
+    for (u32 Lazy=0; Lazy<2; ++Lazy) {
+        u32 Size = (u32)strlen(Start);
+        char *Text = (char *)malloc(Size);
+        memcpy(Text, Start, Size);
+
+        svg Svg = Lazy ? SvgParseLazy((u8 *)Text, Size) : SvgParse((u8 *)Text, Size);
+        u32 Differences = 0;
+
+        for (u32 i=0; i<ArrayCount(Edits); ++i) {
+            char *Match = ls_string_Find(Text, Size, Edits[i].After, (u32)strlen(Edits[i].After));
+            u32 Offset = (u32)(Match - Text) + (u32)strlen(Edits[i].After);
+            u32 Inserted = (u32)strlen(Edits[i].Inserted);
+            u32 NewSize = Size - Edits[i].Removed + Inserted;
+
+            char *New = (char *)malloc(NewSize);
+            memcpy(New, Text, Offset);
+            memcpy(New + Offset, Edits[i].Inserted, Inserted);
+            memcpy(New + Offset + Inserted, Text + Offset + Edits[i].Removed, Size - Offset - Edits[i].Removed);
+
+            svg_element Before = Svg.Elements.Data[0];
+            b32 Applied = SvgApplyEdit(&Svg, (u8 *)Text, (u8 *)New, NewSize, {Offset, Edits[i].Removed, Inserted});
+            Differences += (Applied != Edits[i].Applies);
+
+            if (Applied) {
+                free(Text);
+                Text = New;
+                Size = NewSize;
+            } else {
+                Differences += (Svg.Elements.Data[0].Markup.Data != Before.Markup.Data);
+                free(New);
+            }
+
+            Differences += BenchEditDifferences(&Svg, Text, Size);
+        }
+
+        printf("parser edit check%s: %u edits, %u differences from a full parse\n", Lazy ? " lazy" : "",
+               (u32)ArrayCount(Edits), Differences);
+
+        SvgFree(&Svg);
+        free(Text);
+    }
+}
+
+internal void
+BenchParserSuite()
+{
+    // note: PathCount, SegmentsPerPath, Size, Seed, Decimals, Lines, Curves, Arcs, Relative, Compact, Editor
+    struct {
+        char *Name;
+        bench_corpus Corpus;
+    } Corpora[] = {
+        {(char *)"lines", {2000, 200, 4096.0f, 7, 2, 1, 0, 0, false, false}},
+        {(char *)"curves", {2000, 100, 4096.0f, 7, 2, 0, 1, 0, false, false}},
+        {(char *)"arcs", {2000, 100, 4096.0f, 7, 2, 0, 0, 1, false, false}},
+        {(char *)"mixed relative", {2000, 100, 4096.0f, 7, 3, 4, 4, 1, true, false}},
+        {(char *)"mixed compact", {2000, 100, 4096.0f, 7, 3, 4, 4, 1, true, true}},
+        {(char *)"editor export", {2000, 20, 4096.0f, 7, 3, 4, 4, 1, false, false, true}},
+    };
+
+    for (u32 i=0; i<ArrayCount(Corpora); ++i) {
+        ls_stringbuf Text;
+        BenchCorpusSvg(&Text, &Corpora[i].Corpus);
+        BenchParser(Corpora[i].Name, &Text, 3);
+        Text.Free();
+    }
+
+    BenchFloatPath(3);
+    BenchStrings(20000, 3);
+    BenchSkip(8 << 20, 3);
+    BenchEditCheck();
+}
+
+/*  Results as JSON, one result per line so a baseline can be read back with sscanf:
+
+    {"results": [
+    {"name": "lines gettoken", "mb_per_s": 512.3, "ns_per_item": 3.21, "allocations": 0, "peak_bytes": 0},
+    ...
+    ]} */
+b32
+BenchWriteJson(char *FileName)
+{
+    FILE *F = fopen(FileName, "wb");
+    if (!F) {
+        return false;
+    }
+
+    fprintf(F, "{\"results\": [\n");
+    for (u32 i=0; i<BenchResults.Count; ++i) {
+        bench_result *R = BenchResults.Data + i;
+        fprintf(F, "{\"name\": \"%s\", \"mb_per_s\": %.3f, \"ns_per_item\": %.3f, \"allocations\": %llu, \"peak_bytes\": %llu}%s\n",
+                R->Name, R->MBPerSecond, R->NsPerItem, (unsigned long long)R->Allocations,
+                (unsigned long long)R->PeakBytes, (i + 1 < BenchResults.Count) ? "," : "");
+    }
+    fprintf(F, "]}\n");
+    fclose(F);
+
+    return true;
+}
+
+// note: slower than the baseline by more than this fraction is a regression
+#define BENCH_REGRESSION 0.10
+
+/*  Compares the results with a baseline written by BenchWriteJson. Throughput down by more than
+    BENCH_REGRESSION, any new allocation or a higher peak counts as a regression, returns how many
+    there were. */
+u32
+BenchCompareBaseline(char *FileName)
+{
+    file File = {};
+    if (!ReadFile(FileName, &File)) {
+        printf("can't read baseline %s\n", FileName);
+        return 1;
+    }
+
+    u32 Regressions = 0;
+    ls_parser Lines((char *)File.Data, File.Size);
+    ls_parser Line;
+
+    while (Lines.GetLine(&Line)) {
+        char Text[256];
+        u32 Size = (Line.Size < sizeof(Text) - 1) ? Line.Size : (u32)sizeof(Text) - 1;
+        memcpy(Text, Line.Data, Size);
+        Text[Size] = 0;
+
+        bench_result Base = {};
+        unsigned long long Allocations;
+        unsigned long long PeakBytes;
+        if (sscanf(Text, "{\"name\": \"%63[^\"]\", \"mb_per_s\": %lf, \"ns_per_item\": %lf, \"allocations\": %llu, \"peak_bytes\": %llu",
+                   Base.Name, &Base.MBPerSecond, &Base.NsPerItem, &Allocations, &PeakBytes) != 5)
+        {
+            continue;
+        }
+        Base.Allocations = Allocations;
+        Base.PeakBytes = PeakBytes;
+
+        for (u32 i=0; i<BenchResults.Count; ++i) {
+            bench_result *R = BenchResults.Data + i;
+            if (strcmp(R->Name, Base.Name)) {
+                continue;
+            }
+
+            r64 Change = R->MBPerSecond / Base.MBPerSecond - 1.0;
+            b32 Regressed = Change < -BENCH_REGRESSION || R->Allocations > Base.Allocations ||
+                            R->PeakBytes > Base.PeakBytes;
+            Regressions += Regressed ? 1 : 0;
+
+            printf("baseline %-28s: %8.1f -> %8.1f MB/s  %+6.1f%%  allocations %llu -> %llu  peak %llu -> %llu%s\n",
+                   R->Name, Base.MBPerSecond, R->MBPerSecond, Change * 100.0, Allocations,
+                   (unsigned long long)R->Allocations, PeakBytes, (unsigned long long)R->PeakBytes,
+                   Regressed ? "  REGRESSED" : "");
+        }
+    }
+
+    free(File.Data);
+    return Regressions;
+}
+
+// note: a timeline of parsing one file and a generated corpus, the first parse is the one traced
+void
+BenchTrace(char *FileName, char *TraceName)
+{
+    file File = {};
+    if (!ReadFile(FileName, &File)) {
+        printf("can't read %s\n", FileName);
+        return;
+    }
+
+    bench_corpus Corpus = {200, 100, 4096.0f, 7, 3, 4, 4, 1, true, false};
+    ls_stringbuf Text;
+    BenchCorpusSvg(&Text, &Corpus);
+
+    SvgTraceReset();
+    SvgParse(File.Data, File.Size);
+    SvgParse((u8 *)Text.Data, Text.Size);
+
+    if (SvgTraceWrite(TraceName)) {
+        printf("trace written to %s\n", TraceName);
+    } else {
+        printf("can't write %s\n", TraceName);
+    }
+
+    free(File.Data);
+    Text.Free();
+}
+
+int
+main(int ArgCount, char **Args)
+{
+    // note: bench [file.svg] [--parser] [--json results.json] [--baseline results.json] [--trace trace.json]
+    char *FileName = (char *)"electronjs.svg";
+    char *TraceName = 0;
+    char *JsonName = 0;
+    char *BaselineName = 0;
+    b32 ParserOnly = false;
+
+    for (int i=1; i<ArgCount; ++i) {
+        if (!strcmp(Args[i], "--parser")) {
+            ParserOnly = true;
+        } else if (!strcmp(Args[i], "--json") && i + 1 < ArgCount) {
+            JsonName = Args[++i];
+        } else if (!strcmp(Args[i], "--baseline") && i + 1 < ArgCount) {
+            BaselineName = Args[++i];
+        } else if (!strcmp(Args[i], "--trace") && i + 1 < ArgCount) {
+            TraceName = Args[++i];
+        } else {
+            FileName = Args[i];
+        }
+    }
+
+    if (TraceName) {
+        BenchTrace(FileName, TraceName);
+    }
+
+    BenchParserSuite();
+
+    if (JsonName && !BenchWriteJson(JsonName)) {
+        printf("can't write %s\n", JsonName);
+    }
+
+    u32 Regressions = BaselineName ? BenchCompareBaseline(BaselineName) : 0;
+
+    if (ParserOnly) {
+        return Regressions ? 1 : 0;
+    }
+
+    file SvgFile = {};
+    if (!ReadFile(FileName, &SvgFile)) {
+        printf("can't read %s\n", FileName);
+        return 1;
+    }
+
+    svg Svg = SvgParse(SvgFile.Data, SvgFile.Size);
+
+    BenchRaster(&Svg, 64, 20000);
+    BenchRaster(&Svg, 256, 2000);
+    BenchRaster(&Svg, 1024, 200);
+
+    ls_stringbuf Dense;
+    BenchDenseSvg(&Dense, 20000, 4096.0f, 1234);
+    svg DenseSvg = SvgParse((u8 *)Dense.Data, Dense.Size);
+    BenchTiledCheck(2000);
+    BenchTiled(&DenseSvg, 4096, 1.0f);
+
+    BenchHitTest((char *)"icon", &Svg, 100000, true);
+    BenchHitTest((char *)"dense", &DenseSvg, 2000, false);
+    svg ShapesSvg = SvgParse((u8 *)BenchHitShapes, sizeof(BenchHitShapes) - 1);
+    BenchHitCheck((char *)"icon", &Svg, SvgScaleTransform(4.0f), 256);
+    BenchHitCheck((char *)"icon rotated", &Svg, {3.2f, 1.9f, -2.1f, 3.0f, 140.0f, -30.0f}, 256);
+    BenchHitCheck((char *)"shapes", &ShapesSvg, {1.2f, 0.4f, -0.3f, 1.1f, 20.0f, 4.0f}, 256);
+    SvgFree(&ShapesSvg);
+
+    BenchStream(&Svg, 16384, 64);
+
+    svg_job_pool Pool;
+    SvgJobPoolStart(&Pool, 0);
+    BenchDistanceCheck(20000);
+    BenchDistanceField(&Svg, 64, 1, &Pool);
+    BenchDistanceField(&Svg, 256, 1, &Pool);
+    BenchDistanceField(&Svg, 64, 3, &Pool);
+    BenchDistanceField(&Svg, 256, 3, &Pool);
+    BenchAtlas(&Svg, 199, &Pool);
+    BenchStrokeAreaCheck();
+    BenchStroke((char *)"icon round", &Svg, {2.0f, SvgLineJoin_Round, SvgLineCap_Round, 4.0f}, &Pool);
+    BenchStroke((char *)"dense miter", &DenseSvg, {3.0f, SvgLineJoin_Miter, SvgLineCap_Butt, 4.0f}, &Pool);
+    BenchLod(&DenseSvg, 120, 16 << 20, &Pool);
+    BenchLod(&DenseSvg, 120, 128 << 20, &Pool);
+    SvgJobPoolStop(&Pool);
+
+    BenchTessellate((char *)"icon 256px", &Svg, 4.0f);
+    BenchTessellate((char *)"dense 4096px", &DenseSvg, 1.0f);
+
+    BenchMeasure((char *)"icon", &Svg, 10000);
+    BenchMeasure((char *)"dense", &DenseSvg, 100);
+
+    BenchSimplify((char *)"icon", &Svg, 0.05f, false);
+    BenchSimplify((char *)"icon", &Svg, 0.05f, true);
+    BenchSimplify((char *)"dense", &DenseSvg, 0.25f, false);
+    BenchSimplify((char *)"dense", &DenseSvg, 0.25f, true);
+
+    BenchPack((char *)"icon", &Svg, 0.0f);
+    BenchPack((char *)"icon 1/64", &Svg, 1.0f / 64.0f);
+    BenchPack((char *)"dense", &DenseSvg, 0.0f);
+    BenchPack((char *)"dense 1/64", &DenseSvg, 1.0f / 64.0f);
+
+    ls_stringbuf Repeat;
+    BenchRepeatSvg(&Repeat, 50000, 4096.0f, 99);
+    svg RepeatSvg = SvgParse((u8 *)Repeat.Data, Repeat.Size);
+    BenchDedup((char *)"diagram exact", &RepeatSvg, 0.0f, false, false);
+    BenchDedup((char *)"diagram translated", &RepeatSvg, 0.0f, true, false);
+    BenchDedup((char *)"diagram translated 1e-3", &RepeatSvg, 1e-3f, true, false);
+    BenchDedup((char *)"diagram subpaths 1e-3", &RepeatSvg, 1e-3f, true, true);
+    BenchDedup((char *)"dense subpaths 1e-3", &DenseSvg, 1e-3f, true, true);
+
+    BenchWrite((char *)"icon shortest", &Svg, SvgFile.Size, SVG_WRITE_SHORTEST, false);
+    BenchWrite((char *)"dense shortest", &DenseSvg, Dense.Size, SVG_WRITE_SHORTEST, false);
+    BenchWrite((char *)"dense absolute", &DenseSvg, Dense.Size, SVG_WRITE_SHORTEST, true);
+    BenchWrite((char *)"dense 2 decimals", &DenseSvg, Dense.Size, 2, false);
+
+    svg_array<ls_string> Paths = {};
+    BenchPathData((u8 *)Dense.Data, Dense.Size, &Paths);
+    BenchScalar<r32>((char *)"r32", &Paths, 5);
+    BenchScalar<r64>((char *)"r64", &Paths, 5);
+    BenchScalar<svg_fixed_24_8>((char *)"24.8", &Paths, 5);
+    BenchScalar<svg_fixed_16_16>((char *)"16.16", &Paths, 5);
+
+    return Regressions ? 1 : 0;
+}
@@ -4,11 +4,17 @@ set ProjectDir="P:\\ls\\svg"
 
 pushd %ProjectDir%\
 
-set Common=-TP -MT -FC -Zi -nologo -wd4700 -wd4312 -wd4311 -wd4530 -Od
+set Common=-TP -MT -FC -Zi -nologo -wd4700 -wd4312 -wd4311 -wd4530
 
 rem Compile App:
 cl /TP /std:c++14 /Fesvg ^
-    %Common% ^
+    %Common% -Od ^
     %ProjectDir%\main.cpp ^
     /link -SUBSYSTEM:console
+
+rem Compile Bench:
+cl /TP /std:c++14 /Fesvg_bench ^
+    %Common% -O2 ^
+    %ProjectDir%\bench.cpp ^
+    /link -SUBSYSTEM:console
 popd
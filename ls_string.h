@@ -7,6 +7,27 @@ enum ls_string_allocator_ {};
 
 #define LS_STRING_ASSERT(Expression) { if (!(Expression)) {*(int*)0 = 0;} }
 #define LS_STRING_DEFAULT_SIZE 256
+#define LS_STRING_INLINE_SIZE 24
+#define LS_STRING_MAX_DELIMITERS 8
+
+#if defined(__AVX2__)
+#define LS_STRING_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LS_STRING_SSE2
+#endif
+
+#if defined(LS_STRING_AVX2) || defined(LS_STRING_SSE2)
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+inline u32 ls_string_Ctz(u32 Value) { unsigned long Index; _BitScanForward(&Index, Value); return (u32)Index; }
+#else
+inline u32 ls_string_Ctz(u32 Value) { return (u32)__builtin_ctz(Value); }
+#endif
 
 inline int ls_string_Max(int A, int B) { return A >= B ? A : B; }
 int ls_string_Strlen(char *S) { int Len=0; LS_STRING_ASSERT(S); while (*S++) { ++Len; } return Len; }
@@ -24,11 +45,28 @@ void ls_string_Memcpy(void *To, void *From, int Size) {
 
 typedef char * ls_string_alloc(void *Data, u32 Size);
 typedef char * ls_string_realloc(void *Data, void *String, u32 Size);
+typedef void ls_string_free(void *Data, void *String);
 
 struct ls_string_allocator {
     void *Data;
     ls_string_alloc *Alloc;
     ls_string_realloc *Realloc;
+    ls_string_free *Free; // 0 when the allocator owns its memory, e.g. a frame arena
+};
+
+/*  Bump memory for string buffers. A buffer that grows while its bytes are the last thing pushed
+    extends in place, otherwise it moves to a new block. Nothing is freed until Reset. */
+struct ls_string_arena {
+    char *Data;
+    u32 Size;
+    u32 Cap;
+
+    ls_string_arena() { this->Data = 0; this->Size = 0; this->Cap = 0; }
+    ls_string_arena(void *Memory, u32 Cap) { this->Data = (char *)Memory; this->Size = 0; this->Cap = Cap; }
+
+    char *Push(u32 Size);
+    bool Extend(char *String, u32 Cap, u32 NewCap);
+    void Reset() { this->Size = 0; }
 };
 
 struct ls_string {
@@ -157,91 +195,126 @@ struct ls_static_string : ls_mutable_string {
     void FitSize(u32 Size);
 };
 
+enum ls_stringbuf_storage_ {
+    StringStorage_Inline,
+    StringStorage_Heap,
+    StringStorage_Arena,
+};
+
+/*  Growable string. Short strings (up to LS_STRING_INLINE_SIZE - 2 chars) live inside the object
+    and never allocate, Data then points into the object itself. Past that the bytes move to the
+    arena when there is one, otherwise to the heap through Allocator (malloc without one). A full
+    arena spills to the heap too.
+
+    Copies get their own bytes with the storage of the copy, moves take over heap and arena bytes.
+    Heap bytes are freed by Free or the destructor, arena bytes stay until the arena is reset. */
 struct ls_stringbuf: public ls_mutable_string {
     char *D; // debug data pointer, because unwrapping hierarchy in Visual Studio watch window is annoying
     static ls_string_allocator *AllocatorTable;
 
     ls_stringbuf(ls_string_allocator A) {
         this->Allocator = A;
-        this->Data = 0;
-        this->Cap = 0;
-        this->Size = 0;
+        this->Arena = 0;
+        this->InitInline();
     }
 
     ls_stringbuf(ls_string_allocator_ A) {
         this->Allocator = this->AllocatorTable[A];
-        this->Data = 0;
-        this->Cap = 0;
-        this->Size = 0;
+        this->Arena = 0;
+        this->InitInline();
+    }
+
+    ls_stringbuf(ls_string_arena *Arena) {
+        this->Allocator = {};
+        this->Arena = Arena;
+        this->InitInline();
     }
 
     ls_stringbuf() {
         this->Allocator = {};
-        this->Data = 0;
-        this->Cap = 0;
-        this->Size = 0;
+        this->Arena = 0;
+        this->InitInline();
     }
 
     ls_stringbuf(ls_string String) {
-        this->Data = 0;
-        this->Cap = 0;
-        this->Size = 0;
-        this->FitSize(String.Size + 1);
-        ls_string_Memcpy(this->Data, String.Data, String.Size);
-        this->Size = String.Size;
-        this->D = this->Data;
-        this->Data[this->Size] = 0;
+        this->Allocator = {};
+        this->Arena = 0;
+        this->InitInline();
+        this->Set(String.Data, String.Size);
     }
 
     ls_stringbuf(char *String) {
-        u32 Size = ls_string_Strlen(String);
-        this->Data = 0;
-        this->Cap = 0;
-        this->Size = 0;
-        this->FitSize(Size + 1);
-        ls_string_Memcpy(this->Data,String, Size);
-        this->Size = Size;
-        this->D = this->Data;
-        this->Data[this->Size] = 0;
+        this->Allocator = {};
+        this->Arena = 0;
+        this->InitInline();
+        this->Set(String, ls_string_Strlen(String));
     }
 
-    ls_stringbuf & operator=(const ls_stringbuf &String) {
+    ls_stringbuf(const ls_stringbuf &String) {
         this->Allocator = String.Allocator;
-        this->Data = String.Data;
-        this->D = String.Data;
-        this->Cap = String.Cap;
-        this->Size = String.Size;
+        this->Arena = String.Arena;
+        this->InitInline();
+        this->Set(String.Data, String.Size);
+    }
 
-        u8 *Vptr = *(u8 **)&String;
-        *(u8 **)this = Vptr;
+    ls_stringbuf(ls_stringbuf &&String) {
+        this->Allocator = String.Allocator;
+        this->Arena = String.Arena;
+        this->InitInline();
+        this->Take(&String);
+    }
+
+    ~ls_stringbuf() {
+        this->Free();
+    }
+
+    ls_stringbuf & operator=(const ls_stringbuf &String) {
+        if (this != &String) {
+            this->Size = 0;
+            this->Set(String.Data, String.Size);
+        }
+        return *this;
+    }
 
+    ls_stringbuf & operator=(ls_stringbuf &&String) {
+        if (this != &String) {
+            // note: inline bytes are copied, so this keeps its storage, otherwise it owns String's now
+            if (String.Storage != StringStorage_Inline) {
+                this->Free();
+                this->Allocator = String.Allocator;
+                this->Arena = String.Arena;
+            }
+            this->Size = 0;
+            this->Take(&String);
+        }
         return *this;
     }
 
     void operator=(char *String) {
+        this->Size = 0;
         if (String) {
-            u32 Size = ls_string_Strlen(String);
-            this->FitSize(Size + 1);
-            ls_string_Memcpy(this->Data, String, Size);
-            this->Size = Size;
-            this->Data[this->Size] = 0;
+            this->Set(String, ls_string_Strlen(String));
         } else {
-            this->Data = 0;
-            this->Size = 0;
+            this->Data[0] = 0;
         }
-        this->D = this->Data;
     }
 
     void operator=(ls_string String) {
-        this->FitSize(String.Size + 1);
-        ls_string_Memcpy(this->Data, String.Data, String.Size);
-        this->Size = String.Size;
-        this->Data[this->Size] = 0;
-        this->D = this->Data;
+        this->Size = 0;
+        this->Set(String.Data, String.Size);
     }
 
     void FitSize(u32 Size);
+    void Free();
+
     ls_string_allocator Allocator;
+    ls_string_arena *Arena;
+    ls_stringbuf_storage_ Storage;
+    char Inline[LS_STRING_INLINE_SIZE];
+
+    void InitInline();
+    void Set(char *String, u32 Size);
+    void Take(ls_stringbuf *String);
 };
 
 enum token_ {
@@ -316,6 +389,38 @@ struct token {
     }
 };
 
+/*  Fields of a string separated by any of up to LS_STRING_MAX_DELIMITERS bytes, returned one at a
+    time as views into the string, nothing is allocated. The delimiters are found 16 bytes at a
+    time and the positions of one block are kept in Mask, so short fields don't rescan.
+
+    With SkipEmpty a run of delimiters is one separator and leading and trailing ones are ignored,
+    which suits whitespace and comma lists ("0 0, 24 24"). Without it every delimiter ends a field,
+    so "a,,b" gives an empty field in between. Either way an empty string has no fields. */
+struct ls_split_iterator {
+    char *At; // start of the next field
+    char *End;
+    char *Block; // the 16 bytes Mask covers, 0 before the first search
+    u32 Mask; // delimiters in Block at or after the last search
+    bool SkipEmpty;
+    u32 DelimiterCount;
+    char Delimiters[LS_STRING_MAX_DELIMITERS];
+
+    ls_split_iterator(ls_string String, char *Delimiters, bool SkipEmpty = true);
+
+    bool Next(ls_string *Field);
+    bool IsDelimiter(char C);
+    char *FindDelimiter(char *From);
+};
+
+// note: lines split on '\n', a '\r' before it is left out of the line
+struct ls_line_iterator {
+    ls_split_iterator Split;
+
+    ls_line_iterator(ls_string String) : Split(String, (char *)"\n", false) {}
+
+    bool Next(ls_string *Line);
+};
+
 struct ls_parser: ls_string {
     char *At;
 
@@ -352,10 +457,13 @@ struct ls_parser: ls_string {
     static u32 HexStringToU32(char *String);
     static b32 IsControlSymbol(unsigned char C);
     static r32 TokenToReal32(token Token);
+    static r64 TokenToReal64(token Token);
     static s32 TokenToInt32(token Token);
 
 
-    char **Split(char *Delimiters, u32 *LineCount);
+    // note: iterators over the remaining bytes, the parser itself doesn't move
+    ls_split_iterator Split(char *Delimiters, bool SkipEmpty = true);
+    ls_line_iterator Lines();
 
     b32 EqualTo(char *String, u32 Len);
     b32 EqualTo(char *String);
@@ -379,10 +487,11 @@ struct ls_parser: ls_string {
     bool MaybeEatChar(char C);
     bool MaybeEatIdentifier(char *String);
 
-    u32 FFToString(char *String, u32 N);
-    u32 FFToString(char *String);
-    u32 FFToStringEnd(char *String, u32 N);
-    u32 FFToStringEnd(char *String);
+    // note: true when found, At is then at the match (after it for End), otherwise at the end of data
+    bool FFToString(char *String, u32 N);
+    bool FFToString(char *String);
+    bool FFToStringEnd(char *String, u32 N);
+    bool FFToStringEnd(char *String);
 
     bool FFToChar(char C);
     bool FFToAfterChar(char C);
@@ -662,6 +771,62 @@ FitSize(u32 Size)
 
 GROWABLE MUTABLE STRING BUFFER */
 
+void ls_stringbuf::
+InitInline()
+{
+    this->Data = this->Inline;
+    this->D = this->Data;
+    this->Cap = LS_STRING_INLINE_SIZE;
+    this->Size = 0;
+    this->Storage = StringStorage_Inline;
+    this->Inline[0] = 0;
+}
+
+// note: appends, the callers that replace the contents set Size to 0 first
+void ls_stringbuf::
+Set(char *String, u32 Size)
+{
+    this->FitSize(Size + 1);
+    if (Size) {
+        ls_string_Memcpy(this->Data + this->Size, String, Size);
+    }
+    this->Size += Size;
+    this->Data[this->Size] = 0;
+}
+
+// note: String is left empty and inline, its heap or arena bytes become ours
+void ls_stringbuf::
+Take(ls_stringbuf *String)
+{
+    if (String->Storage == StringStorage_Inline) {
+        this->Set(String->Data, String->Size);
+    } else {
+        this->Data = String->Data;
+        this->D = this->Data;
+        this->Cap = String->Cap;
+        this->Size = String->Size;
+        this->Storage = String->Storage;
+    }
+
+    String->InitInline();
+}
+
+void ls_stringbuf::
+Free()
+{
+    if (this->Storage == StringStorage_Heap) {
+        if (this->Allocator.Alloc) {
+            if (this->Allocator.Free) {
+                this->Allocator.Free(this->Allocator.Data, this);
+            }
+        } else {
+            free(this->Data);
+        }
+    }
+
+    this->InitInline();
+}
+
 void ls_stringbuf::
 FitSize(u32 Size)
 {
@@ -669,7 +834,38 @@ FitSize(u32 Size)
               vsnprintf-style stuff, that has no option of not writing the 0. */
     Size += 1;
 
-    int NewCap = this->Cap;
+    if (this->Size + Size <= this->Cap) {
+        return;
+    }
+
+    u32 NewCap = ls_string_Max(this->Size * 2, this->Size + Size);
+
+    if (this->Arena && this->Storage != StringStorage_Heap) {
+        if (this->Storage == StringStorage_Arena) {
+            if (this->Arena->Extend(this->Data, this->Cap, NewCap)) {
+                this->Cap = NewCap;
+                return;
+            }
+            if (this->Arena->Extend(this->Data, this->Cap, this->Size + Size)) {
+                this->Cap = this->Size + Size;
+                return;
+            }
+        }
+
+        char *Memory = this->Arena->Push(NewCap);
+        if (Memory) {
+            if (this->Size) {
+                ls_string_Memcpy(Memory, this->Data, this->Size);
+            }
+            this->Data = Memory;
+            this->D = this->Data;
+            this->Cap = NewCap;
+            this->Storage = StringStorage_Arena;
+            return;
+        }
+
+        // note: the arena is full, the string continues on the heap
+    }
 
 #ifdef LS_STRING_USE_DEFAULT_ALLOCATOR
     if (!this->Allocator.Alloc || !this->Allocator.Realloc) {
@@ -679,27 +875,269 @@ FitSize(u32 Size)
     }
 #endif
 
-    if (this->Cap == 0) {
-        NewCap = ls_string_Max(LS_STRING_DEFAULT_SIZE, Size);
+    if (this->Storage == StringStorage_Heap) {
+        if (this->Allocator.Realloc) {
+            this->Data = (char *)this->Allocator.Realloc(this->Allocator.Data, this, NewCap);
+        } else {
+            this->Data = (char *)realloc(this->Data, NewCap);
+        }
+    } else {
+        // note: inline or arena bytes are copied over, the arena keeps its copy until it is reset
+        NewCap = ls_string_Max(LS_STRING_DEFAULT_SIZE, NewCap);
 
+        char *Memory;
         if (this->Allocator.Alloc) {
-            this->Data = (char *)this->Allocator.Alloc(this->Allocator.Data, NewCap);
+            Memory = (char *)this->Allocator.Alloc(this->Allocator.Data, NewCap);
         } else {
-            this->Data = (char *)malloc(NewCap);
+            Memory = (char *)malloc(NewCap);
         }
 
-        this->Cap = NewCap;
-    } else if (this->Cap < this->Size + Size) {
-        NewCap = ls_string_Max(this->Size * 2, this->Size + Size);
+        if (this->Size) {
+            ls_string_Memcpy(Memory, this->Data, this->Size);
+        }
+        this->Data = Memory;
+        this->Storage = StringStorage_Heap;
+    }
 
-        if (this->Allocator.Realloc) {
-            this->Data = (char *)this->Allocator.Realloc(this->Allocator.Data, this, NewCap);
-        } else {
-            this->Data = (char *)realloc(this->Data, NewCap);
+    this->D = this->Data;
+    this->Cap = NewCap;
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+STRING ARENA */
+
+// note: 0 when the arena can't fit Size more bytes
+char * ls_string_arena::
+Push(u32 Size)
+{
+    if (this->Cap - this->Size < Size) {
+        return 0;
+    }
+
+    char *Result = this->Data + this->Size;
+    this->Size += Size;
+
+    return Result;
+}
+
+// note: grows String to NewCap in place, only possible while it is the last block pushed
+bool ls_string_arena::
+Extend(char *String, u32 Cap, u32 NewCap)
+{
+    if (String + Cap != this->Data + this->Size || (String - this->Data) + (u64)NewCap > this->Cap) {
+        return false;
+    }
+
+    this->Size = (u32)(String - this->Data) + NewCap;
+
+    return true;
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+SUBSTRING SEARCH */
+
+// note: whether the needle matches at Candidate, its first and last bytes are known to match
+inline bool
+ls_string_MatchInner(char *Candidate, char *Needle, u32 N)
+{
+    return N <= 2 || memcmp(Candidate + 1, Needle + 1, N - 2) == 0;
+}
+
+/*  First occurrence of Needle in the Size bytes at At, 0 without one. Blocks of positions are
+    filtered on the needle's first and last byte together, which rarely both match by chance, and
+    only the survivors are compared in full. Single bytes go to memchr. */
+char *
+ls_string_Find(char *At, u32 Size, char *Needle, u32 N)
+{
+    if (N == 0) {
+        return At;
+    }
+    if (N > Size) {
+        return 0;
+    }
+    if (N == 1) {
+        return (char *)memchr(At, Needle[0], Size);
+    }
+
+    u32 i = 0;
+
+#if defined(LS_STRING_AVX2)
+    __m256i First8 = _mm256_set1_epi8(Needle[0]);
+    __m256i Last8 = _mm256_set1_epi8(Needle[N - 1]);
+
+    for (; i + N - 1 + 32 <= Size; i += 32) {
+        __m256i A = _mm256_loadu_si256((__m256i *)(At + i));
+        __m256i B = _mm256_loadu_si256((__m256i *)(At + i + N - 1));
+        u32 Mask = (u32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(A, First8),
+                                                               _mm256_cmpeq_epi8(B, Last8)));
+
+        while (Mask) {
+            char *Candidate = At + i + ls_string_Ctz(Mask);
+            if (ls_string_MatchInner(Candidate, Needle, N)) {
+                return Candidate;
+            }
+            Mask &= Mask - 1;
+        }
+    }
+#endif
+
+#if defined(LS_STRING_SSE2)
+    __m128i First = _mm_set1_epi8(Needle[0]);
+    __m128i Last = _mm_set1_epi8(Needle[N - 1]);
+
+    for (; i + N - 1 + 16 <= Size; i += 16) {
+        __m128i A = _mm_loadu_si128((__m128i *)(At + i));
+        __m128i B = _mm_loadu_si128((__m128i *)(At + i + N - 1));
+        u32 Mask = (u32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(A, First), _mm_cmpeq_epi8(B, Last)));
+
+        while (Mask) {
+            char *Candidate = At + i + ls_string_Ctz(Mask);
+            if (ls_string_MatchInner(Candidate, Needle, N)) {
+                return Candidate;
+            }
+            Mask &= Mask - 1;
         }
+    }
+#endif
 
-        this->Cap = NewCap;
+    // note: the tail, or everything without SSE2. memchr finds the candidates for the first byte
+    while (i + N <= Size) {
+        char *Candidate = (char *)memchr(At + i, Needle[0], Size - N + 1 - i);
+        if (!Candidate) {
+            break;
+        }
+        if (Candidate[N - 1] == Needle[N - 1] && ls_string_MatchInner(Candidate, Needle, N)) {
+            return Candidate;
+        }
+        i = (u32)(Candidate - At) + 1;
     }
+
+    return 0;
+}
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+SPLIT ITERATORS */
+
+// note: bit i is set when At[i] is one of the delimiters, for the first min(Size, 16) bytes
+inline u32
+ls_string_DelimiterMask(char *At, u32 Size, char *Delimiters, u32 Count)
+{
+#ifdef LS_STRING_SSE2
+    if (Size >= 16) {
+        __m128i Bytes = _mm_loadu_si128((__m128i *)At);
+        __m128i Match = _mm_setzero_si128();
+        for (u32 i=0; i<Count; ++i) {
+            Match = _mm_or_si128(Match, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8(Delimiters[i])));
+        }
+        return (u32)_mm_movemask_epi8(Match);
+    }
+#endif
+
+    u32 Mask = 0;
+    Size = (Size < 16) ? Size : 16;
+
+    for (u32 j=0; j<Size; ++j) {
+        for (u32 i=0; i<Count; ++i) {
+            if (At[j] == Delimiters[i]) {
+                Mask |= 1u << j;
+                break;
+            }
+        }
+    }
+
+    return Mask;
+}
+
+ls_split_iterator::
+ls_split_iterator(ls_string String, char *Delimiters, bool SkipEmpty)
+{
+    this->At = String.Data;
+    this->End = String.Data + String.Size;
+    this->Block = 0;
+    this->Mask = 0;
+    this->SkipEmpty = SkipEmpty;
+    this->DelimiterCount = 0;
+
+    while (Delimiters[this->DelimiterCount]) {
+        LS_STRING_ASSERT(this->DelimiterCount < LS_STRING_MAX_DELIMITERS);
+        this->Delimiters[this->DelimiterCount] = Delimiters[this->DelimiterCount];
+        ++this->DelimiterCount;
+    }
+}
+
+bool ls_split_iterator::
+IsDelimiter(char C)
+{
+    for (u32 i=0; i<this->DelimiterCount; ++i) {
+        if (C == this->Delimiters[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// note: the first delimiter at or after From, End without one. From never goes backwards
+char * ls_split_iterator::
+FindDelimiter(char *From)
+{
+    while (From < this->End) {
+        if (!this->Block || From >= this->Block + 16) {
+            this->Block = From;
+            this->Mask = ls_string_DelimiterMask(From, (u32)(this->End - From), this->Delimiters,
+                                                 this->DelimiterCount);
+        }
+
+        u32 Offset = (u32)(From - this->Block);
+        this->Mask &= ~0u << Offset;
+
+        if (this->Mask) {
+            return this->Block + ls_string_Ctz(this->Mask);
+        }
+
+        From = this->Block + 16;
+    }
+
+    return this->End;
+}
+
+bool ls_split_iterator::
+Next(ls_string *Field)
+{
+    if (this->SkipEmpty) {
+        while (this->At < this->End && this->IsDelimiter(*this->At)) {
+            ++this->At;
+        }
+    }
+
+    if (this->At >= this->End) {
+        return false;
+    }
+
+    char *Stop = this->FindDelimiter(this->At);
+    *Field = ls_string(this->At, (u32)(Stop - this->At));
+    this->At = (Stop < this->End) ? Stop + 1 : this->End;
+
+    return true;
+}
+
+bool ls_line_iterator::
+Next(ls_string *Line)
+{
+    if (!this->Split.Next(Line)) {
+        return false;
+    }
+
+    if (Line->Size && Line->Data[Line->Size - 1] == '\r') {
+        --Line->Size;
+    }
+
+    return true;
 }
 
 /*
@@ -831,51 +1269,112 @@ ls_parser::MaybeEatChar(char C)
     return Result;
 }
 
-r32
-ls_parser::TokenToReal32(token Token)
-{
-    float Result = 0;
-
-    int Sign = 1.0f;
+static const r64 ls_string_Powers10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-    char *At = Token.Text.Data;
+// note: digits of a number token as Mantissa * 10^Exponent, the first 19 significant ones. True if negative
+inline b32
+ls_string_Decimal(ls_string Text, u64 *Mantissa, s32 *Exponent)
+{
+    char *At = Text.Data;
+    char *End = Text.Data + Text.Size;
 
-    if (*At == '-') {
-        Sign = -1.0f;
+    b32 Negative = false;
+    if (At < End && *At == '-') {
+        Negative = true;
         ++At;
     }
 
-    u32 Numbers[10];
-    u32 NumberCounter = 0;
-    int IntegerCount = 0;
-
+    u64 M = 0;
+    u32 Digits = 0;
+    s32 E = 0;
     b32 FoundADot = false;
 
-    while (At < (Token.Text.Data + Token.Text.Size)) {
+    for (; At < End; ++At) {
         if (ls_parser::Digit(*At)) {
-            Numbers[NumberCounter++] = ls_parser::CharToDigit(*At);
+            if (Digits < 19) {
+                M = M * 10 + ls_parser::CharToDigit(*At);
+                Digits += (M != 0);
+                E -= FoundADot;
+            } else if (!FoundADot) {
+                ++E;
+            }
         } else if (*At == '.' && !FoundADot) {
             FoundADot = true;
-            IntegerCount = NumberCounter;
-        } else {
-            // Assert(!"Numbers should be prepared");
         }
-        ++At;
     }
 
-    float Multiplier = 0.1f;
-    if (IntegerCount) {
-        Multiplier = (float)ls_parser::Power(10, IntegerCount - 1);
+    *Mantissa = M;
+    *Exponent = E;
+    return Negative;
+}
+
+// note: Mantissa * 10^Exponent in doubles, correctly rounded for mantissas below 2^53 and up to 22 decimals
+inline r64
+ls_string_Scale10(u64 Mantissa, s32 Exponent)
+{
+    r64 Result = (r64)Mantissa;
+
+    while (Exponent < -22) {
+        Result /= 1e22;
+        Exponent += 22;
+    }
+    while (Exponent > 22) {
+        Result *= 1e22;
+        Exponent -= 22;
     }
 
-    for (u32 i=0; i < NumberCounter; ++i) {
-        Result += Multiplier * Numbers[i];
-        Multiplier /= 10.0f;
+    return (Exponent < 0) ? Result / ls_string_Powers10[-Exponent] : Result * ls_string_Powers10[Exponent];
+}
+
+// note: Mantissa * 10^Exponent as a float, correctly rounded in the range ls_string_Scale10 is
+inline r32
+ls_string_DecimalToReal32(u64 Mantissa, s32 Exponent)
+{
+    r64 Result = ls_string_Scale10(Mantissa, Exponent);
+
+    // note: a double exactly halfway between two floats rounds to the even one, the decimal itself
+    // is a little above or below it and fma gives the sign of the difference
+    u64 Bits;
+    memcpy(&Bits, &Result, sizeof(Bits));
+    if ((Bits & 0x1fffffff) == 0x10000000 && Mantissa < (1ull << 53) && Exponent >= -22 && Exponent <= 22) {
+        r64 M = (r64)Mantissa;
+        r64 P = ls_string_Powers10[(Exponent < 0) ? -Exponent : Exponent];
+        r64 Error = (Exponent < 0) ? fma(-Result, P, M) : fma(M, P, -Result);
+        if (Error != 0.0) {
+            Result = nextafter(Result, (Error > 0.0) ? HUGE_VAL : 0.0);
+        }
     }
 
-    Result *= Sign;
+    return (r32)Result;
+}
 
-    return Result;
+// note: correctly rounded up to 15 significant digits and 22 decimals, the numbers a writer produces
+r32
+ls_parser::TokenToReal32(token Token)
+{
+    u64 Mantissa;
+    s32 Exponent;
+    b32 Negative = ls_string_Decimal(Token.Text, &Mantissa, &Exponent);
+
+    r32 Result = ls_string_DecimalToReal32(Mantissa, Exponent);
+
+    return Negative ? -Result : Result;
+}
+
+// note: correctly rounded up to 15 significant digits and 22 decimals, longer numbers keep 19 digits
+r64
+ls_parser::TokenToReal64(token Token)
+{
+    u64 Mantissa;
+    s32 Exponent;
+    b32 Negative = ls_string_Decimal(Token.Text, &Mantissa, &Exponent);
+
+    r64 Result = ls_string_Scale10(Mantissa, Exponent);
+
+    return Negative ? -Result : Result;
 }
 
 s32
@@ -897,7 +1396,10 @@ ls_parser::TokenToInt32(token Token)
 
    while (At < (Token.Text.Data + Token.Text.Size)) {
         if (ls_parser::Digit(*At)) {
-            Numbers[NumberCounter++] = ls_parser::CharToDigit(*At);
+            // note: more digits don't fit an s32 anyway
+            if (NumberCounter < 10) {
+                Numbers[NumberCounter++] = ls_parser::CharToDigit(*At);
+            }
         } else {
             // Assert(!"Numbers should be prepared");
         }
@@ -960,14 +1462,13 @@ ls_parser::GetToken()
             Token.Type = Token_String;
             Token.Text.Data = C+1;
 
-            do {
-                ++C;
-                --RemainingSize;
-            } while (RemainingSize && *C && *C != '"');
+            // note: attribute values are most of a document, path data especially
+            char *Quote = (RemainingSize > 1) ? (char *)memchr(C + 1, '"', RemainingSize - 1) : 0;
+            C = Quote ? Quote : C + RemainingSize;
 
             Token.Text.Size = C - Token.Text.Data;
 
-            if (*C == '"') {
+            if (Quote) {
                 ++C;
             }
         } break;
@@ -1138,65 +1639,54 @@ IsControlSymbol(unsigned char C)
     return(Result);
 }
 
-u32 ls_parser::
+bool ls_parser::
 FFToString(char *String, u32 N)
 {
-    u32 Counter = 0;
+    char *Match = ls_string_Find(this->At, this->RemainingBytes(), String, N);
 
-    if (this->RemainingBytes() < N) {
-        // note: ff to end of data
+    if (!Match) {
         this->At = this->Data + this->Size;
-    } else {
-        while (this->RemainingBytes() >= N) {
-            if (this->EqualTo(String, N)) {
-                return true;
-            }
-
-            ++this->At;
-            ++Counter;
-        }
+        return false;
     }
 
-    return Counter;
+    this->At = Match;
+    return true;
 }
 
-u32 ls_parser::
+bool ls_parser::
 FFToString(char *String)
 {
     return FFToString(String, ls_string_Strlen(String));
 }
 
-u32 ls_parser::
+bool ls_parser::
 FFToStringEnd(char *String, u32 N)
 {
-    u32 Counter = 0;
-
-    if (this->RemainingBytes() < N) {
-        // note: ff to end of data
-        this->At = this->Data + this->Size;
-    } else {
-        while (this->RemainingBytes()) {
-            LS_STRING_ASSERT(!"DO IT! JUST. DO. IT!!!!!!");
-            // if (this->MatchSequence(String, N) ) {
-            //     this->At += N;
-            //     Counter += N;
-            //     break;
-            // }
-
-            ++this->At;
-            ++Counter;
-        }
+    bool Found = this->FFToString(String, N);
+    if (Found) {
+        this->At += N;
     }
-
-    return Counter;
+    return Found;
 }
 
-u32 ls_parser::
+bool ls_parser::
 FFToStringEnd(char *String)
 {
     return FFToStringEnd(String, ls_string_Strlen(String));
 }
 
+ls_split_iterator ls_parser::
+Split(char *Delimiters, bool SkipEmpty)
+{
+    return ls_split_iterator(ls_string(this->At, this->RemainingBytes()), Delimiters, SkipEmpty);
+}
+
+ls_line_iterator ls_parser::
+Lines()
+{
+    return ls_line_iterator(ls_string(this->At, this->RemainingBytes()));
+}
+
 bool ls_parser::
 GetLine(ls_parser *Result)
 {
@@ -1328,27 +1818,25 @@ SkipUtf8CharsN(u32 N)
 bool
 ls_parser::FFToChar(char C)
 {
-    while (this->RemainingBytes()) {
-        if (*this->At == C) {
-            return true;
-        }
-        ++this->At;
-    }
-    return false;
+    char *Match = (char *)memchr(this->At, C, this->RemainingBytes());
+    this->At = Match ? Match : this->Data + this->Size;
+    return Match != 0;
 }
 
+// note: false as well when C is the last byte, there is nothing after it
 bool
 ls_parser::FFToAfterChar(char C)
 {
-    while (this->RemainingBytes()) {
-        if (*this->At == C && this->RemainingBytes() > 1) {
-            ++this->At;
-           return true;
-        }
-        ++this->At;
+    char *End = this->Data + this->Size;
+    char *Match = (char *)memchr(this->At, C, this->RemainingBytes());
+
+    if (!Match || Match + 1 == End) {
+        this->At = End;
+        return false;
     }
 
-    return false;
+    this->At = Match + 1;
+    return true;
 }
 
 // inline bool
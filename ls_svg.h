@@ -1,25 +1,92 @@
 #ifndef INCLUDE_GUARD_LS_SVG
 #define INCLUDE_GUARD_LS_SVG
 
+// note: define as printf to trace the parser
+#ifndef LS_SVG_LOG
+#define LS_SVG_LOG(...)
+#endif
+
+// note: timing zones, include ls_svg_trace.h first with LS_SVG_TRACE defined to record them
+#ifndef LS_SVG_ZONE
+#define LS_SVG_ZONE(Name)
+#endif
+
+#include <atomic>
+#include <thread>
+#include <new>
+
+/*  Where arrays get their memory, like ls_string_allocator. The sizes are in bytes, Realloc and
+    Free are told the size the block was allocated with, so an allocator can account without
+    headers. A null allocator is malloc, realloc and free. */
+
+typedef void *svg_alloc(void *Data, size_t Size);
+typedef void *svg_realloc(void *Data, void *Memory, size_t OldSize, size_t Size);
+typedef void svg_free(void *Data, void *Memory, size_t Size);
+
+struct svg_allocator {
+    void *Data;
+    svg_alloc *Alloc;
+    svg_realloc *Realloc;
+    svg_free *Free;
+};
+
+inline void *
+SvgAllocate(svg_allocator *Allocator, size_t Size)
+{
+    return Allocator ? Allocator->Alloc(Allocator->Data, Size) : malloc(Size);
+}
+
+inline void *
+SvgReallocate(svg_allocator *Allocator, void *Memory, size_t OldSize, size_t Size)
+{
+    return Allocator ? Allocator->Realloc(Allocator->Data, Memory, OldSize, Size) : realloc(Memory, Size);
+}
+
+inline void
+SvgDeallocate(svg_allocator *Allocator, void *Memory, size_t Size)
+{
+    if (Allocator) {
+        Allocator->Free(Allocator->Data, Memory, Size);
+    } else {
+        free(Memory);
+    }
+}
+
 template <typename type>
 struct svg_array {
     type *Data;
     u32 Count;
     u32 Cap;
+    svg_allocator *Allocator; // 0 for malloc, set before the first push
 
     void FitN(u32 N) {
         if (!this->Data) {
+            LS_SVG_ZONE("svg_array grow");
             this->Cap = 10;
-            this->Data = (type *)malloc(this->Cap * sizeof(type));
+            this->Data = (type *)SvgAllocate(this->Allocator, this->Cap * sizeof(type));
         }
 
         if (this->Count + N > this->Cap) {
+            LS_SVG_ZONE("svg_array grow");
             u32 NewCap = this->Cap * 2;
-            this->Data = (type *)realloc(this->Data, NewCap);
+            while (this->Count + N > NewCap) {
+                NewCap *= 2;
+            }
+            this->Data = (type *)SvgReallocate(this->Allocator, this->Data, this->Cap * sizeof(type), NewCap * sizeof(type));
             this->Cap = NewCap;
         }
     }
 
+    // note: gives the memory back to the allocator, the array stays usable with the same allocator
+    void Free() {
+        if (this->Data) {
+            SvgDeallocate(this->Allocator, this->Data, this->Cap * sizeof(type));
+        }
+        this->Data = 0;
+        this->Count = 0;
+        this->Cap = 0;
+    }
+
     type *AllocN(u32 N) {
         this->FitN(N);
 
@@ -49,10 +116,108 @@ enum svg_element_ {
     SvgElement_Count,
 };
 
-struct svg_v2 {
-    r32 x,y;
+/*  Scalar policies. Path storage and the geometry helpers are templated on the coordinate type,
+    svg_scalar<T> says how to get values of T from the tokenizer and in and out of its real type,
+    the floating point type that transcendental math (arcs, lengths) is evaluated in. Everything
+    past the parser (raster, tiles, strokes...) works on the r32 instantiation. */
+
+// note: signed fixed point with FracBits fractional bits, 24.8 and 16.16 are the useful ones
+template <u32 FracBits>
+struct svg_fixed {
+    s32 Raw;
+};
+
+typedef svg_fixed<8> svg_fixed_24_8;
+typedef svg_fixed<16> svg_fixed_16_16;
+
+template <u32 F> inline svg_fixed<F> operator+(svg_fixed<F> A, svg_fixed<F> B) { return {A.Raw + B.Raw}; }
+template <u32 F> inline svg_fixed<F> operator-(svg_fixed<F> A, svg_fixed<F> B) { return {A.Raw - B.Raw}; }
+template <u32 F> inline svg_fixed<F> operator-(svg_fixed<F> A) { return {-A.Raw}; }
+template <u32 F> inline svg_fixed<F> operator*(svg_fixed<F> A, svg_fixed<F> B) { return {(s32)(((s64)A.Raw * B.Raw) >> F)}; }
+template <u32 F> inline svg_fixed<F> operator/(svg_fixed<F> A, svg_fixed<F> B) { return {(s32)(((s64)A.Raw << F) / B.Raw)}; }
+template <u32 F> inline svg_fixed<F> &operator+=(svg_fixed<F> &A, svg_fixed<F> B) { A.Raw += B.Raw; return A; }
+template <u32 F> inline svg_fixed<F> &operator-=(svg_fixed<F> &A, svg_fixed<F> B) { A.Raw -= B.Raw; return A; }
+template <u32 F> inline bool operator==(svg_fixed<F> A, svg_fixed<F> B) { return A.Raw == B.Raw; }
+template <u32 F> inline bool operator!=(svg_fixed<F> A, svg_fixed<F> B) { return A.Raw != B.Raw; }
+template <u32 F> inline bool operator<(svg_fixed<F> A, svg_fixed<F> B) { return A.Raw < B.Raw; }
+template <u32 F> inline bool operator>(svg_fixed<F> A, svg_fixed<F> B) { return A.Raw > B.Raw; }
+template <u32 F> inline bool operator<=(svg_fixed<F> A, svg_fixed<F> B) { return A.Raw <= B.Raw; }
+template <u32 F> inline bool operator>=(svg_fixed<F> A, svg_fixed<F> B) { return A.Raw >= B.Raw; }
+
+template <typename type>
+struct svg_scalar;
+
+template <>
+struct svg_scalar<r32> {
+    typedef r32 scalar;
+    typedef r32 real;
+
+    static r32 FromReal(r32 Value) { return Value; }
+    static r32 ToReal(r32 Value) { return Value; }
+    static r32 Sqrt(r32 Value) { return sqrtf(Value); }
+    static r32 Parse(token Token) { return Token.GetReal(); }
+};
+
+template <>
+struct svg_scalar<r64> {
+    typedef r64 scalar;
+    typedef r64 real;
+
+    static r64 FromReal(r64 Value) { return Value; }
+    static r64 ToReal(r64 Value) { return Value; }
+    static r64 Sqrt(r64 Value) { return sqrt(Value); }
+    static r64 Parse(token Token) {
+        assert(Token.Type == Token_Real || Token.Type == Token_Integer);
+        return Token.Type == Token_Integer ? (r64)Token.Integer : ls_parser::TokenToReal64(Token);
+    }
+};
+
+// note: FromReal rounds to nearest, values outside the range saturate and NaN is 0
+template <u32 F>
+struct svg_scalar<svg_fixed<F>> {
+    typedef svg_fixed<F> scalar;
+    typedef r64 real;
+
+    static svg_fixed<F> FromReal(r64 Value) {
+        // note: clamped in double first, casting a value the integer can't hold is undefined
+        r64 Raw = floor(Value * (r64)(1 << F) + 0.5);
+        Raw = (Raw < -2147483648.0) ? -2147483648.0 : (Raw > 2147483647.0) ? 2147483647.0 : Raw;
+        return {(Raw == Raw) ? (s32)Raw : 0};
+    }
+    static r64 ToReal(svg_fixed<F> Value) { return Value.Raw * (1.0 / (r64)(1 << F)); }
+    static svg_fixed<F> Sqrt(svg_fixed<F> Value) { return FromReal(sqrt(ToReal(Value))); }
+    static svg_fixed<F> Parse(token Token) { return FromReal(svg_scalar<r64>::Parse(Token)); }
+};
+
+// note: constants in templated code, SvgScalar<T>(0.5)
+template <typename T>
+inline T
+SvgScalar(r64 Value)
+{
+    return svg_scalar<T>::FromReal((typename svg_scalar<T>::real)Value);
+}
+
+template <typename to, typename from>
+inline to
+SvgScalarCast(from Value)
+{
+    return svg_scalar<to>::FromReal((typename svg_scalar<to>::real)svg_scalar<from>::ToReal(Value));
+}
+
+template <typename T>
+inline r64
+SvgReal64(T Value)
+{
+    return (r64)svg_scalar<T>::ToReal(Value);
+}
+
+template <typename T>
+struct svg_v2_t {
+    T x,y;
 };
 
+typedef svg_v2_t<r32> svg_v2;
+
 enum svg_segment_ {
     SvgSegment_Line,
     SvgSegment_QuadraticBezier,
@@ -60,24 +225,66 @@ enum svg_segment_ {
     SvgSegment_Elliptical,
 };
 
-struct svg_path_segement {
+enum svg_fill_rule_ {
+    SvgFillRule_NonZero,
+    SvgFillRule_EvenOdd,
+};
+
+enum svg_line_join_ {
+    SvgLineJoin_Miter,
+    SvgLineJoin_Round,
+    SvgLineJoin_Bevel,
+};
+
+enum svg_line_cap_ {
+    SvgLineCap_Butt,
+    SvgLineCap_Round,
+    SvgLineCap_Square,
+};
+
+struct svg_stroke_style {
+    r32 Width;
+    svg_line_join_ Join;
+    svg_line_cap_ Cap;
+    r32 MiterLimit;
+
+    // note: the dash pattern is svg::Dashes[DashFirst .. DashFirst + DashCount], none if DashCount is 0
+    u32 DashFirst;
+    u32 DashCount;
+    r32 DashOffset;
+};
+
+template <typename T>
+struct svg_bounds_t {
+    svg_v2_t<T> Min, Max;
+};
+
+typedef svg_bounds_t<r32> svg_bounds;
+
+// note: P1 is always the start point and P2 the end point, whatever the type.
+//       Quadratics only use C1.
+template <typename T>
+struct svg_path_segement_t {
     svg_segment_ Type;
 
+    svg_v2_t<T> P1, P2;
+
     union {
         struct {
-            svg_v2 P1, P2, C1, C2;
+            svg_v2_t<T> C1, C2;
         };
         struct {
-            r32 Rx;
-            r32 Ry;
-            r32 Angle;
+            T Rx;
+            T Ry;
+            T Angle;
             char UseLargeArc;
             char Clockwise;
-            svg_v2 EndP;
         };
     };
 };
 
+typedef svg_path_segement_t<r32> svg_path_segement;
+
 struct svg_circle {
     svg_v2 Center;
 
@@ -89,13 +296,32 @@ struct svg_rect {
     svg_v2 Dim;
 };
 
-struct svg_path {
-    svg_array<svg_path_segement> Segments;
+// note: a contour of a path, its segments run to the next subpath's First. Closed is set by 'Z'
+struct svg_subpath {
+    u32 First;
     b32 Closed;
 };
 
+template <typename T>
+struct svg_path_t {
+    svg_array<svg_path_segement_t<T>> Segments;
+    svg_array<svg_subpath> Subpaths;
+    svg_bounds_t<T> Bounds;
+};
+
+typedef svg_path_t<r32> svg_path;
+
 struct svg_element {
     svg_element_ Type;
+    svg_fill_rule_ FillRule;
+    u32 Fill; // 0xRRGGBBAA, 0 for none
+    u32 Stroke;
+    svg_stroke_style StrokeStyle;
+
+    // note: views into the parsed text, valid as long as it is
+    ls_string Id;
+    ls_string Source; // d of a path, lazily parsed documents decode it in SvgElementPath
+    ls_string Markup; // the start tag the element came from, '<' to '>'
 
     union {
         svg_path Path;
@@ -104,10 +330,603 @@ struct svg_element {
     };
 };
 
+enum svg_path_state_ {
+    SvgPathState_Undecoded,
+    SvgPathState_Decoding,
+    SvgPathState_Decoded,
+};
+
 struct svg {
     svg_array<svg_element> Elements;
+    svg_array<r32> Dashes; // stroke-dasharray values of all elements
+    svg_fill_rule_ FillRule;
+    u32 Fill;
+    u32 Stroke;
+    svg_stroke_style StrokeStyle;
+
+    b32 Lazy; // paths keep their Source until SvgElementPath decodes them
+    std::atomic<u32> *PathStates; // svg_path_state_ per element of a lazy document
+};
+
+// note: attributes of the tag that is currently being parsed, applied to its elements on '>'
+struct svg_tag {
+    ls_string Name;
+    ls_string Id;
+    ls_string Markup;
+    u32 FirstElement;
+    svg_fill_rule_ FillRule;
+    u32 Fill;
+    u32 Stroke;
+    svg_stroke_style StrokeStyle;
+};
+
+/*
+▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀▀
+
+GEOMETRY */
+
+#define SVG_PI 3.14159265358979323846f
+
+template <typename T> inline svg_v2_t<T> operator+(svg_v2_t<T> A, svg_v2_t<T> B) { return {A.x + B.x, A.y + B.y}; }
+template <typename T> inline svg_v2_t<T> operator-(svg_v2_t<T> A, svg_v2_t<T> B) { return {A.x - B.x, A.y - B.y}; }
+template <typename T> inline svg_v2_t<T> operator*(svg_v2_t<T> A, typename svg_scalar<T>::scalar S) { return {A.x * S, A.y * S}; }
+template <typename T> inline svg_v2_t<T> operator*(typename svg_scalar<T>::scalar S, svg_v2_t<T> A) { return {A.x * S, A.y * S}; }
+template <typename T> inline bool operator==(svg_v2_t<T> A, svg_v2_t<T> B) { return A.x == B.x && A.y == B.y; }
+template <typename T> inline bool operator!=(svg_v2_t<T> A, svg_v2_t<T> B) { return A.x != B.x || A.y != B.y; }
+
+inline r32 SvgMin(r32 A, r32 B) { return A < B ? A : B; }
+inline r32 SvgMax(r32 A, r32 B) { return A > B ? A : B; }
+template <typename T> inline T SvgDot(svg_v2_t<T> A, svg_v2_t<T> B) { return A.x * B.x + A.y * B.y; }
+template <typename T> inline T SvgCross(svg_v2_t<T> A, svg_v2_t<T> B) { return A.x * B.y - A.y * B.x; }
+template <typename T> inline T SvgLength(svg_v2_t<T> A) { return svg_scalar<T>::Sqrt(A.x * A.x + A.y * A.y); }
+template <typename T> inline svg_v2_t<T> SvgLerp(svg_v2_t<T> A, svg_v2_t<T> B, typename svg_scalar<T>::scalar t) { return A + (B - A) * t; }
+
+// note: the real types of the scalar policies, for the parts that need transcendental functions
+inline r32 SvgAbs(r32 A) { return fabsf(A); }
+inline r64 SvgAbs(r64 A) { return fabs(A); }
+inline r32 SvgSqrt(r32 A) { return sqrtf(A); }
+inline r64 SvgSqrt(r64 A) { return sqrt(A); }
+inline r32 SvgCeil(r32 A) { return ceilf(A); }
+inline r64 SvgCeil(r64 A) { return ceil(A); }
+inline r32 SvgSin(r32 A) { return sinf(A); }
+inline r64 SvgSin(r64 A) { return sin(A); }
+inline r32 SvgCos(r32 A) { return cosf(A); }
+inline r64 SvgCos(r64 A) { return cos(A); }
+inline r32 SvgTan(r32 A) { return tanf(A); }
+inline r64 SvgTan(r64 A) { return tan(A); }
+inline r32 SvgAtan2(r32 Y, r32 X) { return atan2f(Y, X); }
+inline r64 SvgAtan2(r64 Y, r64 X) { return atan2(Y, X); }
+
+template <typename T>
+inline svg_bounds_t<T>
+SvgBoundsOf(svg_v2_t<T> P)
+{
+    return {P, P};
+}
+
+template <typename T>
+inline void
+SvgBoundsAdd(svg_bounds_t<T> *Bounds, svg_v2_t<T> P)
+{
+    // note: same operand order as SvgMin / SvgMax
+    Bounds->Min.x = (Bounds->Min.x < P.x) ? Bounds->Min.x : P.x;
+    Bounds->Min.y = (Bounds->Min.y < P.y) ? Bounds->Min.y : P.y;
+    Bounds->Max.x = (Bounds->Max.x > P.x) ? Bounds->Max.x : P.x;
+    Bounds->Max.y = (Bounds->Max.y > P.y) ? Bounds->Max.y : P.y;
+}
+
+template <typename T>
+inline svg_bounds_t<T>
+SvgBoundsUnion(svg_bounds_t<T> A, svg_bounds_t<T> B)
+{
+    SvgBoundsAdd(&A, B.Min);
+    SvgBoundsAdd(&A, B.Max);
+    return A;
+}
+
+template <typename T>
+inline b32
+SvgBoundsContain(svg_bounds_t<T> Bounds, svg_v2_t<T> P)
+{
+    return (P.x >= Bounds.Min.x && P.x <= Bounds.Max.x &&
+            P.y >= Bounds.Min.y && P.y <= Bounds.Max.y);
+}
+
+template <typename T>
+inline svg_v2_t<T>
+SvgQuadraticAt(svg_v2_t<T> P0, svg_v2_t<T> C, svg_v2_t<T> P1, typename svg_scalar<T>::scalar t)
+{
+    T u = SvgScalar<T>(1.0) - t;
+    return P0 * (u * u) + C * (SvgScalar<T>(2.0) * u * t) + P1 * (t * t);
+}
+
+template <typename T>
+inline svg_v2_t<T>
+SvgCubicAt(svg_v2_t<T> P0, svg_v2_t<T> C0, svg_v2_t<T> C1, svg_v2_t<T> P1, typename svg_scalar<T>::scalar t)
+{
+    T u = SvgScalar<T>(1.0) - t;
+    T Three = SvgScalar<T>(3.0);
+    return P0 * (u * u * u) + C0 * (Three * u * u * t) + C1 * (Three * u * t * t) + P1 * (t * t * t);
+}
+
+template <typename T>
+inline svg_v2_t<T>
+SvgNormalize(svg_v2_t<T> A)
+{
+    T Length = SvgLength(A);
+    return (Length > SvgScalar<T>(0.0)) ? A * (SvgScalar<T>(1.0) / Length) : svg_v2_t<T>{};
+}
+
+template <typename T>
+inline svg_v2_t<T>
+SvgSegmentAt(svg_path_segement_t<T> *S, typename svg_scalar<T>::scalar t)
+{
+    switch (S->Type) {
+        case SvgSegment_QuadraticBezier: return SvgQuadraticAt(S->P1, S->C1, S->P2, t);
+        case SvgSegment_CubicBezier: return SvgCubicAt(S->P1, S->C1, S->C2, S->P2, t);
+        default: return SvgLerp(S->P1, S->P2, t);
+    }
+}
+
+// note: falls back to the next control point where a derivative vanishes, so end points get the
+//       direction the curve actually leaves in
+template <typename T>
+internal svg_v2_t<T>
+SvgSegmentTangent(svg_path_segement_t<T> *S, typename svg_scalar<T>::scalar t)
+{
+    svg_v2_t<T> Zero = {};
+    svg_v2_t<T> Result = S->P2 - S->P1;
+
+    if (S->Type == SvgSegment_QuadraticBezier) {
+        T u = SvgScalar<T>(1.0) - t;
+        Result = (S->C1 - S->P1) * u + (S->P2 - S->C1) * t;
+        if (Result == Zero) {
+            Result = S->P2 - S->P1;
+        }
+    } else if (S->Type == SvgSegment_CubicBezier) {
+        T u = SvgScalar<T>(1.0) - t;
+        Result = (S->C1 - S->P1) * (u * u) + (S->C2 - S->C1) * (SvgScalar<T>(2.0) * u * t) + (S->P2 - S->C2) * (t * t);
+        if (Result == Zero) {
+            Result = (t < SvgScalar<T>(0.5)) ? S->C2 - S->P1 : S->P2 - S->C1;
+        }
+        if (Result == Zero) {
+            Result = S->P2 - S->P1;
+        }
+    }
+
+    return SvgNormalize(Result);
+}
+
+// note: de Casteljau split of a line, quadratic or cubic at t, the outer end points are kept exactly
+template <typename T>
+internal void
+SvgSplitSegment(svg_path_segement_t<T> *S, typename svg_scalar<T>::scalar t, svg_path_segement_t<T> *A, svg_path_segement_t<T> *B)
+{
+    *A = *S;
+    *B = *S;
+
+    if (S->Type == SvgSegment_CubicBezier) {
+        svg_v2_t<T> P01 = SvgLerp(S->P1, S->C1, t);
+        svg_v2_t<T> P12 = SvgLerp(S->C1, S->C2, t);
+        svg_v2_t<T> P23 = SvgLerp(S->C2, S->P2, t);
+        svg_v2_t<T> P012 = SvgLerp(P01, P12, t);
+        svg_v2_t<T> P123 = SvgLerp(P12, P23, t);
+
+        A->C1 = P01;
+        A->C2 = P012;
+        B->C1 = P123;
+        B->C2 = P23;
+    } else if (S->Type == SvgSegment_QuadraticBezier) {
+        A->C1 = SvgLerp(S->P1, S->C1, t);
+        B->C1 = SvgLerp(S->C1, S->P2, t);
+    }
+
+    svg_v2_t<T> Mid = SvgSegmentAt(S, t);
+    A->P2 = Mid;
+    B->P1 = Mid;
+}
+
+// note: converts an endpoint-parameterized arc to at most 4 cubics (svg spec F.6.5 / F.6.6),
+//       evaluated in the real type of T
+template <typename T>
+u32
+SvgArcToCubics(svg_path_segement_t<T> *Arc, svg_path_segement_t<T> *Cubics)
+{
+    typedef svg_scalar<T> policy;
+    typedef typename svg_scalar<T>::real real;
+
+    svg_v2_t<T> P1 = Arc->P1;
+    svg_v2_t<T> P2 = Arc->P2;
+
+    if (P1 == P2) {
+        return 0;
+    }
+
+    real Rx = SvgAbs(policy::ToReal(Arc->Rx));
+    real Ry = SvgAbs(policy::ToReal(Arc->Ry));
+
+    if (Rx == (real)0 || Ry == (real)0) {
+        // degenerate radii turn the arc into a straight line
+        svg_path_segement_t<T> *S = Cubics;
+        S->Type = SvgSegment_CubicBezier;
+        S->P1 = P1;
+        S->P2 = P2;
+        S->C1 = SvgLerp(P1, P2, SvgScalar<T>(1.0 / 3.0));
+        S->C2 = SvgLerp(P1, P2, SvgScalar<T>(2.0 / 3.0));
+        return 1;
+    }
+
+    real Pi = (real)3.14159265358979323846;
+    real Half = (real)0.5;
+    real Angle = policy::ToReal(Arc->Angle);
+    real CosPhi = 1;
+    real SinPhi = 0;
+
+    if (Angle != (real)0) {
+        real Phi = Angle * (Pi / (real)180);
+        CosPhi = SvgCos(Phi);
+        SinPhi = SvgSin(Phi);
+    }
+
+    real P1x = policy::ToReal(P1.x);
+    real P1y = policy::ToReal(P1.y);
+    real P2x = policy::ToReal(P2.x);
+    real P2y = policy::ToReal(P2.y);
+
+    real Dx2 = (P1x - P2x) * Half;
+    real Dy2 = (P1y - P2y) * Half;
+    real X1 = CosPhi * Dx2 + SinPhi * Dy2;
+    real Y1 = -SinPhi * Dx2 + CosPhi * Dy2;
+
+    real Lambda = (X1 * X1) / (Rx * Rx) + (Y1 * Y1) / (Ry * Ry);
+    if (Lambda > (real)1) {
+        real Scale = SvgSqrt(Lambda);
+        Rx *= Scale;
+        Ry *= Scale;
+    }
+
+    real Rx2 = Rx * Rx;
+    real Ry2 = Ry * Ry;
+    real Num = Rx2 * Ry2 - Rx2 * Y1 * Y1 - Ry2 * X1 * X1;
+    real Den = Rx2 * Y1 * Y1 + Ry2 * X1 * X1;
+    real Ratio = (Den > (real)0) ? Num / Den : (real)0;
+    real Coef = (Den > (real)0) ? SvgSqrt(((real)0 > Ratio) ? (real)0 : Ratio) : (real)0;
+
+    if (!!Arc->UseLargeArc == !!Arc->Clockwise) {
+        Coef = -Coef;
+    }
+
+    real Cx1 = Coef * (Rx * Y1 / Ry);
+    real Cy1 = Coef * -(Ry * X1 / Rx);
+
+    real Cx = CosPhi * Cx1 - SinPhi * Cy1 + (P1x + P2x) * Half;
+    real Cy = SinPhi * Cx1 + CosPhi * Cy1 + (P1y + P2y) * Half;
+
+    // note: start and end directions on the unit circle, the sweep between them is their angle
+    svg_v2_t<real> U = {(X1 - Cx1) / Rx, (Y1 - Cy1) / Ry};
+    svg_v2_t<real> V = {(-X1 - Cx1) / Rx, (-Y1 - Cy1) / Ry};
+    real ULength = SvgLength(U);
+    U = (ULength > (real)0) ? U * ((real)1 / ULength) : svg_v2_t<real>{1, 0};
+
+    real DTheta = SvgAtan2(SvgCross(U, V), SvgDot(U, V));
+
+    if (Arc->Clockwise && DTheta < (real)0) {
+        DTheta += (real)2 * Pi;
+    } else if (!Arc->Clockwise && DTheta > (real)0) {
+        DTheta -= (real)2 * Pi;
+    }
+
+    u32 Count = (u32)SvgCeil(SvgAbs(DTheta) / (Pi * Half) - (real)0.001);
+    if (Count < 1) Count = 1;
+    if (Count > 4) Count = 4;
+
+    real Delta = DTheta / Count;
+    real Kappa = ((real)4 / (real)3) * SvgTan(Delta * (real)0.25);
+
+    svg_v2_t<T> Start = P1;
+    real CosA = U.x;
+    real SinA = U.y;
+    real CosDelta = SvgCos(Delta);
+    real SinDelta = SvgSin(Delta);
+
+    for (u32 i=0; i<Count; ++i) {
+        // note: rotate by Delta instead of evaluating the trig functions for every piece
+        real CosB = CosA * CosDelta - SinA * SinDelta;
+        real SinB = SinA * CosDelta + CosA * SinDelta;
+
+        // control points on the unit circle, then mapped through the ellipse transform
+        real Ux[3] = {CosA - Kappa * SinA, CosB + Kappa * SinB, CosB};
+        real Uy[3] = {SinA + Kappa * CosA, SinB - Kappa * CosB, SinB};
+        svg_v2_t<T> Points[3];
+
+        for (u32 j=0; j<3; ++j) {
+            Points[j].x = policy::FromReal(Cx + Rx * CosPhi * Ux[j] - Ry * SinPhi * Uy[j]);
+            Points[j].y = policy::FromReal(Cy + Rx * SinPhi * Ux[j] + Ry * CosPhi * Uy[j]);
+        }
+
+        svg_path_segement_t<T> *S = Cubics + i;
+        S->Type = SvgSegment_CubicBezier;
+        S->P1 = Start;
+        S->C1 = Points[0];
+        S->C2 = Points[1];
+        S->P2 = (i == Count - 1) ? P2 : Points[2];
+
+        Start = S->P2;
+        CosA = CosB;
+        SinA = SinB;
+    }
+
+    return Count;
+}
+
+// note: control hull bounds, conservative for curves
+template <typename T>
+svg_bounds_t<T>
+SvgSegmentBounds(svg_path_segement_t<T> *S)
+{
+    svg_bounds_t<T> Result = SvgBoundsOf(S->P1);
+    SvgBoundsAdd(&Result, S->P2);
+
+    switch (S->Type) {
+        case SvgSegment_Line: {
+        } break;
+        case SvgSegment_QuadraticBezier: {
+            SvgBoundsAdd(&Result, S->C1);
+        } break;
+        case SvgSegment_CubicBezier: {
+            SvgBoundsAdd(&Result, S->C1);
+            SvgBoundsAdd(&Result, S->C2);
+        } break;
+        case SvgSegment_Elliptical: {
+            svg_path_segement_t<T> Cubics[4];
+            u32 Count = SvgArcToCubics(S, Cubics);
+            for (u32 i=0; i<Count; ++i) {
+                SvgBoundsAdd(&Result, Cubics[i].C1);
+                SvgBoundsAdd(&Result, Cubics[i].C2);
+            }
+        } break;
+    }
+
+    return Result;
+}
+
+// note: real roots of A*t^2 + B*t + C, returns the root count
+u32
+SvgSolveQuadratic(r64 A, r64 B, r64 C, r64 *Roots)
+{
+    if (fabs(A) < 1e-12) {
+        if (fabs(B) < 1e-12) {
+            return 0;
+        }
+        Roots[0] = -C / B;
+        return 1;
+    }
+
+    r64 D = B * B - 4.0 * A * C;
+
+    if (D < 0.0) {
+        return 0;
+    } else if (D == 0.0) {
+        Roots[0] = -B / (2.0 * A);
+        return 1;
+    }
+
+    // note: numerically stable form, avoids cancellation between -B and sqrt(D)
+    r64 Q = -0.5 * (B + (B >= 0.0 ? sqrt(D) : -sqrt(D)));
+    Roots[0] = Q / A;
+    Roots[1] = C / Q;
+
+    return 2;
+}
+
+// note: real roots of A*t^3 + B*t^2 + C*t + D, returns the root count
+u32
+SvgSolveCubic(r64 A, r64 B, r64 C, r64 D, r64 *Roots)
+{
+    if (fabs(A) < 1e-12) {
+        return SvgSolveQuadratic(B, C, D, Roots);
+    }
+
+    r64 b = B / A;
+    r64 c = C / A;
+    r64 d = D / A;
+
+    // depressed cubic t = x - b/3: x^3 + p*x + q = 0
+    r64 p = c - b * b / 3.0;
+    r64 q = 2.0 * b * b * b / 27.0 - b * c / 3.0 + d;
+    r64 Offset = -b / 3.0;
+    r64 Disc = q * q / 4.0 + p * p * p / 27.0;
+
+    if (Disc > 0.0) {
+        r64 S = sqrt(Disc);
+        Roots[0] = cbrt(-q * 0.5 + S) + cbrt(-q * 0.5 - S) + Offset;
+        return 1;
+    } else if (p == 0.0) {
+        Roots[0] = cbrt(-q) + Offset;
+        return 1;
+    }
+
+    r64 R = sqrt(-p / 3.0);
+    r64 Cos = -q / (2.0 * R * R * R);
+    if (Cos < -1.0) Cos = -1.0;
+    if (Cos > 1.0) Cos = 1.0;
+
+    r64 Phi = acos(Cos);
+    r64 Pi = 3.14159265358979323846;
+
+    Roots[0] = 2.0 * R * cos(Phi / 3.0) + Offset;
+    Roots[1] = 2.0 * R * cos((Phi + 2.0 * Pi) / 3.0) + Offset;
+    Roots[2] = 2.0 * R * cos((Phi + 4.0 * Pi) / 3.0) + Offset;
+
+    return 3;
+}
+
+template <typename T>
+struct svg_contour_t {
+    svg_path_segement_t<T> *Segments;
+    u32 Count;
+    b32 Closed;
+};
+
+typedef svg_contour_t<r32> svg_contour;
+
+/*  Walks the contours of a path, At is a cursor that starts at 0. Paths without a subpath list
+    (views made by hand) start a new contour wherever a segment doesn't continue from the previous
+    end point and count as closed where the end meets the start. */
+template <typename T>
+b32
+SvgNextContour(svg_path_t<T> *Path, u32 *At, svg_contour_t<T> *Contour)
+{
+    if (Path->Subpaths.Count) {
+        while (*At < Path->Subpaths.Count) {
+            svg_subpath *Subpath = Path->Subpaths.Data + *At;
+            u32 End = (*At + 1 < Path->Subpaths.Count) ? Subpath[1].First : Path->Segments.Count;
+            ++*At;
+
+            if (End > Subpath->First) {
+                Contour->Segments = Path->Segments.Data + Subpath->First;
+                Contour->Count = End - Subpath->First;
+                Contour->Closed = Subpath->Closed;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    u32 Index = *At;
+    u32 Count = Path->Segments.Count;
+
+    if (Index >= Count) {
+        return false;
+    }
+
+    svg_path_segement_t<T> *Segments = Path->Segments.Data;
+    u32 End = Index + 1;
+
+    while (End < Count && Segments[End].P1 == Segments[End - 1].P2) {
+        ++End;
+    }
+
+    Contour->Segments = Segments + Index;
+    Contour->Count = End - Index;
+    Contour->Closed = (Segments[End - 1].P2 == Segments[Index].P1);
+
+    *At = End;
+
+    return true;
+}
+
+// note: svg matrix(a b c d e f) convention, x' = a*x + c*y + e, y' = b*x + d*y + f
+struct svg_transform {
+    r32 a, b, c, d, e, f;
+};
+
+inline svg_transform
+SvgScaleTransform(r32 Scale)
+{
+    return {Scale, 0.0f, 0.0f, Scale, 0.0f, 0.0f};
+}
+
+inline svg_v2
+SvgTransformPoint(svg_transform T, svg_v2 P)
+{
+    return {T.a * P.x + T.c * P.y + T.e, T.b * P.x + T.d * P.y + T.f};
+}
+
+inline svg_bounds
+SvgTransformBounds(svg_transform T, svg_bounds B)
+{
+    svg_bounds Result = SvgBoundsOf(SvgTransformPoint(T, B.Min));
+    SvgBoundsAdd(&Result, SvgTransformPoint(T, B.Max));
+    SvgBoundsAdd(&Result, SvgTransformPoint(T, {B.Min.x, B.Max.y}));
+    SvgBoundsAdd(&Result, SvgTransformPoint(T, {B.Max.x, B.Min.y}));
+    return Result;
+}
+
+struct svg_polyline {
+    svg_array<svg_v2> Points;
+    svg_array<u32> ContourEnds; // one past the last point of every contour
 };
 
+// note: Wang's formula, number of uniform steps that keeps a bezier within Tolerance of its chords
+inline u32
+SvgFlattenSteps(svg_v2 *P, u32 Degree, r32 Tolerance)
+{
+    r32 M = 0.0f;
+    for (u32 i=0; i + 2 <= Degree; ++i) {
+        svg_v2 D = P[i] - 2.0f * P[i + 1] + P[i + 2];
+        M = SvgMax(M, SvgDot(D, D));
+    }
+
+    r32 Steps = sqrtf(sqrtf(M) * (Degree * (Degree - 1)) / (8.0f * Tolerance));
+    u32 Result = (u32)ceilf(Steps);
+
+    if (Result < 1) Result = 1;
+    if (Result > 256) Result = 256;
+
+    return Result;
+}
+
+// note: appends the transformed segment without its start point
+void
+SvgFlattenSegment(svg_path_segement *S, svg_transform T, r32 Tolerance, svg_array<svg_v2> *Points)
+{
+    switch (S->Type) {
+        case SvgSegment_Line: {
+            Points->Push(SvgTransformPoint(T, S->P2));
+        } break;
+
+        case SvgSegment_QuadraticBezier: {
+            svg_v2 P[3] = {SvgTransformPoint(T, S->P1), SvgTransformPoint(T, S->C1), SvgTransformPoint(T, S->P2)};
+            u32 Steps = SvgFlattenSteps(P, 2, Tolerance);
+            r32 Dt = 1.0f / Steps;
+
+            for (u32 i=1; i<Steps; ++i) {
+                Points->Push(SvgQuadraticAt(P[0], P[1], P[2], i * Dt));
+            }
+            Points->Push(P[2]);
+        } break;
+
+        case SvgSegment_CubicBezier: {
+            svg_v2 P[4] = {SvgTransformPoint(T, S->P1), SvgTransformPoint(T, S->C1), SvgTransformPoint(T, S->C2), SvgTransformPoint(T, S->P2)};
+            u32 Steps = SvgFlattenSteps(P, 3, Tolerance);
+            r32 Dt = 1.0f / Steps;
+
+            for (u32 i=1; i<Steps; ++i) {
+                Points->Push(SvgCubicAt(P[0], P[1], P[2], P[3], i * Dt));
+            }
+            Points->Push(P[3]);
+        } break;
+
+        case SvgSegment_Elliptical: {
+            svg_path_segement Cubics[4];
+            u32 Count = SvgArcToCubics(S, Cubics);
+            for (u32 i=0; i<Count; ++i) {
+                SvgFlattenSegment(Cubics + i, T, Tolerance, Points);
+            }
+        } break;
+    }
+}
+
+// note: appends to Out, Tolerance is in transformed units
+void
+SvgFlattenPath(svg_path *Path, svg_transform T, r32 Tolerance, svg_polyline *Out)
+{
+    u32 At = 0;
+    svg_contour Contour;
+
+    while (SvgNextContour(Path, &At, &Contour)) {
+        Out->Points.Push(SvgTransformPoint(T, Contour.Segments[0].P1));
+
+        for (u32 i=0; i<Contour.Count; ++i) {
+            SvgFlattenSegment(Contour.Segments + i, T, Tolerance, &Out->Points);
+        }
+
+        Out->ContourEnds.Push(Out->Points.Count);
+    }
+}
+
 enum svg_parsing_mode_ {
     SvgParsingMode_Tag,
     SvgParsingMode_Props,
@@ -144,14 +963,45 @@ enum svg_path_command_ {
 
 svg_path_command_ CharCommandMap[128] = {};
 
-svg_v2
-SvgParseV2(ls_parser *P)
+void
+SvgInitCommandMap()
+{
+    CharCommandMap['M'] = SvgPathCommand_Move;
+    CharCommandMap['L'] = SvgPathCommand_LineTo;
+    CharCommandMap['H'] = SvgPathCommand_HorizontalLine;
+    CharCommandMap['V'] = SvgPathCommand_VerticalLine;
+    CharCommandMap['C'] = SvgPathCommand_CubicBezier;
+    CharCommandMap['S'] = SvgPathCommand_SmoothCubicBezier;
+    CharCommandMap['Q'] = SvgPathCommand_QuadraticBezier;
+    CharCommandMap['T'] = SvgPathCommand_SmoothQuadraticBezier;
+    CharCommandMap['A'] = SvgPathCommand_EllipticalArc;
+    CharCommandMap['m'] = SvgPathCommand_MoveRel;
+    CharCommandMap['l'] = SvgPathCommand_LineToRel;
+    CharCommandMap['h'] = SvgPathCommand_HorizontalLineRel;
+    CharCommandMap['v'] = SvgPathCommand_VerticalLineRel;
+    CharCommandMap['c'] = SvgPathCommand_CubicBezierRel;
+    CharCommandMap['s'] = SvgPathCommand_SmoothCubicBezierRel;
+    CharCommandMap['q'] = SvgPathCommand_QuadraticBezierRel;
+    CharCommandMap['t'] = SvgPathCommand_SmoothQuadraticBezierRel;
+    CharCommandMap['a'] = SvgPathCommand_EllipticalArcRel;
+    CharCommandMap['z'] = SvgPathCommand_ClosePath;
+    CharCommandMap['Z'] = SvgPathCommand_ClosePath;
+}
+
+template <typename T>
+T
+SvgParseScalar(ls_parser *P)
 {
     token Token = P->GetToken();
-    r32 x = Token.GetReal();
+    return svg_scalar<T>::Parse(Token);
+}
 
-    Token = P->GetToken();
-    r32 y = Token.GetReal();
+template <typename T = r32>
+svg_v2_t<T>
+SvgParseV2(ls_parser *P)
+{
+    T x = SvgParseScalar<T>(P);
+    T y = SvgParseScalar<T>(P);
 
     return {x,y};
 }
@@ -159,10 +1009,7 @@ SvgParseV2(ls_parser *P)
 r32
 SvgParseFloat(ls_parser *P)
 {
-    token Token = P->GetToken();
-    r32 Value = Token.GetReal();
-
-    return Value;
+    return SvgParseScalar<r32>(P);
 }
 
 int
@@ -187,162 +1034,247 @@ SvgParseCommand(ls_parser *P, svg_path_command_ *Command)
     return false;
 }
 
-void
-SvgAddLineSegment(svg_path *Path, svg_v2 StartP, svg_v2 EndP)
+// note: starts a subpath at the next segment, unless the current one has no segments yet
+template <typename T>
+inline void
+SvgBeginSubpath(svg_path_t<T> *Path)
 {
-    svg_path_segement S;
-    S.Type = SvgSegment_Line;
-    S.P1 = StartP;
-    S.P2 = EndP;
+    u32 Count = Path->Segments.Count;
+    if (!Path->Subpaths.Count || Path->Subpaths.Data[Path->Subpaths.Count - 1].First < Count) {
+        Path->Subpaths.Push({Count, false});
+    }
+}
+
+template <typename T>
+inline void
+SvgCloseSubpath(svg_path_t<T> *Path)
+{
+    if (Path->Subpaths.Count) {
+        svg_subpath *Last = Path->Subpaths.Data + Path->Subpaths.Count - 1;
+        if (Last->First < Path->Segments.Count) {
+            Last->Closed = true;
+        }
+    }
+}
+
+// note: empties a path for reuse, keeping its memory
+template <typename T>
+inline void
+SvgResetPath(svg_path_t<T> *Path)
+{
+    Path->Segments.Count = 0;
+    Path->Subpaths.Count = 0;
+    Path->Bounds = {};
+}
+
+// note: a segment that doesn't continue the current subpath, or follows a closed one, starts a new one
+template <typename T>
+void
+SvgPushSegment(svg_path_t<T> *Path, svg_path_segement_t<T> S)
+{
+    u32 Count = Path->Segments.Count;
+    svg_subpath *Last = Path->Subpaths.Count ? Path->Subpaths.Data + Path->Subpaths.Count - 1 : 0;
+
+    if (!Last || (Last->First < Count && (Last->Closed || S.P1 != Path->Segments.Data[Count - 1].P2))) {
+        Path->Subpaths.Push({Count, false});
+    }
+
+    svg_bounds_t<T> Bounds = SvgSegmentBounds(&S);
+    Path->Bounds = Path->Segments.Count ? SvgBoundsUnion(Path->Bounds, Bounds) : Bounds;
 
     Path->Segments.Push(S);
 }
 
+template <typename T>
+void
+SvgAddLineSegment(svg_path_t<T> *Path, svg_v2_t<T> StartP, svg_v2_t<T> EndP)
+{
+    svg_path_segement_t<T> S;
+    S.Type = SvgSegment_Line;
+    S.P1 = StartP;
+    S.P2 = EndP;
+
+    SvgPushSegment(Path, S);
+}
+
+template <typename T>
 void
-SvgAddCubicBezierSegment(svg_path *Path, svg_v2 StartP, svg_v2 EndP, svg_v2 Control1, svg_v2 Control2)
+SvgAddCubicBezierSegment(svg_path_t<T> *Path, svg_v2_t<T> StartP, svg_v2_t<T> EndP, svg_v2_t<T> Control1, svg_v2_t<T> Control2)
 {
-    svg_path_segement S;
+    svg_path_segement_t<T> S;
     S.Type = SvgSegment_CubicBezier;
     S.P1 = StartP;
-    S.P2 = Control1;
-    S.C1 = EndP;
+    S.P2 = EndP;
+    S.C1 = Control1;
     S.C2 = Control2;
 
-    Path->Segments.Push(S);
+    SvgPushSegment(Path, S);
 }
 
+template <typename T>
 void
-SvgAddQuadraticBezierSegment(svg_path *Path, svg_v2 StartP, svg_v2 EndP)
+SvgAddQuadraticBezierSegment(svg_path_t<T> *Path, svg_v2_t<T> StartP, svg_v2_t<T> EndP, svg_v2_t<T> Control)
 {
-    svg_path_segement S;
+    svg_path_segement_t<T> S;
     S.Type = SvgSegment_QuadraticBezier;
+    S.P1 = StartP;
+    S.P2 = EndP;
+    S.C1 = Control;
 
-    Path->Segments.Push(S);
+    SvgPushSegment(Path, S);
 }
 
+template <typename T>
 void
-SvgAddEllipticalSegment(svg_path *Path, r32 Rx, r32 Ry, r32 Angle, b32 UseLargeArc, b32 Clockwise, svg_v2 Pos)
+SvgAddEllipticalSegment(svg_path_t<T> *Path, svg_v2_t<T> StartP, T Rx, T Ry, T Angle, b32 UseLargeArc, b32 Clockwise, svg_v2_t<T> Pos)
 {
-    svg_path_segement S;
+    svg_path_segement_t<T> S;
     S.Type = SvgSegment_Elliptical;
+    S.P1 = StartP;
+    S.P2 = Pos;
     S.Rx = Rx;
     S.Ry = Ry;
     S.Angle = Angle;
     S.UseLargeArc = UseLargeArc;
     S.Clockwise = Clockwise;
-    Path->Segments.Push(S);
+
+    SvgPushSegment(Path, S);
 }
 
+// note: path data parser shared by every scalar type, appends to Path with a subpath per 'M'
+template <typename T>
 void
-SvgParsePath(svg *Svg, ls_string String)
+SvgParsePathCommands(ls_string String, svg_path_t<T> *Path)
 {
     ls_parser P = String;
 
     svg_path_command_ CurrentCommand = SvgPathCommand_Null;
-    svg_v2 CurrentP = {};
-    svg_v2 PreviousControlP = {};
-
-    auto *E = Svg->Elements.AllocN(1);
-    E->Type = SvgElement_Path;
-
-    printf("PATH:\n");
+    svg_path_command_ LastCommand = SvgPathCommand_Null;
+    svg_v2_t<T> CurrentP = {};
+    svg_v2_t<T> SubpathStartP = {};
+    svg_v2_t<T> PreviousControlP = {};
 
     while (P.RemainingBytes()) {
-        SvgParseCommand(&P, &CurrentCommand);
+        // note: whitespace after the last number, nothing follows it
+        if (!SvgParseCommand(&P, &CurrentCommand) && !P.RemainingBytes()) {
+            break;
+        }
         assert(CurrentCommand != SvgPathCommand_Null);
 
+        b32 LastWasCubic = (LastCommand == SvgPathCommand_CubicBezier ||
+                            LastCommand == SvgPathCommand_CubicBezierRel ||
+                            LastCommand == SvgPathCommand_SmoothCubicBezier ||
+                            LastCommand == SvgPathCommand_SmoothCubicBezierRel);
+        b32 LastWasQuadratic = (LastCommand == SvgPathCommand_QuadraticBezier ||
+                                LastCommand == SvgPathCommand_QuadraticBezierRel ||
+                                LastCommand == SvgPathCommand_SmoothQuadraticBezier ||
+                                LastCommand == SvgPathCommand_SmoothQuadraticBezierRel);
+
         switch (CurrentCommand) {
             case SvgPathCommand_Move: {
-                printf("    Move ");
-                CurrentP = SvgParseV2(&P);
+                LS_SVG_LOG("    Move ");
+                CurrentP = SvgParseV2<T>(&P);
+                SubpathStartP = CurrentP;
+                SvgBeginSubpath(Path);
                 CurrentCommand = SvgPathCommand_LineTo;
-                printf("%.2f %.2f\n", CurrentP.x, CurrentP.y);
+                LS_SVG_LOG("%.2f %.2f\n", SvgReal64(CurrentP.x), SvgReal64(CurrentP.y));
             } break;
             case SvgPathCommand_MoveRel: {
-                printf("    MoveRel ");
-                svg_v2 Pos = SvgParseV2(&P);
+                LS_SVG_LOG("    MoveRel ");
+                svg_v2_t<T> Pos = SvgParseV2<T>(&P);
 
-                printf("%.2f %.2f\n", Pos.x, Pos.y);
+                LS_SVG_LOG("%.2f %.2f\n", SvgReal64(Pos.x), SvgReal64(Pos.y));
 
                 CurrentP.x += Pos.x;
                 CurrentP.y += Pos.y;
+                SubpathStartP = CurrentP;
+                SvgBeginSubpath(Path);
                 CurrentCommand = SvgPathCommand_LineToRel;
             } break;
             case SvgPathCommand_LineTo: {
-                printf("    LineTo ");
-                svg_v2 Pos = SvgParseV2(&P);
-                printf("%.2f %.2f\n", Pos.x, Pos.y);
-                SvgAddLineSegment(&E->Path, CurrentP, Pos);
+                LS_SVG_LOG("    LineTo ");
+                svg_v2_t<T> Pos = SvgParseV2<T>(&P);
+                LS_SVG_LOG("%.2f %.2f\n", SvgReal64(Pos.x), SvgReal64(Pos.y));
+                SvgAddLineSegment(Path, CurrentP, Pos);
                 CurrentP = Pos;
             } break;
             case SvgPathCommand_LineToRel: {
-                printf("    LineToRel ");
-                svg_v2 Pos = SvgParseV2(&P);
-                printf("%.2f %.2f\n", Pos.x, Pos.y);
+                LS_SVG_LOG("    LineToRel ");
+                svg_v2_t<T> Pos = SvgParseV2<T>(&P);
+                LS_SVG_LOG("%.2f %.2f\n", SvgReal64(Pos.x), SvgReal64(Pos.y));
                 Pos.x = CurrentP.x + Pos.x;
                 Pos.y = CurrentP.y + Pos.y;
 
-                SvgAddLineSegment(&E->Path, CurrentP, Pos);
+                SvgAddLineSegment(Path, CurrentP, Pos);
                 CurrentP = Pos;
             } break;
             case SvgPathCommand_HorizontalLine: {
-                printf("    HorizontalLine ");
-                r32 X = SvgParseFloat(&P);
-                svg_v2 EndP = CurrentP;
+                LS_SVG_LOG("    HorizontalLine ");
+                T X = SvgParseScalar<T>(&P);
+                svg_v2_t<T> EndP = CurrentP;
                 EndP.x = X;
-                SvgAddLineSegment(&E->Path, CurrentP, EndP);
+                SvgAddLineSegment(Path, CurrentP, EndP);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_HorizontalLineRel: {
-                printf("    HorizontalLineRel ");
-                r32 X = SvgParseFloat(&P);
-                svg_v2 EndP = CurrentP;
+                LS_SVG_LOG("    HorizontalLineRel ");
+                T X = SvgParseScalar<T>(&P);
+                svg_v2_t<T> EndP = CurrentP;
                 EndP.x += X;
-                SvgAddLineSegment(&E->Path, CurrentP, EndP);
+                SvgAddLineSegment(Path, CurrentP, EndP);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_VerticalLine: {
-                printf("    VerticalLine ");
-                r32 Y = SvgParseFloat(&P);
-                svg_v2 EndP = CurrentP;
+                LS_SVG_LOG("    VerticalLine ");
+                T Y = SvgParseScalar<T>(&P);
+                svg_v2_t<T> EndP = CurrentP;
                 EndP.y = Y;
-                SvgAddLineSegment(&E->Path, CurrentP, EndP);
+                SvgAddLineSegment(Path, CurrentP, EndP);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_VerticalLineRel: {
-                printf("    VerticalLineRel ");
-                r32 Y = SvgParseFloat(&P);
-                svg_v2 EndP = CurrentP;
+                LS_SVG_LOG("    VerticalLineRel ");
+                T Y = SvgParseScalar<T>(&P);
+                svg_v2_t<T> EndP = CurrentP;
                 EndP.y += Y;
-                SvgAddLineSegment(&E->Path, CurrentP, EndP);
+                SvgAddLineSegment(Path, CurrentP, EndP);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_SmoothCubicBezier: {
-                printf("    SmoofCubicBezier");
-                svg_v2 Control2 = SvgParseV2(&P);
-                svg_v2 EndP = SvgParseV2(&P);
-                svg_v2 Control1 = CurrentP;
+                LS_SVG_LOG("    SmoofCubicBezier");
+                svg_v2_t<T> Control2 = SvgParseV2<T>(&P);
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
+                svg_v2_t<T> Control1 = CurrentP;
+
+                if (!LastWasCubic) {
+                    // note: without a preceding cubic the reflected control point is the current point
+                    PreviousControlP = CurrentP;
+                }
 
-                svg_v2 C1Rel = PreviousControlP;
+                svg_v2_t<T> C1Rel = PreviousControlP;
                 C1Rel.x -= CurrentP.x;
                 C1Rel.y -= CurrentP.y;
-                C1Rel.x *= -1.0f;
-                C1Rel.y *= -1.0f;
+                C1Rel.x = -C1Rel.x;
+                C1Rel.y = -C1Rel.y;
 
                 Control1.x += C1Rel.x;
                 Control1.y += C1Rel.y;
 
                 PreviousControlP = Control2;
 
-                printf("%.2f %.2f %.2f %.2f\n", Control2.x, Control2.y, EndP.x, EndP.y);
-                SvgAddCubicBezierSegment(&E->Path, CurrentP, EndP, Control1, Control2);
+                LS_SVG_LOG("%.2f %.2f %.2f %.2f\n", SvgReal64(Control2.x), SvgReal64(Control2.y), SvgReal64(EndP.x), SvgReal64(EndP.y));
+                SvgAddCubicBezierSegment(Path, CurrentP, EndP, Control1, Control2);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_SmoothCubicBezierRel: {
-                printf("    SmoofCubicBezierRel");
-                svg_v2 Control2 = SvgParseV2(&P);
-                svg_v2 EndP = SvgParseV2(&P);
-                svg_v2 Control1 = CurrentP;
+                LS_SVG_LOG("    SmoofCubicBezierRel");
+                svg_v2_t<T> Control2 = SvgParseV2<T>(&P);
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
+                svg_v2_t<T> Control1 = CurrentP;
+
+                if (!LastWasCubic) {
+                    PreviousControlP = CurrentP;
+                }
 
                 Control2.x += CurrentP.x;
                 Control2.y += CurrentP.y;
@@ -350,38 +1282,40 @@ SvgParsePath(svg *Svg, ls_string String)
                 EndP.x += CurrentP.x;
                 EndP.y += CurrentP.y;
 
-                svg_v2 C1Rel = PreviousControlP;
+                svg_v2_t<T> C1Rel = PreviousControlP;
                 C1Rel.x -= CurrentP.x;
                 C1Rel.y -= CurrentP.y;
-                C1Rel.x *= -1.0f;
-                C1Rel.y *= -1.0f;
+                C1Rel.x = -C1Rel.x;
+                C1Rel.y = -C1Rel.y;
 
                 Control1.x += C1Rel.x;
                 Control1.y += C1Rel.y;
 
-                printf("%.2f %.2f %.2f %.2f\n", Control2.x, Control2.y, EndP.x, EndP.y);
-                SvgAddCubicBezierSegment(&E->Path, CurrentP, EndP, Control1, Control2);
+                PreviousControlP = Control2;
+
+                LS_SVG_LOG("%.2f %.2f %.2f %.2f\n", SvgReal64(Control2.x), SvgReal64(Control2.y), SvgReal64(EndP.x), SvgReal64(EndP.y));
+                SvgAddCubicBezierSegment(Path, CurrentP, EndP, Control1, Control2);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_CubicBezier: {
-                printf("    CubicBezier ");
-                svg_v2 Control1 = SvgParseV2(&P);
-                svg_v2 Control2 = SvgParseV2(&P);
-                svg_v2 EndP = SvgParseV2(&P);
+                LS_SVG_LOG("    CubicBezier ");
+                svg_v2_t<T> Control1 = SvgParseV2<T>(&P);
+                svg_v2_t<T> Control2 = SvgParseV2<T>(&P);
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
 
                 PreviousControlP = Control2;
 
-                printf("%.2f %.2f %.2f %.2f %.2f %.2f\n", Control1.x, Control1.y, Control2.x,Control2.y, EndP.x, EndP.y);
-                SvgAddCubicBezierSegment(&E->Path, CurrentP, EndP, Control1, Control2);
+                LS_SVG_LOG("%.2f %.2f %.2f %.2f %.2f %.2f\n", SvgReal64(Control1.x), SvgReal64(Control1.y), SvgReal64(Control2.x),SvgReal64(Control2.y), SvgReal64(EndP.x), SvgReal64(EndP.y));
+                SvgAddCubicBezierSegment(Path, CurrentP, EndP, Control1, Control2);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_CubicBezierRel: {
-                printf("    CubicBezierRel ");
-                svg_v2 Control1 = SvgParseV2(&P);
-                svg_v2 Control2 = SvgParseV2(&P);
-                svg_v2 EndP = SvgParseV2(&P);
+                LS_SVG_LOG("    CubicBezierRel ");
+                svg_v2_t<T> Control1 = SvgParseV2<T>(&P);
+                svg_v2_t<T> Control2 = SvgParseV2<T>(&P);
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
 
-                printf("%.2f %.2f %.2f %.2f %.2f %.2f\n", Control1.x, Control1.y, Control2.x,Control2.y, EndP.x, EndP.y);
+                LS_SVG_LOG("%.2f %.2f %.2f %.2f %.2f %.2f\n", SvgReal64(Control1.x), SvgReal64(Control1.y), SvgReal64(Control2.x),SvgReal64(Control2.y), SvgReal64(EndP.x), SvgReal64(EndP.y));
 
                 Control1.x += CurrentP.x;
                 Control1.y += CurrentP.y;
@@ -394,48 +1328,103 @@ SvgParsePath(svg *Svg, ls_string String)
 
                 PreviousControlP = Control2;
 
-                SvgAddCubicBezierSegment(&E->Path, CurrentP, EndP, Control1, Control2);
+                SvgAddCubicBezierSegment(Path, CurrentP, EndP, Control1, Control2);
+                CurrentP = EndP;
+            } break;
+            case SvgPathCommand_QuadraticBezier: {
+                LS_SVG_LOG("    QuadraticBezier ");
+                svg_v2_t<T> Control = SvgParseV2<T>(&P);
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
+
+                PreviousControlP = Control;
+
+                LS_SVG_LOG("%.2f %.2f %.2f %.2f\n", SvgReal64(Control.x), SvgReal64(Control.y), SvgReal64(EndP.x), SvgReal64(EndP.y));
+                SvgAddQuadraticBezierSegment(Path, CurrentP, EndP, Control);
+                CurrentP = EndP;
+            } break;
+            case SvgPathCommand_QuadraticBezierRel: {
+                LS_SVG_LOG("    QuadraticBezierRel ");
+                svg_v2_t<T> Control = SvgParseV2<T>(&P);
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
+
+                LS_SVG_LOG("%.2f %.2f %.2f %.2f\n", SvgReal64(Control.x), SvgReal64(Control.y), SvgReal64(EndP.x), SvgReal64(EndP.y));
+
+                Control.x += CurrentP.x;
+                Control.y += CurrentP.y;
+
+                EndP.x += CurrentP.x;
+                EndP.y += CurrentP.y;
+
+                PreviousControlP = Control;
+
+                SvgAddQuadraticBezierSegment(Path, CurrentP, EndP, Control);
+                CurrentP = EndP;
+            } break;
+            case SvgPathCommand_SmoothQuadraticBezier:
+            case SvgPathCommand_SmoothQuadraticBezierRel: {
+                LS_SVG_LOG("    SmoothQuadraticBezier ");
+                svg_v2_t<T> EndP = SvgParseV2<T>(&P);
+
+                LS_SVG_LOG("%.2f %.2f\n", SvgReal64(EndP.x), SvgReal64(EndP.y));
+
+                if (CurrentCommand == SvgPathCommand_SmoothQuadraticBezierRel) {
+                    EndP.x += CurrentP.x;
+                    EndP.y += CurrentP.y;
+                }
+
+                svg_v2_t<T> Control = CurrentP;
+                if (LastWasQuadratic) {
+                    Control.x += CurrentP.x - PreviousControlP.x;
+                    Control.y += CurrentP.y - PreviousControlP.y;
+                }
+
+                PreviousControlP = Control;
+
+                SvgAddQuadraticBezierSegment(Path, CurrentP, EndP, Control);
                 CurrentP = EndP;
             } break;
             case SvgPathCommand_EllipticalArc: {
-                printf("    EllipticalArc ");
-                r32 Rx = SvgParseFloat(&P);
-                r32 Ry = SvgParseFloat(&P);
-                r32 Angle = SvgParseFloat(&P);
+                LS_SVG_LOG("    EllipticalArc ");
+                T Rx = SvgParseScalar<T>(&P);
+                T Ry = SvgParseScalar<T>(&P);
+                T Angle = SvgParseScalar<T>(&P);
                 int Arc = SvgParseInt(&P);
                 int Sweep = SvgParseInt(&P);
-                svg_v2 Pos = SvgParseV2(&P);
+                svg_v2_t<T> Pos = SvgParseV2<T>(&P);
 
-                printf("%.2f %.2f %.2f %d %d %.2f %.2f\n", Rx, Ry, Angle, Arc, Sweep, Pos.x, Pos.y);
+                LS_SVG_LOG("%.2f %.2f %.2f %d %d %.2f %.2f\n", SvgReal64(Rx), SvgReal64(Ry), SvgReal64(Angle), Arc, Sweep, SvgReal64(Pos.x), SvgReal64(Pos.y));
 
-                SvgAddEllipticalSegment(&E->Path, Rx, Ry, Angle, Arc, Sweep, Pos);
+                SvgAddEllipticalSegment(Path, CurrentP, Rx, Ry, Angle, Arc, Sweep, Pos);
                 CurrentP = Pos;
             } break;
             case SvgPathCommand_EllipticalArcRel: {
-                printf("    EllipticalArcRel ");
-                r32 Rx = SvgParseFloat(&P);
-                r32 Ry = SvgParseFloat(&P);
-                r32 Angle = SvgParseFloat(&P);
+                LS_SVG_LOG("    EllipticalArcRel ");
+                T Rx = SvgParseScalar<T>(&P);
+                T Ry = SvgParseScalar<T>(&P);
+                T Angle = SvgParseScalar<T>(&P);
                 int Arc = SvgParseInt(&P);
                 int Sweep = SvgParseInt(&P);
-                svg_v2 Pos = SvgParseV2(&P);
+                svg_v2_t<T> Pos = SvgParseV2<T>(&P);
 
-                printf("%.2f %.2f %.2f %d %d %.2f %.2f\n", Rx, Ry, Angle, Arc, Sweep, Pos.x, Pos.y);
+                LS_SVG_LOG("%.2f %.2f %.2f %d %d %.2f %.2f\n", SvgReal64(Rx), SvgReal64(Ry), SvgReal64(Angle), Arc, Sweep, SvgReal64(Pos.x), SvgReal64(Pos.y));
 
                 Pos.x += CurrentP.x;
                 Pos.y += CurrentP.y;
 
-                SvgAddEllipticalSegment(&E->Path, Rx, Ry, Angle, Arc, Sweep, Pos);
+                SvgAddEllipticalSegment(Path, CurrentP, Rx, Ry, Angle, Arc, Sweep, Pos);
                 CurrentP = Pos;
             } break;
             case SvgPathCommand_ClosePath: {
-                printf("    ClosePath ");
-                E->Path.Closed = true;
+                LS_SVG_LOG("    ClosePath ");
 
-                E = Svg->Elements.AllocN(1);
-                E->Type = SvgElement_Path;
+                // note: a subpath closed right after its move is a zero length segment, it still gets caps
+                b32 Empty = (Path->Subpaths.Count && Path->Subpaths.Data[Path->Subpaths.Count - 1].First == Path->Segments.Count);
+                if (CurrentP != SubpathStartP || Empty) {
+                    SvgAddLineSegment(Path, CurrentP, SubpathStartP);
+                }
 
-                printf("PATH:\n");
+                CurrentP = SubpathStartP;
+                SvgCloseSubpath(Path);
             } break;
 
             default: {
@@ -443,102 +1432,541 @@ SvgParsePath(svg *Svg, ls_string String)
             }
         }
 
-        u32 a = 4;
+        LastCommand = CurrentCommand;
+    }
+
+    // note: a trailing move has no segments
+    if (Path->Subpaths.Count && Path->Subpaths.Data[Path->Subpaths.Count - 1].First == Path->Segments.Count) {
+        Path->Subpaths.Count--;
+    }
+}
+
+// note: the numbers each command reads, the arc flags included
+global_variable u32 SvgPathCommandNumbers[SvgPathCommand_Count] = {
+    0, 2, 2, 1, 1, 6, 4, 4, 2, 7, 2, 2, 1, 1, 6, 4, 4, 2, 7, 0,
+};
+
+/*  True when SvgParsePathCommands can read String, which asserts on malformed data. It walks the
+    same tokens without building anything, for path data that comes from someone still typing it. */
+b32
+SvgIsPathData(ls_string String)
+{
+    ls_parser P = String;
+    svg_path_command_ Command = SvgPathCommand_Null;
+
+    while (P.RemainingBytes()) {
+        b32 Letter = SvgParseCommand(&P, &Command);
+        if (!Letter && !P.RemainingBytes()) {
+            break;
+        }
+
+        if (Command == SvgPathCommand_Null) {
+            return false;
+        }
+
+        // note: numbers after a close would be read as more closes forever
+        if (Command == SvgPathCommand_ClosePath && !Letter) {
+            return false;
+        }
+
+        for (u32 i=0; i<SvgPathCommandNumbers[Command]; ++i) {
+            token Token = P.GetToken();
+            if (Token.Type != Token_Real && Token.Type != Token_Integer) {
+                return false;
+            }
+        }
+
+        if (Command == SvgPathCommand_Move) {
+            Command = SvgPathCommand_LineTo;
+        } else if (Command == SvgPathCommand_MoveRel) {
+            Command = SvgPathCommand_LineToRel;
+        }
+    }
+
+    return true;
+}
+
+// note: one element per d attribute, its subpaths are the contours that the fill rule combines
+void
+SvgParsePath(svg *Svg, ls_string String)
+{
+    LS_SVG_ZONE("SvgParsePath");
+
+    auto *E = Svg->Elements.AllocN(1);
+    E->Type = SvgElement_Path;
+    E->Path.Segments.Allocator = Svg->Elements.Allocator;
+    E->Path.Subpaths.Allocator = Svg->Elements.Allocator;
+
+    E->Source = String;
+    if (Svg->Lazy) {
+        return;
+    }
+
+    LS_SVG_LOG("PATH:\n");
+
+    SvgParsePathCommands(String, &E->Path);
+}
+
+// note: parses d attribute data into a single path of any scalar type, subpaths become contours
+template <typename T>
+void
+SvgParsePathData(ls_string String, svg_path_t<T> *Path)
+{
+    SvgInitCommandMap();
+    SvgParsePathCommands(String, Path);
+}
+
+// note: appends Path converted to another scalar type to Out, subpaths included. Bounds are recomputed in the new type
+template <typename to, typename from>
+void
+SvgConvertPath(svg_path_t<from> *Path, svg_path_t<to> *Out)
+{
+    u32 At = 0;
+    svg_contour_t<from> Contour;
+
+    while (SvgNextContour(Path, &At, &Contour)) {
+        SvgBeginSubpath(Out);
+
+        for (u32 i=0; i<Contour.Count; ++i) {
+            svg_path_segement_t<from> *S = Contour.Segments + i;
+            svg_path_segement_t<to> Result = {};
+            Result.Type = S->Type;
+            Result.P1 = {SvgScalarCast<to>(S->P1.x), SvgScalarCast<to>(S->P1.y)};
+            Result.P2 = {SvgScalarCast<to>(S->P2.x), SvgScalarCast<to>(S->P2.y)};
+
+            if (S->Type == SvgSegment_Elliptical) {
+                Result.Rx = SvgScalarCast<to>(S->Rx);
+                Result.Ry = SvgScalarCast<to>(S->Ry);
+                Result.Angle = SvgScalarCast<to>(S->Angle);
+                Result.UseLargeArc = S->UseLargeArc;
+                Result.Clockwise = S->Clockwise;
+            } else if (S->Type != SvgSegment_Line) {
+                Result.C1 = {SvgScalarCast<to>(S->C1.x), SvgScalarCast<to>(S->C1.y)};
+                Result.C2 = {SvgScalarCast<to>(S->C2.x), SvgScalarCast<to>(S->C2.y)};
+            }
+
+            SvgPushSegment(Out, Result);
+        }
+
+        if (Contour.Closed) {
+            SvgCloseSubpath(Out);
+        }
+    }
+}
+
+svg_fill_rule_
+SvgParseFillRule(ls_string Value, svg_fill_rule_ Inherited)
+{
+    svg_fill_rule_ Result = Inherited;
+
+    if (Value == "evenodd") {
+        Result = SvgFillRule_EvenOdd;
+    } else if (Value == "nonzero") {
+        Result = SvgFillRule_NonZero;
+    }
+
+    return Result;
+}
+
+internal u32
+SvgHexDigit(char C)
+{
+    u32 Result = 0;
+
+    if (ls_parser::Digit(C)) {
+        Result = C - '0';
+    } else if (C >= 'a' && C <= 'f') {
+        Result = C - 'a' + 10;
+    } else if (C >= 'A' && C <= 'F') {
+        Result = C - 'A' + 10;
+    }
+
+    return Result;
+}
+
+// note: returns 0xRRGGBBAA, 0 for "none"
+u32
+SvgParseColor(ls_string Value, u32 Inherited)
+{
+    u32 Result = Inherited;
+
+    if (Value == "none") {
+        Result = 0;
+    } else if (Value == "black") {
+        Result = 0x000000ff;
+    } else if (Value == "white") {
+        Result = 0xffffffff;
+    } else if (Value.Size == 4 && Value.Data[0] == '#') {
+        Result = 0xff;
+        for (u32 i=0; i<3; ++i) {
+            u32 Digit = SvgHexDigit(Value.Data[i + 1]);
+            Result |= ((Digit << 4) | Digit) << (24 - i * 8);
+        }
+    } else if (Value.Size == 7 && Value.Data[0] == '#') {
+        Result = 0xff;
+        for (u32 i=0; i<6; ++i) {
+            Result |= SvgHexDigit(Value.Data[i + 1]) << (28 - i * 4);
+        }
+    }
+
+    return Result;
+}
+
+svg_line_join_
+SvgParseLineJoin(ls_string Value, svg_line_join_ Inherited)
+{
+    svg_line_join_ Result = Inherited;
+
+    if (Value == "miter") {
+        Result = SvgLineJoin_Miter;
+    } else if (Value == "round") {
+        Result = SvgLineJoin_Round;
+    } else if (Value == "bevel") {
+        Result = SvgLineJoin_Bevel;
+    }
+
+    return Result;
+}
+
+svg_line_cap_
+SvgParseLineCap(ls_string Value, svg_line_cap_ Inherited)
+{
+    svg_line_cap_ Result = Inherited;
+
+    if (Value == "butt") {
+        Result = SvgLineCap_Butt;
+    } else if (Value == "round") {
+        Result = SvgLineCap_Round;
+    } else if (Value == "square") {
+        Result = SvgLineCap_Square;
+    }
+
+    return Result;
+}
+
+// note: stroke properties, shared by every tag that can carry them
+// note: "none", or lengths separated by commas or spaces. Negative lengths make the attribute invalid.
+internal void
+SvgParseDashArray(svg *Svg, ls_string PropValue, svg_stroke_style *Style)
+{
+    u32 First = Svg->Dashes.Count;
+    b32 Valid = true;
+
+    ls_parser P = PropValue;
+    ls_split_iterator Fields = P.Split((char *)" ,\t\r\n");
+    ls_string Field;
+
+    while (Fields.Next(&Field)) {
+        // note: a field is usually one length, "5-3" still reads as two
+        ls_parser F = Field;
+        while (F.RemainingBytes()) {
+            token Token = F.GetToken();
+            if (Token.Type == Token_Integer || Token.Type == Token_Real) {
+                r32 Value = Token.GetReal();
+                Valid = Valid && Value >= 0.0f;
+                Svg->Dashes.Push(Value);
+            }
+        }
+    }
+
+    if (!Valid) {
+        Svg->Dashes.Count = First;
+        return;
+    }
+
+    Style->DashFirst = First;
+    Style->DashCount = Svg->Dashes.Count - First;
+}
+
+b32
+SvgParseStrokeProperty(svg *Svg, ls_string Prop, ls_string PropValue, u32 *Stroke, svg_stroke_style *Style)
+{
+    if (Prop == "stroke") {
+        *Stroke = SvgParseColor(PropValue, *Stroke);
+    } else if (Prop == "stroke-width") {
+        ls_parser P = PropValue;
+        Style->Width = SvgParseFloat(&P);
+    } else if (Prop == "stroke-linejoin") {
+        Style->Join = SvgParseLineJoin(PropValue, Style->Join);
+    } else if (Prop == "stroke-linecap") {
+        Style->Cap = SvgParseLineCap(PropValue, Style->Cap);
+    } else if (Prop == "stroke-miterlimit") {
+        ls_parser P = PropValue;
+        Style->MiterLimit = SvgParseFloat(&P);
+    } else if (Prop == "stroke-dasharray") {
+        SvgParseDashArray(Svg, PropValue, Style);
+    } else if (Prop == "stroke-dashoffset") {
+        ls_parser P = PropValue;
+        Style->DashOffset = SvgParseFloat(&P);
+    } else {
+        return false;
     }
+
+    return true;
 }
 
 void
-SvgParseProperty(svg *Svg, ls_string Tag, ls_string Prop, ls_string PropValue)
+SvgParseProperty(svg *Svg, svg_tag *Tag, ls_string Prop, ls_string PropValue)
 {
-    if (Tag == "path") {
+    LS_SVG_ZONE("SvgParseProperty");
+
+    if (Prop == "id") {
+        Tag->Id = PropValue;
+    } else if (Tag->Name == "svg") {
+        if (Prop == "fill-rule") {
+            Svg->FillRule = SvgParseFillRule(PropValue, Svg->FillRule);
+            Tag->FillRule = Svg->FillRule;
+        } else if (Prop == "fill") {
+            Svg->Fill = SvgParseColor(PropValue, Svg->Fill);
+            Tag->Fill = Svg->Fill;
+        } else if (SvgParseStrokeProperty(Svg, Prop, PropValue, &Svg->Stroke, &Svg->StrokeStyle)) {
+            Tag->Stroke = Svg->Stroke;
+            Tag->StrokeStyle = Svg->StrokeStyle;
+        }
+    } else if (Tag->Name == "path") {
         if (Prop == "d") {
             SvgParsePath(Svg, PropValue);
+        } else if (Prop == "fill-rule") {
+            Tag->FillRule = SvgParseFillRule(PropValue, Tag->FillRule);
+        } else if (Prop == "fill") {
+            Tag->Fill = SvgParseColor(PropValue, Tag->Fill);
+        } else {
+            SvgParseStrokeProperty(Svg, Prop, PropValue, &Tag->Stroke, &Tag->StrokeStyle);
         }
     }
 }
 
-svg
-SvgParse(u8 *Data, u32 Size)
+void
+SvgEndTag(svg *Svg, svg_tag *Tag)
 {
-    CharCommandMap['M'] = SvgPathCommand_Move;
-    CharCommandMap['L'] = SvgPathCommand_LineTo;
-    CharCommandMap['H'] = SvgPathCommand_HorizontalLine;
-    CharCommandMap['V'] = SvgPathCommand_VerticalLine;
-    CharCommandMap['C'] = SvgPathCommand_CubicBezier;
-    CharCommandMap['S'] = SvgPathCommand_SmoothCubicBezier;
-    CharCommandMap['Q'] = SvgPathCommand_QuadraticBezier;
-    CharCommandMap['T'] = SvgPathCommand_SmoothQuadraticBezier;
-    CharCommandMap['A'] = SvgPathCommand_EllipticalArc;
-    CharCommandMap['m'] = SvgPathCommand_MoveRel;
-    CharCommandMap['l'] = SvgPathCommand_LineToRel;
-    CharCommandMap['h'] = SvgPathCommand_HorizontalLineRel;
-    CharCommandMap['v'] = SvgPathCommand_VerticalLineRel;
-    CharCommandMap['c'] = SvgPathCommand_CubicBezierRel;
-    CharCommandMap['s'] = SvgPathCommand_SmoothCubicBezierRel;
-    CharCommandMap['q'] = SvgPathCommand_QuadraticBezierRel;
-    CharCommandMap['t'] = SvgPathCommand_SmoothQuadraticBezierRel;
-    CharCommandMap['a'] = SvgPathCommand_EllipticalArcRel;
-    CharCommandMap['z'] = SvgPathCommand_ClosePath;
-    CharCommandMap['Z'] = SvgPathCommand_ClosePath;
+    for (u32 i=Tag->FirstElement; i<Svg->Elements.Count; ++i) {
+        Svg->Elements.Data[i].FillRule = Tag->FillRule;
+        Svg->Elements.Data[i].Fill = Tag->Fill;
+        Svg->Elements.Data[i].Stroke = Tag->Stroke;
+        Svg->Elements.Data[i].StrokeStyle = Tag->StrokeStyle;
+        Svg->Elements.Data[i].Id = Tag->Id;
+        Svg->Elements.Data[i].Markup = Tag->Markup;
+    }
+}
 
-    svg Svg = {};
+/*  Elements SvgParse skips with everything inside them, by default the ones editors fill with
+    bulk the geometry doesn't need. The search for the end tag doesn't tokenize the content. */
+global_variable char *SvgDefaultSkippedElements[] = {
+    (char *)"metadata",
+    (char *)"sodipodi:namedview",
+    (char *)"title",
+    (char *)"desc",
+    (char *)"style",
+    (char *)"script",
+    (char *)"font",
+    (char *)"font-face",
+    (char *)"foreignObject",
+    0,
+};
+
+// note: Token read with the namespace prefix that may follow it, for names like "inkscape:label"
+internal ls_string
+SvgParseName(ls_parser *String, token Token)
+{
+    ls_string Name = Token.Text;
+
+    if (Token.Type == Token_Identifier && String->RemainingBytes() && *String->At == ':') {
+        ++String->At;
+        token Local = String->GetToken();
+        Name.Size = (u32)(Local.Text.Data + Local.Text.Size - Name.Data);
+    }
+
+    return Name;
+}
+
+inline b32
+SvgNameEndsAt(ls_parser *String)
+{
+    char C = String->RemainingBytes() ? *String->At : '>';
+    return C == '>' || C == '/' || C == ' ' || C == '\t' || C == '\r' || C == '\n';
+}
+
+// note: moves At to the first of Delimiters, false and at the end without one
+internal b32
+SvgFFToAny(ls_parser *String, char *Delimiters)
+{
+    ls_split_iterator Split = String->Split(Delimiters, false);
+    ls_string Field;
+
+    if (!Split.Next(&Field)) {
+        return false;
+    }
+
+    String->At = Field.Data + Field.Size;
+    return String->RemainingBytes() > 0;
+}
+
+// note: moves past the '>' of the start tag At is in, quoted values can hold one. True for "/>"
+internal b32
+SvgSkipStartTag(ls_parser *String)
+{
+    while (SvgFFToAny(String, (char *)"\"'>")) {
+        char Stop = *String->At++;
+
+        if (Stop == '>') {
+            return String->At - String->Data >= 2 && String->At[-2] == '/';
+        }
+
+        String->FFToAfterChar(Stop);
+    }
+
+    return false;
+}
+
+/*  Skips the rest of an element whose name was just read: its start tag, the content and the end
+    tag. Elements of the same name inside it are counted so the right end tag closes it. Comments
+    and CDATA inside aren't looked at, an end tag in one of them ends the element early. */
+internal void
+SvgSkipElement(ls_parser *String, ls_string Name)
+{
+    if (SvgSkipStartTag(String)) {
+        return;
+    }
+
+    char Close[128];
+    u32 CloseSize = Name.Size + 2;
+    if (CloseSize > sizeof(Close)) {
+        String->At = String->Data + String->Size;
+        return;
+    }
+    Close[0] = '<';
+    Close[1] = '/';
+    memcpy(Close + 2, Name.Data, Name.Size);
+
+    char *End = String->Data + String->Size;
+    u32 Depth = 1;
+
+    while (Depth) {
+        ls_parser Rest(String->At, (u32)(End - String->At));
+        if (!Rest.FFToString(Close, CloseSize)) {
+            String->At = End;
+            return;
+        }
+
+        // note: "<name" is the end tag needle without its '/'
+        ls_parser Between(String->At, (u32)(Rest.At - String->At));
+        Close[1] = '<';
+        while (Between.FFToStringEnd(Close + 1, CloseSize - 1)) {
+            if (SvgNameEndsAt(&Between) && !SvgSkipStartTag(&Between)) {
+                ++Depth;
+            }
+        }
+        Close[1] = '/';
+
+        Rest.At += CloseSize;
+        if (SvgNameEndsAt(&Rest)) {
+            --Depth;
+        }
+        Rest.FFToAfterChar('>');
+        String->At = Rest.At;
+    }
+}
+
+// note: true when At, right after a '<', starts something other than an element and it was skipped
+internal b32
+SvgSkipMarkup(ls_parser *String)
+{
+    if (String->StartsWith((char *)"!--", 3)) {
+        String->At += 3;
+        String->FFToStringEnd((char *)"-->", 3);
+    } else if (String->StartsWith((char *)"![CDATA[", 8)) {
+        String->FFToStringEnd((char *)"]]>", 3);
+    } else if (String->StartsWith((char *)"?", 1)) {
+        String->FFToStringEnd((char *)"?>", 2);
+    } else if (String->StartsWith((char *)"!", 1)) {
+        // note: DOCTYPE and the like, with an internal subset in brackets that can hold '>'
+        if (SvgFFToAny(String, (char *)"[>") && *String->At == '[') {
+            String->FFToAfterChar(']');
+        }
+        String->FFToAfterChar('>');
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+inline b32
+SvgIsSkipped(ls_string Name, char **Skipped)
+{
+    for (char **S = Skipped; *S; ++S) {
+        if (Name == *S) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// note: parses the tags of Data into Svg, which holds the inherited style and the arrays to append to
+internal void
+SvgParseInto(svg *Svg, u8 *Data, u32 Size, char **Skipped)
+{
+    Skipped = Skipped ? Skipped : SvgDefaultSkippedElements;
 
     svg_parsing_mode_ Mode = SvgParsingMode_Tag;
     ls_parser String((char *)Data, Size);
-    ls_string TagName;
+    svg_tag Tag = {};
 
     token Token;
 
     while (String.RemainingBytes()) {
 
         if (Mode == SvgParsingMode_Tag) {
-            Token = String.GetToken();
-
-            // expecting tag
-            assert(Token.Type == Token_LessThan);
-
-            token Next = String.PeekToken();
-
-            b32 ClosingTag = false;
+            // note: whitespace and text content up to the next tag, or the end
+            if (!String.FFToChar('<')) {
+                break;
+            }
+            char *Start = String.At++;
 
-            if (Next.Type == Token_ForwardSlash) {
-                String.GetToken();
-                ClosingTag = true;
+            if (SvgSkipMarkup(&String)) {
+                continue;
             }
 
-            if (!ClosingTag) {
-                Mode = SvgParsingMode_Tag;
+            b32 ClosingTag = String.RemainingBytes() && *String.At == '/';
 
-                Token = String.GetToken();
-                TagName = Token.Text;
+            if (!ClosingTag) {
+                ls_string Name = SvgParseName(&String, String.GetToken());
 
-                if (TagName == "svg") {
-                    //
-                } else if (TagName == "path") {
-                    //
+                if (SvgIsSkipped(Name, Skipped)) {
+                    LS_SVG_LOG("<%.*s> skipped\n", Name.Size, Name.Data);
+                    SvgSkipElement(&String, Name);
+                    continue;
                 }
 
-                printf("<%.*s>\n", TagName.Size, TagName.Data);
+                Tag = {};
+                Tag.Name = Name;
+                Tag.Markup.Data = Start;
+                Tag.FirstElement = Svg->Elements.Count;
+                Tag.FillRule = Svg->FillRule;
+                Tag.Fill = Svg->Fill;
+                Tag.Stroke = Svg->Stroke;
+                Tag.StrokeStyle = Svg->StrokeStyle;
+
+                LS_SVG_LOG("<%.*s>\n", Tag.Name.Size, Tag.Name.Data);
 
                 Mode = SvgParsingMode_Props;
             } else {
-                String.RequireToken(Token_Identifier);
-                String.RequireToken(Token_GreaterThan);
+                String.FFToAfterChar('>');
             }
         } else if (Mode == SvgParsingMode_Props) {
             Token = String.GetToken();
 
             if (Token.Type == Token_Identifier) {
-                printf("    %.*s\n", Token.Text.Size, Token.Text.Data);
+                ls_string Prop = SvgParseName(&String, Token);
 
-                String.RequireToken(Token_Equals);
+                LS_SVG_LOG("    %.*s\n", Prop.Size, Prop.Data);
 
-                ls_string Prop = Token.Text;
+                String.RequireToken(Token_Equals);
 
                 Token = String.GetToken();
                 assert(Token.Type == Token_String);
 
-                SvgParseProperty(&Svg, TagName, Prop, Token.Text);
+                SvgParseProperty(Svg, &Tag, Prop, Token.Text);
             } else {
                 if (Token.Type == Token_ForwardSlash) {
                     // non-paired tag
@@ -546,12 +1974,138 @@ SvgParse(u8 *Data, u32 Size)
                 }
 
                 assert(Token.Type == Token_GreaterThan);
+                Tag.Markup.Size = (u32)(String.At - Tag.Markup.Data);
+                SvgEndTag(Svg, &Tag);
                 Mode = SvgParsingMode_Tag;
             }
         }
     }
+}
+
+internal svg
+SvgParseDocument(u8 *Data, u32 Size, svg_allocator *Allocator, char **Skipped, b32 Lazy)
+{
+    LS_SVG_ZONE("SvgParse");
+
+    SvgInitCommandMap();
+
+    svg Svg = {};
+    Svg.Lazy = Lazy;
+    Svg.Elements.Allocator = Allocator;
+    Svg.Dashes.Allocator = Allocator;
+    Svg.FillRule = SvgFillRule_NonZero;
+    Svg.Fill = 0x000000ff;
+    Svg.Stroke = 0;
+    Svg.StrokeStyle = {1.0f, SvgLineJoin_Miter, SvgLineCap_Butt, 4.0f, 0, 0, 0.0f};
+
+    SvgParseInto(&Svg, Data, Size, Skipped);
+
+    if (Lazy && Svg.Elements.Count) {
+        size_t StatesSize = Svg.Elements.Count * sizeof(std::atomic<u32>);
+        Svg.PathStates = (std::atomic<u32> *)SvgAllocate(Allocator, StatesSize);
+        for (u32 i=0; i<Svg.Elements.Count; ++i) {
+            new (Svg.PathStates + i) std::atomic<u32>(SvgPathState_Undecoded);
+        }
+    }
 
     return Svg;
 }
 
+/*  Every array of the result allocates from Allocator, 0 for malloc. SvgFree releases it.
+
+    Text content, comments, CDATA, processing instructions (the <?xml prolog) and DOCTYPE are
+    skipped. So are the elements of Skipped with what they contain, a list ending in 0, with 0 for
+    SvgDefaultSkippedElements. */
+svg
+SvgParse(u8 *Data, u32 Size, svg_allocator *Allocator = 0, char **Skipped = 0)
+{
+    return SvgParseDocument(Data, Size, Allocator, Skipped, false);
+}
+
+/*  Like SvgParse, but paths only record their d attribute, which costs no more than scanning the
+    tags. SvgElementPath decodes a path the first time it is asked for, the rasterizers, hit testing
+    and the other consumers in these headers go through it. SvgDecodeAll decodes them all before
+    handing the document to code that reads element paths directly.
+
+    The text has to stay around until every path that will be used is decoded. Decoding can happen
+    on any thread, Allocator then has to be safe to use from all of them. */
+svg
+SvgParseLazy(u8 *Data, u32 Size, svg_allocator *Allocator = 0, char **Skipped = 0)
+{
+    return SvgParseDocument(Data, Size, Allocator, Skipped, true);
+}
+
+// note: the path of E decoded, exactly once however many threads ask at the same time
+svg_path *
+SvgElementPath(svg *Svg, svg_element *E)
+{
+    if (!Svg->Lazy || E->Type != SvgElement_Path) {
+        return &E->Path;
+    }
+
+    std::atomic<u32> *State = Svg->PathStates + (E - Svg->Elements.Data);
+    if (State->load(std::memory_order_acquire) == SvgPathState_Decoded) {
+        return &E->Path;
+    }
+
+    u32 Expected = SvgPathState_Undecoded;
+    if (State->compare_exchange_strong(Expected, SvgPathState_Decoding, std::memory_order_acquire)) {
+        LS_SVG_ZONE("SvgParsePath");
+        SvgParsePathCommands(E->Source, &E->Path);
+        State->store(SvgPathState_Decoded, std::memory_order_release);
+    } else {
+        // note: another thread is decoding it, paths take microseconds so waiting beats a lock
+        while (State->load(std::memory_order_acquire) != SvgPathState_Decoded) {
+            std::this_thread::yield();
+        }
+    }
+
+    return &E->Path;
+}
+
+void
+SvgDecodeAll(svg *Svg)
+{
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        SvgElementPath(Svg, Svg->Elements.Data + i);
+    }
+}
+
+// note: the first element with the id, 0 without one
+svg_element *
+SvgFindElement(svg *Svg, char *Id)
+{
+    u32 Size = ls_string_Strlen(Id);
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Id.Data && E->Id.EqualTo(Id, Size)) {
+            return E;
+        }
+    }
+
+    return 0;
+}
+
+// note: frees the arrays of an svg through their own allocators
+void
+SvgFree(svg *Svg)
+{
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Type == SvgElement_Path) {
+            E->Path.Segments.Free();
+            E->Path.Subpaths.Free();
+        }
+    }
+
+    if (Svg->PathStates) {
+        SvgDeallocate(Svg->Elements.Allocator, Svg->PathStates, Svg->Elements.Count * sizeof(std::atomic<u32>));
+        Svg->PathStates = 0;
+    }
+
+    Svg->Elements.Free();
+    Svg->Dashes.Free();
+}
+
 #endif // INCLUDE_GUARD_LS_SVG
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef INCLUDE_GUARD_LS_SVG_ALLOC
+#define INCLUDE_GUARD_LS_SVG_ALLOC
+
+/*  Allocation accounting for one document.
+
+    A counting allocator sits in front of another svg_allocator (malloc when there is none) and
+    counts allocations, current and peak bytes. Give &Counting.Allocator to SvgParse and the numbers
+    cover everything the parse output holds, SvgMemoryReport adds the bytes per segment.
+
+    With a Budget the allocator notes when the document went past it, the allocation still succeeds
+    since the arrays have no way to fail. A service checks OverBudget after parsing (or after each
+    step that grows the document) and drops the request. One per document, it isn't thread safe. */
+
+struct svg_counting_allocator {
+    svg_allocator Allocator; // the one to hand out
+    svg_allocator *Parent; // where the memory comes from, 0 for malloc
+
+    u64 Allocations; // Alloc and Realloc calls
+    u64 Frees;
+    size_t Bytes; // held right now
+    size_t PeakBytes;
+
+    size_t Budget; // 0 for none
+    b32 OverBudget; // Bytes went past Budget at some point
+};
+
+struct svg_memory_report {
+    u64 Allocations;
+    size_t Bytes;
+    size_t PeakBytes;
+    u32 Segments;
+    r64 BytesPerSegment; // of the peak, 0 without segments
+};
+
+internal void
+SvgCountingAdd(svg_counting_allocator *C, size_t OldSize, size_t Size)
+{
+    C->Allocations++;
+    C->Bytes += Size - OldSize;
+    C->PeakBytes = (C->Bytes > C->PeakBytes) ? C->Bytes : C->PeakBytes;
+    C->OverBudget = C->OverBudget || (C->Budget && C->Bytes > C->Budget);
+}
+
+internal void *
+SvgCountingAlloc(void *Data, size_t Size)
+{
+    svg_counting_allocator *C = (svg_counting_allocator *)Data;
+    SvgCountingAdd(C, 0, Size);
+    return SvgAllocate(C->Parent, Size);
+}
+
+internal void *
+SvgCountingRealloc(void *Data, void *Memory, size_t OldSize, size_t Size)
+{
+    svg_counting_allocator *C = (svg_counting_allocator *)Data;
+    SvgCountingAdd(C, OldSize, Size);
+    return SvgReallocate(C->Parent, Memory, OldSize, Size);
+}
+
+internal void
+SvgCountingFree(void *Data, void *Memory, size_t Size)
+{
+    svg_counting_allocator *C = (svg_counting_allocator *)Data;
+    C->Frees++;
+    C->Bytes -= Size;
+    SvgDeallocate(C->Parent, Memory, Size);
+}
+
+// note: Budget in bytes, 0 for none. Parent 0 allocates with malloc
+void
+SvgCountingAllocatorInit(svg_counting_allocator *C, size_t Budget, svg_allocator *Parent)
+{
+    *C = {};
+    C->Allocator = {C, SvgCountingAlloc, SvgCountingRealloc, SvgCountingFree};
+    C->Parent = Parent;
+    C->Budget = Budget;
+}
+
+// note: the counts so far with the segments of Svg, usually right after parsing it
+svg_memory_report
+SvgMemoryReport(svg_counting_allocator *C, svg *Svg)
+{
+    svg_memory_report Report = {};
+    Report.Allocations = C->Allocations;
+    Report.Bytes = C->Bytes;
+    Report.PeakBytes = C->PeakBytes;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (E->Type == SvgElement_Path) {
+            Report.Segments += E->Path.Segments.Count;
+        }
+    }
+
+    Report.BytesPerSegment = Report.Segments ? (r64)Report.PeakBytes / Report.Segments : 0.0;
+
+    return Report;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_ALLOC
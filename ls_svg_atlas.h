@@ -0,0 +1,338 @@
+#ifndef INCLUDE_GUARD_LS_SVG_ATLAS
+#define INCLUDE_GUARD_LS_SVG_ATLAS
+
+/*  Icon atlas baker.
+
+    Every icon is rendered at every requested size into a square cell, the cells are packed into
+    square pages with a bottom-left skyline packer. Icons are framed by the bounds of their content,
+    scaled uniformly and centered in the cell. Padding transparent pixels around each cell keep
+    bilinear sampling from bleeding into the neighbours.
+
+    The layout is computed on one thread in a fixed order (larger sizes first, then icon order), so
+    the same input always produces the same atlas. Rendering then runs in parallel, each cell only
+    writes its own pixels. */
+
+#define SVG_ATLAS_MISSING 0xffffffff
+
+// note: svg_array counts in u32 and grows by doubling, which wraps above 2 GB
+#define SVG_ATLAS_MAX_BYTES 0x7fffffffull
+
+// note: one per icon and size, Page is SVG_ATLAS_MISSING if the cell is larger than a page
+struct svg_atlas_entry {
+    u32 Page;
+    u32 X;
+    u32 Y;
+    u32 Size;
+
+    // note: texture coordinates of the cell without padding
+    r32 U0;
+    r32 V0;
+    r32 U1;
+    r32 V1;
+};
+
+struct svg_skyline_node {
+    u32 X;
+    u32 Y;
+    u32 Width;
+};
+
+// note: scratch memory and output, keep it around between calls
+struct svg_atlas {
+    svg_array<svg_atlas_entry> Entries; // Icon * SizeCount + SizeIndex
+    svg_array<u8> Pixels;               // premultiplied RGBA8, pages one after another
+    u32 PageCount;
+    u32 PageSize;
+
+    svg_array<svg_array<svg_skyline_node>> Skylines; // one per page, only grows so nodes get reused
+    svg_array<u32> Order;
+    svg_rasterizer Rasterizers[SVG_MAX_WORKERS];
+
+    svg **Icons;
+    u32 SizeCount;
+};
+
+inline svg_atlas_entry *
+SvgAtlasEntry(svg_atlas *Atlas, u32 Icon, u32 SizeIndex)
+{
+    return Atlas->Entries.Data + Icon * Atlas->SizeCount + SizeIndex;
+}
+
+inline svg_image
+SvgAtlasPage(svg_atlas *Atlas, u32 Page)
+{
+    svg_image Result = {};
+    Result.Width = Atlas->PageSize;
+    Result.Height = Atlas->PageSize;
+    Result.Pitch = Atlas->PageSize * 4;
+    Result.Pixels = Atlas->Pixels.Data + (size_t)Page * Result.Pitch * Atlas->PageSize;
+    return Result;
+}
+
+// note: lowest y at which a Width x Height rectangle fits with its left edge on node Index
+internal b32
+SvgSkylineFit(svg_array<svg_skyline_node> *Skyline, u32 Index, u32 Width, u32 Height, u32 PageSize, u32 *Y)
+{
+    svg_skyline_node *Nodes = Skyline->Data;
+    if (Nodes[Index].X + Width > PageSize) {
+        return false;
+    }
+
+    // note: the nodes always span the whole page, so this stays inside the array
+    u32 Top = 0;
+    u32 Left = Width;
+
+    for (u32 i=Index; Left > 0; ++i) {
+        Top = (Nodes[i].Y > Top) ? Nodes[i].Y : Top;
+        if (Top + Height > PageSize) {
+            return false;
+        }
+        Left -= (Nodes[i].Width < Left) ? Nodes[i].Width : Left;
+    }
+
+    *Y = Top;
+    return true;
+}
+
+internal void
+SvgSkylineInsert(svg_array<svg_skyline_node> *Skyline, u32 Index, u32 X, u32 Y, u32 Width, u32 Height)
+{
+    Skyline->FitN(1);
+    svg_skyline_node *Nodes = Skyline->Data;
+
+    memmove(Nodes + Index + 1, Nodes + Index, (Skyline->Count - Index) * sizeof(svg_skyline_node));
+    Nodes[Index] = {X, Y + Height, Width};
+    Skyline->Count++;
+
+    // the new node shadows the ones below it, drop or shorten them
+    u32 End = X + Width;
+    u32 i = Index + 1;
+
+    while (i < Skyline->Count && Nodes[i].X < End) {
+        u32 Shrink = End - Nodes[i].X;
+        if (Nodes[i].Width > Shrink) {
+            Nodes[i].X += Shrink;
+            Nodes[i].Width -= Shrink;
+            break;
+        }
+
+        memmove(Nodes + i, Nodes + i + 1, (Skyline->Count - i - 1) * sizeof(svg_skyline_node));
+        Skyline->Count--;
+    }
+
+    for (u32 j=0; j + 1 < Skyline->Count; ) {
+        if (Nodes[j].Y == Nodes[j + 1].Y) {
+            Nodes[j].Width += Nodes[j + 1].Width;
+            memmove(Nodes + j + 1, Nodes + j + 2, (Skyline->Count - j - 2) * sizeof(svg_skyline_node));
+            Skyline->Count--;
+        } else {
+            ++j;
+        }
+    }
+}
+
+// note: first page that has room, bottom-left position within it (lowest top, then leftmost)
+internal b32
+SvgAtlasPlace(svg_atlas *Atlas, u32 Width, u32 Height, u32 *Page, u32 *X, u32 *Y)
+{
+    u32 PageSize = Atlas->PageSize;
+    if (Width > PageSize || Height > PageSize) {
+        return false;
+    }
+
+    for (u32 p=0; ; ++p) {
+        if (p == Atlas->PageCount) {
+            if (Atlas->PageCount == Atlas->Skylines.Count) {
+                Atlas->Skylines.Push({});
+            }
+
+            svg_array<svg_skyline_node> *Skyline = Atlas->Skylines.Data + Atlas->PageCount++;
+            Skyline->Count = 0;
+            Skyline->Push({0, 0, PageSize});
+        }
+
+        svg_array<svg_skyline_node> *Skyline = Atlas->Skylines.Data + p;
+        u32 BestIndex = SVG_ATLAS_MISSING;
+        u32 BestTop = 0;
+        u32 BestY = 0;
+
+        for (u32 i=0; i<Skyline->Count; ++i) {
+            u32 NodeY;
+            if (SvgSkylineFit(Skyline, i, Width, Height, PageSize, &NodeY) &&
+                (BestIndex == SVG_ATLAS_MISSING || NodeY + Height < BestTop)) {
+                BestIndex = i;
+                BestTop = NodeY + Height;
+                BestY = NodeY;
+            }
+        }
+
+        if (BestIndex != SVG_ATLAS_MISSING) {
+            *Page = p;
+            *X = Skyline->Data[BestIndex].X;
+            *Y = BestY;
+            SvgSkylineInsert(Skyline, BestIndex, *X, BestY, Width, Height);
+            return true;
+        }
+    }
+}
+
+internal void
+SvgAtlasJob(void *Data, u32 Index, u32 Worker)
+{
+    svg_atlas *Atlas = (svg_atlas *)Data;
+    u32 EntryIndex = Atlas->Order.Data[Index];
+    svg_atlas_entry *Entry = Atlas->Entries.Data + EntryIndex;
+    svg *Svg = Atlas->Icons[EntryIndex / Atlas->SizeCount];
+
+    if (Entry->Page == SVG_ATLAS_MISSING) {
+        return;
+    }
+
+    b32 Empty = true;
+    svg_bounds Bounds = {};
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        svg_path *Path = SvgElementPath(Svg, E);
+        if (E->Type == SvgElement_Path && Path->Segments.Count) {
+            Bounds = Empty ? Path->Bounds : SvgBoundsUnion(Bounds, Path->Bounds);
+            Empty = false;
+        }
+    }
+
+    if (Empty) {
+        return;
+    }
+
+    r32 Width = Bounds.Max.x - Bounds.Min.x;
+    r32 Height = Bounds.Max.y - Bounds.Min.y;
+    r32 Extent = SvgMax(Width, Height);
+    r32 Scale = (Extent > 0.0f) ? Entry->Size / Extent : 1.0f;
+
+    svg_transform T = SvgScaleTransform(Scale);
+    T.e = 0.5f * (Entry->Size - Width * Scale) - Bounds.Min.x * Scale;
+    T.f = 0.5f * (Entry->Size - Height * Scale) - Bounds.Min.y * Scale;
+
+    // note: the cell is a window into the page, the rasterizer clips to it
+    svg_image Page = SvgAtlasPage(Atlas, Entry->Page);
+    svg_image Cell = {};
+    Cell.Width = Entry->Size;
+    Cell.Height = Entry->Size;
+    Cell.Pitch = Page.Pitch;
+    Cell.Pixels = Page.Pixels + Entry->Y * Page.Pitch + Entry->X * 4;
+
+    SvgRasterize(Atlas->Rasterizers + Worker, Svg, &Cell, T);
+}
+
+/*  Renders every icon at every size. Sizes may be given in any order and PageSize is the width and
+    height of a page. The result is in Atlas->Pixels (PageCount pages), Atlas->Entries is the UV table,
+    look entries up with SvgAtlasEntry. Pool may be null.
+
+    False, with an empty atlas, when the pages would take more than SVG_ATLAS_MAX_BYTES. */
+b32
+SvgBakeAtlas(svg_atlas *Atlas, svg **Icons, u32 IconCount, u32 *Sizes, u32 SizeCount,
+             u32 PageSize, u32 Padding, svg_job_pool *Pool)
+{
+    Atlas->Icons = Icons;
+    Atlas->SizeCount = SizeCount;
+    Atlas->PageSize = PageSize;
+    Atlas->PageCount = 0;
+
+    u32 EntryCount = IconCount * SizeCount;
+    Atlas->Entries.Count = 0;
+    Atlas->Order.Count = 0;
+    Atlas->Pixels.Count = 0;
+
+    size_t PageBytes = (size_t)PageSize * PageSize * 4;
+    if (PageBytes > SVG_ATLAS_MAX_BYTES) {
+        return false;
+    }
+
+    if (!EntryCount) {
+        return true;
+    }
+
+    Atlas->Entries.AllocN(EntryCount);
+    Atlas->Order.AllocN(EntryCount);
+
+    // layout order: sizes from large to small, icons in order, ties keep the order they were given in
+    u32 *Order = Atlas->Order.Data;
+    u32 OrderCount = 0;
+    u32 Previous = 0xffffffff;
+
+    for (u32 Pass=0; Pass<SizeCount; ++Pass) {
+        u32 Largest = 0;
+        for (u32 s=0; s<SizeCount; ++s) {
+            if (Sizes[s] < Previous && Sizes[s] > Largest) {
+                Largest = Sizes[s];
+            }
+        }
+
+        if (!Largest) {
+            break;
+        }
+
+        for (u32 s=0; s<SizeCount; ++s) {
+            if (Sizes[s] != Largest) {
+                continue;
+            }
+            for (u32 i=0; i<IconCount; ++i) {
+                Order[OrderCount++] = i * SizeCount + s;
+            }
+        }
+
+        Previous = Largest;
+    }
+
+    // note: zero sizes never make it into the order
+    for (u32 s=0; s<SizeCount; ++s) {
+        if (!Sizes[s]) {
+            for (u32 i=0; i<IconCount; ++i) {
+                Atlas->Entries.Data[i * SizeCount + s] = {SVG_ATLAS_MISSING};
+            }
+        }
+    }
+
+    r32 InvPage = 1.0f / PageSize;
+
+    for (u32 o=0; o<OrderCount; ++o) {
+        u32 Index = Order[o];
+        svg_atlas_entry *Entry = Atlas->Entries.Data + Index;
+        u32 Size = Sizes[Index % SizeCount];
+        u32 Cell = Size + 2 * Padding;
+
+        u32 Page, X, Y;
+        if (!SvgAtlasPlace(Atlas, Cell, Cell, &Page, &X, &Y)) {
+            *Entry = {SVG_ATLAS_MISSING};
+            Entry->Size = Size;
+            continue;
+        }
+
+        Entry->Page = Page;
+        Entry->X = X + Padding;
+        Entry->Y = Y + Padding;
+        Entry->Size = Size;
+        Entry->U0 = Entry->X * InvPage;
+        Entry->V0 = Entry->Y * InvPage;
+        Entry->U1 = (Entry->X + Size) * InvPage;
+        Entry->V1 = (Entry->Y + Size) * InvPage;
+    }
+
+    size_t Bytes = PageBytes * Atlas->PageCount;
+    if (Bytes > SVG_ATLAS_MAX_BYTES) {
+        Atlas->Entries.Count = 0;
+        Atlas->Order.Count = 0;
+        Atlas->PageCount = 0;
+        return false;
+    }
+
+    if (Bytes) {
+        Atlas->Pixels.AllocN((u32)Bytes);
+        memset(Atlas->Pixels.Data, 0, Bytes);
+    }
+
+    SvgParallelFor(Pool, OrderCount, SvgAtlasJob, Atlas);
+    return true;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_ATLAS
@@ -0,0 +1,395 @@
+#ifndef INCLUDE_GUARD_LS_SVG_DEDUP
+#define INCLUDE_GUARD_LS_SVG_DEDUP
+
+/*  Hash-consing of repeated geometry.
+
+    SvgDedupSvg hashes the segment stream of every path (or of every contour with Subpaths) and
+    finds each distinct one once as a shape, elements become instances: a shape plus the offset
+    it is drawn at. With Translate the stream is taken relative to its first point, so copies of
+    an arrowhead anywhere in the document share one shape, without it only exact copies do. The
+    contours are part of what is compared, where each one starts and whether it is closed.
+
+    Coordinates compare exactly when Tolerance is 0. Copies that were placed with relative path
+    commands differ in the last bits after subtracting the offset, a Tolerance snaps them to a grid
+    of that size for comparison.
+
+    A shape doesn't copy its geometry, it is the part of its first instance's path that it covers
+    and shape space is that path's space. SvgShapePath gives the view of it. The svg itself isn't
+    changed, SvgDedupRelease frees the paths the shapes don't need when the instances are all that
+    is drawn from then on. Caches keyed by shape (flattened polylines, rasters at a given scale)
+    are shared by all instances, which only differ by a translation. */
+
+#define SVG_DEDUP_NONE 0xffffffff
+
+struct svg_shape {
+    u32 Element; // the first instance, its path holds the geometry
+    u32 FirstSegment; // of that path
+    u32 SegmentCount;
+    svg_subpath Contour; // the subpath list of a contour shape, one subpath starting at 0
+    u32 Hash;
+    u32 Uses;
+};
+
+struct svg_instance {
+    u32 Shape;
+    svg_v2 Offset; // shape space to path space
+};
+
+struct svg_dedup {
+    r32 Tolerance;
+    b32 Translate;
+    b32 Subpaths;
+
+    svg_array<svg_shape> Shapes;
+    svg_array<svg_instance> Instances;
+    svg_array<u32> ElementInstances; // instances of element i are [ElementInstances[i], ElementInstances[i + 1])
+
+    u32 *Slots; // open addressing table of shape indices, SVG_DEDUP_NONE for empty
+    u32 SlotCount;
+};
+
+void
+SvgDedupInit(svg_dedup *D, r32 Tolerance, b32 Translate, b32 Subpaths)
+{
+    *D = {};
+    D->Tolerance = Tolerance;
+    D->Translate = Translate;
+    D->Subpaths = Subpaths;
+}
+
+// note: the value a coordinate is compared by, its bits or its grid cell
+inline u32
+SvgDedupKey(svg_dedup *D, r32 Value)
+{
+    if (D->Tolerance > 0.0f) {
+        return (u32)(s32)floorf(Value / D->Tolerance + 0.5f);
+    }
+
+    u32 Bits;
+    Value = (Value == 0.0f) ? 0.0f : Value; // -0 and 0 are the same coordinate
+    memcpy(&Bits, &Value, sizeof(Bits));
+    return Bits;
+}
+
+// note: keys of the fields a segment type uses, at most 9, Origin is subtracted from the points
+internal u32
+SvgDedupKeys(svg_dedup *D, svg_path_segement *S, svg_v2 Origin, u32 *Keys)
+{
+    u32 Count = 0;
+    svg_v2 Points[3] = {S->P1 - Origin, S->P2 - Origin};
+    u32 PointCount = 2;
+
+    if (S->Type == SvgSegment_QuadraticBezier) {
+        Points[PointCount++] = S->C1 - Origin;
+    } else if (S->Type == SvgSegment_CubicBezier) {
+        Points[PointCount++] = S->C1 - Origin;
+        Keys[Count++] = SvgDedupKey(D, S->C2.x - Origin.x);
+        Keys[Count++] = SvgDedupKey(D, S->C2.y - Origin.y);
+    } else if (S->Type == SvgSegment_Elliptical) {
+        Keys[Count++] = SvgDedupKey(D, S->Rx);
+        Keys[Count++] = SvgDedupKey(D, S->Ry);
+        Keys[Count++] = SvgDedupKey(D, S->Angle);
+        Keys[Count++] = (S->UseLargeArc ? 1 : 0) | (S->Clockwise ? 2 : 0);
+    }
+
+    for (u32 i=0; i<PointCount; ++i) {
+        Keys[Count++] = SvgDedupKey(D, Points[i].x);
+        Keys[Count++] = SvgDedupKey(D, Points[i].y);
+    }
+
+    Keys[Count++] = S->Type;
+
+    return Count;
+}
+
+// note: where a run of segments is matched from, its first point with Translate
+inline svg_v2
+SvgDedupOrigin(svg_dedup *D, svg_path *Run)
+{
+    return D->Translate ? Run->Segments.Data[0].P1 : svg_v2{0.0f, 0.0f};
+}
+
+internal u32
+SvgDedupHash(svg_dedup *D, svg_path *Run, svg_v2 Origin)
+{
+    u64 Hash = 0xcbf29ce484222325ull;
+
+    u32 At = 0;
+    svg_contour Contour;
+    while (SvgNextContour(Run, &At, &Contour)) {
+        Hash = (Hash ^ (Contour.Count * 2 + (Contour.Closed ? 1 : 0))) * 0x100000001b3ull;
+
+        for (u32 i=0; i<Contour.Count; ++i) {
+            u32 Keys[9];
+            u32 KeyCount = SvgDedupKeys(D, Contour.Segments + i, Origin, Keys);
+
+            for (u32 k=0; k<KeyCount; ++k) {
+                Hash = (Hash ^ Keys[k]) * 0x100000001b3ull;
+            }
+        }
+    }
+
+    // note: fold the high bits down, the table index uses the low ones
+    return (u32)(Hash ^ (Hash >> 32));
+}
+
+// note: same contours, same closed flags and the same keys for every segment
+internal b32
+SvgDedupMatch(svg_dedup *D, svg_path *A, svg_v2 OriginA, svg_path *B, svg_v2 OriginB)
+{
+    if (A->Segments.Count != B->Segments.Count) {
+        return false;
+    }
+
+    u32 AtA = 0;
+    u32 AtB = 0;
+    svg_contour ContourA;
+    svg_contour ContourB;
+
+    while (SvgNextContour(A, &AtA, &ContourA)) {
+        if (!SvgNextContour(B, &AtB, &ContourB) || ContourA.Count != ContourB.Count ||
+            ContourA.Closed != ContourB.Closed)
+        {
+            return false;
+        }
+
+        for (u32 i=0; i<ContourA.Count; ++i) {
+            u32 KeysA[9];
+            u32 KeysB[9];
+            u32 CountA = SvgDedupKeys(D, ContourA.Segments + i, OriginA, KeysA);
+            u32 CountB = SvgDedupKeys(D, ContourB.Segments + i, OriginB, KeysB);
+
+            if (CountA != CountB || memcmp(KeysA, KeysB, CountA * sizeof(u32))) {
+                return false;
+            }
+        }
+    }
+
+    return !SvgNextContour(B, &AtB, &ContourB);
+}
+
+// note: a table with room for twice the shapes, rebuilt from their hashes
+internal void
+SvgDedupGrow(svg_dedup *D)
+{
+    u32 SlotCount = 1024;
+    while (SlotCount < (D->Shapes.Count + 1) * 2) {
+        SlotCount *= 2;
+    }
+
+    u32 *Slots = (u32 *)malloc(SlotCount * sizeof(u32));
+    memset(Slots, 0xff, SlotCount * sizeof(u32));
+
+    for (u32 i=0; i<D->Shapes.Count; ++i) {
+        u32 Slot = D->Shapes.Data[i].Hash & (SlotCount - 1);
+        while (Slots[Slot] != SVG_DEDUP_NONE) {
+            Slot = (Slot + 1) & (SlotCount - 1);
+        }
+        Slots[Slot] = i;
+    }
+
+    free(D->Slots);
+    D->Slots = Slots;
+    D->SlotCount = SlotCount;
+}
+
+// note: the segments and subpaths of a shape, SvgShapePath without the bounds
+internal svg_path
+SvgDedupView(svg_dedup *D, svg *Svg, u32 Shape)
+{
+    svg_shape *S = D->Shapes.Data + Shape;
+    svg_path *Path = SvgElementPath(Svg, Svg->Elements.Data + S->Element);
+
+    svg_path Result = {};
+    Result.Segments.Data = Path->Segments.Data + S->FirstSegment;
+    Result.Segments.Count = S->SegmentCount;
+    Result.Segments.Cap = S->SegmentCount;
+
+    if (D->Subpaths) {
+        Result.Subpaths.Data = &S->Contour;
+        Result.Subpaths.Count = 1;
+        Result.Subpaths.Cap = 1;
+    } else {
+        Result.Subpaths = Path->Subpaths;
+        Result.Bounds = Path->Bounds;
+    }
+
+    return Result;
+}
+
+/*  Read-only view of a shape as a path in shape space, for the functions that take an svg_path.
+    It must not be appended to, and is valid as long as the path of the shape's element is. */
+inline svg_path
+SvgShapePath(svg_dedup *D, svg *Svg, u32 Shape)
+{
+    svg_path Result = SvgDedupView(D, Svg, Shape);
+
+    // note: a contour shape has the bounds of its own segments, a path shape those of its path
+    if (D->Subpaths) {
+        for (u32 i=0; i<Result.Segments.Count; ++i) {
+            svg_bounds Bounds = SvgSegmentBounds(Result.Segments.Data + i);
+            Result.Bounds = i ? SvgBoundsUnion(Result.Bounds, Bounds) : Bounds;
+        }
+    }
+
+    return Result;
+}
+
+/*  Shape of Run, a path or one contour of the path of element Element starting at its segment
+    FirstSegment, added if it wasn't seen before. Offset receives the translation from shape space
+    back to the run's own coordinates. */
+u32
+SvgDedupAdd(svg_dedup *D, svg *Svg, u32 Element, u32 FirstSegment, svg_path *Run, svg_v2 *Offset)
+{
+    svg_v2 Origin = SvgDedupOrigin(D, Run);
+    u32 Hash = SvgDedupHash(D, Run, Origin);
+
+    // note: keeps the load under a half so probe runs stay short
+    if ((D->Shapes.Count + 1) * 2 > D->SlotCount) {
+        SvgDedupGrow(D);
+    }
+
+    u32 Slot = Hash & (D->SlotCount - 1);
+    while (D->Slots[Slot] != SVG_DEDUP_NONE) {
+        svg_shape *Shape = D->Shapes.Data + D->Slots[Slot];
+
+        if (Shape->Hash == Hash) {
+            svg_path Stored = SvgDedupView(D, Svg, D->Slots[Slot]);
+            svg_v2 StoredOrigin = SvgDedupOrigin(D, &Stored);
+
+            if (SvgDedupMatch(D, &Stored, StoredOrigin, Run, Origin)) {
+                Shape->Uses++;
+                *Offset = Origin - StoredOrigin;
+                return D->Slots[Slot];
+            }
+        }
+        Slot = (Slot + 1) & (D->SlotCount - 1);
+    }
+
+    svg_shape *Shape = D->Shapes.AllocN(1);
+    Shape->Element = Element;
+    Shape->FirstSegment = FirstSegment;
+    Shape->SegmentCount = Run->Segments.Count;
+    Shape->Contour = {0, D->Subpaths && Run->Subpaths.Count && Run->Subpaths.Data[0].Closed};
+    Shape->Hash = Hash;
+    Shape->Uses = 1;
+    *Offset = {0.0f, 0.0f};
+
+    D->Slots[Slot] = D->Shapes.Count - 1;
+
+    return D->Shapes.Count - 1;
+}
+
+// note: instances for every element, elements without geometry get none
+void
+SvgDedupSvg(svg_dedup *D, svg *Svg)
+{
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        D->ElementInstances.Push(D->Instances.Count);
+
+        svg_path *Path = SvgElementPath(Svg, E);
+        if (E->Type != SvgElement_Path || !Path->Segments.Count) {
+            continue;
+        }
+
+        if (D->Subpaths) {
+            u32 At = 0;
+            svg_contour Contour;
+
+            while (SvgNextContour(Path, &At, &Contour)) {
+                svg_subpath Subpath = {0, Contour.Closed};
+                svg_path Run = {};
+                Run.Segments.Data = Contour.Segments;
+                Run.Segments.Count = Contour.Count;
+                Run.Subpaths.Data = &Subpath;
+                Run.Subpaths.Count = 1;
+
+                svg_instance *Instance = D->Instances.AllocN(1);
+                Instance->Shape = SvgDedupAdd(D, Svg, i, (u32)(Contour.Segments - Path->Segments.Data), &Run,
+                                              &Instance->Offset);
+            }
+        } else {
+            svg_instance *Instance = D->Instances.AllocN(1);
+            Instance->Shape = SvgDedupAdd(D, Svg, i, 0, Path, &Instance->Offset);
+        }
+    }
+
+    D->ElementInstances.Push(D->Instances.Count);
+
+    // note: the table is only needed while shapes are added, SvgDedupAdd builds it again
+    free(D->Slots);
+    D->Slots = 0;
+    D->SlotCount = 0;
+}
+
+// note: true for elements whose path holds the geometry of a shape
+internal b32
+SvgDedupOwner(svg_dedup *D, u32 Element)
+{
+    for (u32 i=D->ElementInstances.Data[Element]; i<D->ElementInstances.Data[Element + 1]; ++i) {
+        if (D->Shapes.Data[D->Instances.Data[i].Shape].Element == Element) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*  Frees the paths of the elements whose every instance is a shape held by another element. Their
+    geometry is only reachable through the instances afterwards, which is what a renderer of the
+    deduplicated document draws. Call it after SvgDedupSvg. */
+void
+SvgDedupRelease(svg_dedup *D, svg *Svg)
+{
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+
+        if (E->Type == SvgElement_Path && !SvgDedupOwner(D, i)) {
+            svg_path *Path = SvgElementPath(Svg, E);
+            Path->Segments.Free();
+            Path->Subpaths.Free();
+        }
+    }
+}
+
+// note: bytes of the geometry once SvgDedupRelease has run, the paths that hold shapes and the instances
+size_t
+SvgDedupSize(svg_dedup *D, svg *Svg)
+{
+    size_t Result = D->Shapes.Count * sizeof(svg_shape) + D->Instances.Count * sizeof(svg_instance) +
+                    D->ElementInstances.Count * sizeof(u32) + D->SlotCount * sizeof(u32);
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+
+        if (E->Type == SvgElement_Path && SvgDedupOwner(D, i)) {
+            svg_path *Path = SvgElementPath(Svg, E);
+            Result += Path->Segments.Count * sizeof(svg_path_segement) + Path->Subpaths.Count * sizeof(svg_subpath);
+        }
+    }
+
+    return Result;
+}
+
+// note: transform that draws an instance with T
+inline svg_transform
+SvgInstanceTransform(svg_transform T, svg_instance *Instance)
+{
+    svg_transform Result = T;
+    Result.e = T.a * Instance->Offset.x + T.c * Instance->Offset.y + T.e;
+    Result.f = T.b * Instance->Offset.x + T.d * Instance->Offset.y + T.f;
+    return Result;
+}
+
+void
+SvgDedupFree(svg_dedup *D)
+{
+    D->Shapes.Free();
+    D->Instances.Free();
+    D->ElementInstances.Free();
+    free(D->Slots);
+    *D = {};
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_DEDUP
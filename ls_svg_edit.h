@@ -0,0 +1,214 @@
+#ifndef INCLUDE_GUARD_LS_SVG_EDIT
+#define INCLUDE_GUARD_LS_SVG_EDIT
+
+/*  Incremental re-parse for editors that change the text of a parsed document.
+
+    Every element remembers the start tag it came from (Markup), its spans point into the text.
+    An edit replaces Removed bytes at Offset of the old text with Inserted bytes. When it stays
+    inside the start tag of one path, without touching its '<' or '>', only that tag is parsed
+    again and the result replaces the element in its slot, so element indices don't change. The
+    spans of the other elements then move to the new text, the ones after the edit by the size
+    difference. With the text edited in place that is only the elements after the edited one.
+
+    Anything else returns false and leaves the document as it was, the caller parses it again:
+    an edit across tags or in text content, one in the <svg> tag whose style the paths inherit,
+    a tag that is no longer a single path afterwards, or one the parser would reject, which is
+    most of the states a tag goes through while someone types. Readers can't run during an edit. */
+
+struct svg_edit {
+    u32 Offset; // in the old text
+    u32 Removed;
+    u32 Inserted;
+};
+
+// note: Span from the old text to the new one, moved by Delta when it starts at or after Edge
+inline void
+SvgMoveSpan(ls_string *Span, u8 *OldData, u8 *Data, size_t Edge, s64 Delta)
+{
+    if (!Span->Data) {
+        return;
+    }
+
+    size_t Offset = (u8 *)Span->Data - OldData;
+    Span->Data = (char *)Data + Offset + ((Offset >= Edge) ? Delta : 0);
+}
+
+// note: true when Tag is a whole start tag, an edit can move its '>' or open a quote that hides it
+internal b32
+SvgIsStartTag(ls_parser Tag)
+{
+    ++Tag.At;
+
+    while (SvgFFToAny(&Tag, (char *)"\"'>")) {
+        char Stop = *Tag.At++;
+
+        if (Stop == '>') {
+            return Tag.RemainingBytes() == 0;
+        }
+
+        if (!Tag.FFToChar(Stop)) {
+            return false;
+        }
+        ++Tag.At;
+    }
+
+    return false;
+}
+
+/*  True when Tag is a path start tag the parser reads without tripping an assert, which a tag
+    someone is typing into often isn't: an attribute name without its value yet, a number cut in
+    half, a command letter without its numbers. It reads the tokens SvgParseInto would. */
+internal b32
+SvgIsPathTag(ls_parser Tag)
+{
+    ++Tag.At;
+
+    token Token = Tag.GetToken();
+    if (Token.Type != Token_Identifier || !(SvgParseName(&Tag, Token) == "path")) {
+        return false;
+    }
+
+    for (;;) {
+        Token = Tag.GetToken();
+
+        if (Token.Type != Token_Identifier) {
+            if (Token.Type == Token_ForwardSlash) {
+                Token = Tag.GetToken();
+            }
+
+            return Token.Type == Token_GreaterThan && !Tag.RemainingBytes();
+        }
+
+        ls_string Prop = SvgParseName(&Tag, Token);
+
+        if (!Tag.RequireToken(Token_Equals)) {
+            return false;
+        }
+
+        Token = Tag.GetToken();
+        if (Token.Type != Token_String) {
+            return false;
+        }
+
+        if (Prop == "d" && !SvgIsPathData(Token.Text)) {
+            return false;
+        }
+
+        if (Prop == "stroke-width" || Prop == "stroke-miterlimit" || Prop == "stroke-dashoffset") {
+            ls_parser Value = Token.Text;
+            token Number = Value.GetToken();
+            if (Number.Type != Token_Real && Number.Type != Token_Integer) {
+                return false;
+            }
+        }
+    }
+}
+
+// note: the last element whose start tag begins at or before Offset, -1 without one
+internal s32
+SvgElementAt(svg *Svg, u8 *OldData, size_t Offset)
+{
+    s32 Low = 0;
+    s32 High = (s32)Svg->Elements.Count - 1;
+    s32 Result = -1;
+
+    while (Low <= High) {
+        s32 Middle = (Low + High) / 2;
+        size_t Start = (u8 *)Svg->Elements.Data[Middle].Markup.Data - OldData;
+
+        if (Start <= Offset) {
+            Result = Middle;
+            Low = Middle + 1;
+        } else {
+            High = Middle - 1;
+        }
+    }
+
+    return Result;
+}
+
+/*  Applies Edit of the text at OldData, which may be gone by now, to Svg. Data and Size are the
+    whole text after the edit, it can be the same buffer. False when the edit needs a full parse. */
+b32
+SvgApplyEdit(svg *Svg, u8 *OldData, u8 *Data, u32 Size, svg_edit Edit)
+{
+    s32 Index = SvgElementAt(Svg, OldData, Edit.Offset);
+    if (Index < 0) {
+        return false;
+    }
+
+    svg_element *E = Svg->Elements.Data + Index;
+    size_t Start = (u8 *)E->Markup.Data - OldData;
+    size_t End = Start + E->Markup.Size;
+
+    if (E->Type != SvgElement_Path || Edit.Offset <= Start || Edit.Offset + Edit.Removed >= End) {
+        return false;
+    }
+
+    s64 Delta = (s64)Edit.Inserted - (s64)Edit.Removed;
+    size_t NewEnd = End + Delta;
+    if (NewEnd > Size) {
+        return false;
+    }
+
+    ls_parser Tag((char *)Data + Start, (u32)(NewEnd - Start));
+    if (!SvgIsStartTag(Tag) || !SvgIsPathTag(Tag)) {
+        return false;
+    }
+
+    svg Scratch = {};
+    Scratch.Lazy = Svg->Lazy;
+    Scratch.Elements.Allocator = Svg->Elements.Allocator;
+    Scratch.Dashes.Allocator = Svg->Dashes.Allocator;
+    Scratch.FillRule = Svg->FillRule;
+    Scratch.Fill = Svg->Fill;
+    Scratch.Stroke = Svg->Stroke;
+    Scratch.StrokeStyle = Svg->StrokeStyle;
+
+    SvgInitCommandMap();
+    SvgParseInto(&Scratch, Data + Start, (u32)(NewEnd - Start), 0);
+
+    if (Scratch.Elements.Count != 1 || Scratch.Elements.Data[0].Type != SvgElement_Path) {
+        SvgFree(&Scratch);
+        return false;
+    }
+
+    // note: only a dasharray of the tag itself is in Scratch, an inherited one already indexes Svg.
+    // The old dashes stay in the array unused until the next full parse
+    svg_element *Parsed = Scratch.Elements.Data;
+    if (Scratch.Dashes.Count) {
+        Parsed->StrokeStyle.DashFirst += Svg->Dashes.Count;
+        for (u32 i=0; i<Scratch.Dashes.Count; ++i) {
+            Svg->Dashes.Push(Scratch.Dashes.Data[i]);
+        }
+    }
+
+    E->Path.Segments.Free();
+    E->Path.Subpaths.Free();
+    *E = *Parsed;
+
+    if (Svg->PathStates) {
+        Svg->PathStates[Index].store(SvgPathState_Undecoded, std::memory_order_release);
+    }
+
+    Scratch.Elements.Free();
+    Scratch.Dashes.Free();
+
+    size_t Edge = Edit.Offset + Edit.Removed;
+    u32 First = (OldData == Data) ? (u32)Index + 1 : 0;
+
+    for (u32 i=First; i<Svg->Elements.Count; ++i) {
+        if (i == (u32)Index) {
+            continue;
+        }
+
+        svg_element *Other = Svg->Elements.Data + i;
+        SvgMoveSpan(&Other->Id, OldData, Data, Edge, Delta);
+        SvgMoveSpan(&Other->Source, OldData, Data, Edge, Delta);
+        SvgMoveSpan(&Other->Markup, OldData, Data, Edge, Delta);
+    }
+
+    return true;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_EDIT
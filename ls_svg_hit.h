@@ -0,0 +1,401 @@
+#ifndef INCLUDE_GUARD_LS_SVG_HIT
+#define INCLUDE_GUARD_LS_SVG_HIT
+
+/*  Point picking against parsed geometry.
+
+    Winding numbers are computed by casting a ray from the point towards +x. Every curve is split
+    into y-monotone pieces and each piece that straddles the ray contributes +1 or -1 if it crosses
+    it to the right of the point. Crossings are found by solving the curve polynomial directly, no
+    flattening. Pieces are tested half-open on y, so shared end points are counted exactly once. */
+
+inline r64
+SvgPolyAt(r64 *C, u32 Degree, r64 t)
+{
+    r64 Result = C[Degree];
+    for (s32 i=Degree - 1; i>=0; --i) {
+        Result = Result * t + C[i];
+    }
+    return Result;
+}
+
+/*  Crossings of the horizontal line y = Py with a curve given by power basis coefficients, X[0] and
+    Y[0] are the constant terms. The curve is split into y-monotone pieces, each piece is tested
+    half-open and reports the direction it crosses in (+1 towards +y). Positions are only solved for
+    when NeedX is set, counting directions is enough to get the winding of points left of the curve.
+    At most three crossings. */
+internal u32
+SvgPolyCrossings(r64 *X, r64 *Y, u32 Degree, r64 Py, b32 NeedX, r64 *Xs, s32 *Directions)
+{
+    u32 Count = 0;
+
+    // y-monotone pieces are bounded by the roots of dy/dt
+    r64 Splits[4] = {0.0};
+    u32 SplitCount = 1;
+
+    r64 Roots[3];
+    u32 RootCount = 0;
+
+    if (Degree == 2) {
+        if (Y[2] != 0.0) {
+            Roots[0] = -Y[1] / (2.0 * Y[2]);
+            RootCount = 1;
+        }
+    } else {
+        RootCount = SvgSolveQuadratic(3.0 * Y[3], 2.0 * Y[2], Y[1], Roots);
+        if (RootCount == 2 && Roots[0] > Roots[1]) {
+            r64 Tmp = Roots[0];
+            Roots[0] = Roots[1];
+            Roots[1] = Tmp;
+        }
+    }
+
+    for (u32 i=0; i<RootCount; ++i) {
+        if (Roots[i] > 0.0 && Roots[i] < 1.0) {
+            Splits[SplitCount++] = Roots[i];
+        }
+    }
+
+    Splits[SplitCount] = 1.0;
+
+    r64 Ya = Y[0];
+
+    for (u32 i=0; i<SplitCount; ++i) {
+        r64 Ta = Splits[i];
+        r64 Tb = Splits[i + 1];
+        r64 Yb = SvgPolyAt(Y, Degree, Tb);
+
+        s32 Direction = 0;
+        if (Ya <= Py && Py < Yb) {
+            Direction = 1;
+        } else if (Yb <= Py && Py < Ya) {
+            Direction = -1;
+        }
+
+        if (Direction) {
+            Directions[Count] = Direction;
+
+            if (NeedX) {
+                r64 C[4] = {Y[0] - Py, Y[1], Y[2], Degree == 3 ? Y[3] : 0.0};
+                u32 Solutions = (Degree == 2) ? SvgSolveQuadratic(C[2], C[1], C[0], Roots) : SvgSolveCubic(C[3], C[2], C[1], C[0], Roots);
+
+                r64 t = -1.0;
+                r64 Epsilon = 1e-6;
+                for (u32 j=0; j<Solutions; ++j) {
+                    if (Roots[j] >= Ta - Epsilon && Roots[j] <= Tb + Epsilon) {
+                        t = Roots[j];
+                        break;
+                    }
+                }
+
+                if (t < 0.0) {
+                    // note: precision loss in the closed form, the piece is monotone so bisection always works
+                    r64 Lo = Ta;
+                    r64 Hi = Tb;
+                    r64 Sign = (Yb > Ya) ? 1.0 : -1.0;
+                    for (u32 j=0; j<48; ++j) {
+                        r64 Mid = (Lo + Hi) * 0.5;
+                        if ((SvgPolyAt(Y, Degree, Mid) - Py) * Sign < 0.0) {
+                            Lo = Mid;
+                        } else {
+                            Hi = Mid;
+                        }
+                    }
+                    t = (Lo + Hi) * 0.5;
+                }
+
+                Xs[Count] = SvgPolyAt(X, Degree, t);
+            }
+
+            ++Count;
+        }
+
+        Ya = Yb;
+    }
+
+    return Count;
+}
+
+internal s32
+SvgPolyWinding(r64 *X, r64 *Y, u32 Degree, svg_v2 P, r32 MinX)
+{
+    r64 Xs[3];
+    s32 Directions[3];
+
+    // note: if the whole segment is right of the point, the crossing positions don't matter
+    b32 NeedX = (MinX <= P.x);
+    u32 Count = SvgPolyCrossings(X, Y, Degree, P.y, NeedX, Xs, Directions);
+
+    s32 Winding = 0;
+    for (u32 i=0; i<Count; ++i) {
+        if (!NeedX || Xs[i] > P.x) {
+            Winding += Directions[i];
+        }
+    }
+
+    return Winding;
+}
+
+// note: power basis of a bezier segment, returns the degree
+internal u32
+SvgSegmentPowerBasis(svg_path_segement *S, r64 *X, r64 *Y)
+{
+    if (S->Type == SvgSegment_QuadraticBezier) {
+        X[0] = S->P1.x;
+        X[1] = 2.0 * ((r64)S->C1.x - S->P1.x);
+        X[2] = (r64)S->P1.x - 2.0 * S->C1.x + S->P2.x;
+        Y[0] = S->P1.y;
+        Y[1] = 2.0 * ((r64)S->C1.y - S->P1.y);
+        Y[2] = (r64)S->P1.y - 2.0 * S->C1.y + S->P2.y;
+        return 2;
+    }
+
+    X[0] = S->P1.x;
+    X[1] = 3.0 * ((r64)S->C1.x - S->P1.x);
+    X[2] = 3.0 * ((r64)S->P1.x - 2.0 * S->C1.x + S->C2.x);
+    X[3] = -(r64)S->P1.x + 3.0 * S->C1.x - 3.0 * S->C2.x + S->P2.x;
+    Y[0] = S->P1.y;
+    Y[1] = 3.0 * ((r64)S->C1.y - S->P1.y);
+    Y[2] = 3.0 * ((r64)S->P1.y - 2.0 * S->C1.y + S->C2.y);
+    Y[3] = -(r64)S->P1.y + 3.0 * S->C1.y - 3.0 * S->C2.y + S->P2.y;
+    return 3;
+}
+
+internal s32
+SvgLineWinding(svg_v2 A, svg_v2 B, svg_v2 P)
+{
+    s32 Direction = 0;
+    if (A.y <= P.y && P.y < B.y) {
+        Direction = 1;
+    } else if (B.y <= P.y && P.y < A.y) {
+        Direction = -1;
+    }
+
+    if (Direction) {
+        r32 X = A.x + (P.y - A.y) * (B.x - A.x) / (B.y - A.y);
+        if (X <= P.x) {
+            Direction = 0;
+        }
+    }
+
+    return Direction;
+}
+
+/*  Winding of a curve that lies wholly right of P. Summed over its y-monotone pieces the half-open
+    crossings telescope, so only the sides of the end points matter and nothing has to be solved. */
+inline s32
+SvgRightWinding(svg_v2 A, svg_v2 B, svg_v2 P)
+{
+    return (s32)(B.y > P.y) - (s32)(A.y > P.y);
+}
+
+s32
+SvgSegmentWinding(svg_path_segement *S, svg_v2 P)
+{
+    s32 Winding = 0;
+
+    switch (S->Type) {
+        case SvgSegment_Line: {
+            Winding = SvgLineWinding(S->P1, S->P2, P);
+        } break;
+
+        case SvgSegment_QuadraticBezier: {
+            r32 MinY = SvgMin(SvgMin(S->P1.y, S->P2.y), S->C1.y);
+            r32 MaxY = SvgMax(SvgMax(S->P1.y, S->P2.y), S->C1.y);
+            r32 MinX = SvgMin(SvgMin(S->P1.x, S->P2.x), S->C1.x);
+            r32 MaxX = SvgMax(SvgMax(S->P1.x, S->P2.x), S->C1.x);
+
+            if (P.y < MinY || P.y > MaxY || MaxX <= P.x) {
+                break;
+            }
+
+            if (MinX > P.x) {
+                Winding = SvgRightWinding(S->P1, S->P2, P);
+                break;
+            }
+
+            r64 X[4];
+            r64 Y[4];
+            SvgSegmentPowerBasis(S, X, Y);
+
+            Winding = SvgPolyWinding(X, Y, 2, P, MinX);
+        } break;
+
+        case SvgSegment_CubicBezier: {
+            r32 MinY = SvgMin(SvgMin(S->P1.y, S->P2.y), SvgMin(S->C1.y, S->C2.y));
+            r32 MaxY = SvgMax(SvgMax(S->P1.y, S->P2.y), SvgMax(S->C1.y, S->C2.y));
+            r32 MinX = SvgMin(SvgMin(S->P1.x, S->P2.x), SvgMin(S->C1.x, S->C2.x));
+            r32 MaxX = SvgMax(SvgMax(S->P1.x, S->P2.x), SvgMax(S->C1.x, S->C2.x));
+
+            if (P.y < MinY || P.y > MaxY || MaxX <= P.x) {
+                break;
+            }
+
+            if (MinX > P.x) {
+                Winding = SvgRightWinding(S->P1, S->P2, P);
+                break;
+            }
+
+            r64 X[4];
+            r64 Y[4];
+            SvgSegmentPowerBasis(S, X, Y);
+
+            Winding = SvgPolyWinding(X, Y, 3, P, MinX);
+        } break;
+
+        case SvgSegment_Elliptical: {
+            // note: every point of the arc is within the diameter of both end points, which rejects
+            //       most arcs before the center parameterization is computed. Radii too small to span
+            //       the end points are scaled up first like SvgArcToCubics does (F.6.6), by at most
+            //       half the chord over the smaller radius whatever the rotation, so no trig is needed.
+            //       The slack covers the cubics bulging out of the ellipse.
+            r32 Rx = fabsf(S->Rx);
+            r32 Ry = fabsf(S->Ry);
+            r32 Chord = SvgLength(S->P2 - S->P1);
+            r32 Diameter = 2.0f * SvgMax(Rx, Ry);
+
+            if (Rx > 0.0f && Ry > 0.0f) {
+                Diameter *= SvgMax(1.0f, 0.5f * Chord / SvgMin(Rx, Ry));
+            }
+
+            r32 Reach = 1.001f * SvgMax(Diameter, Chord);
+            if (P.y < S->P1.y - Reach || P.y > S->P1.y + Reach ||
+                P.y < S->P2.y - Reach || P.y > S->P2.y + Reach ||
+                P.x >= SvgMin(S->P1.x, S->P2.x) + Reach)
+            {
+                break;
+            }
+
+            if (P.x < SvgMax(S->P1.x, S->P2.x) - Reach) {
+                Winding = SvgRightWinding(S->P1, S->P2, P);
+                break;
+            }
+
+            svg_path_segement Cubics[4];
+            u32 Count = SvgArcToCubics(S, Cubics);
+            for (u32 i=0; i<Count; ++i) {
+                Winding += SvgSegmentWinding(Cubics + i, P);
+            }
+        } break;
+    }
+
+    return Winding;
+}
+
+// note: crossings of y = Py with the segment, half-open like the winding tests. An arc is up to
+//       four cubics, so Xs and Directions need room for 12.
+u32
+SvgSegmentCrossings(svg_path_segement *S, r32 Py, r32 *Xs, s32 *Directions)
+{
+    u32 Count = 0;
+
+    switch (S->Type) {
+        case SvgSegment_Line: {
+            s32 Direction = SvgLineWinding(S->P1, S->P2, {-1e30f, Py});
+            if (Direction) {
+                Xs[0] = S->P1.x + (Py - S->P1.y) * (S->P2.x - S->P1.x) / (S->P2.y - S->P1.y);
+                Directions[0] = Direction;
+                Count = 1;
+            }
+        } break;
+
+        case SvgSegment_QuadraticBezier:
+        case SvgSegment_CubicBezier: {
+            svg_bounds Bounds = SvgSegmentBounds(S);
+            if (Py < Bounds.Min.y || Py > Bounds.Max.y) {
+                break;
+            }
+
+            r64 X[4];
+            r64 Y[4];
+            r64 Roots[3];
+            u32 Degree = SvgSegmentPowerBasis(S, X, Y);
+
+            Count = SvgPolyCrossings(X, Y, Degree, Py, true, Roots, Directions);
+            for (u32 i=0; i<Count; ++i) {
+                Xs[i] = (r32)Roots[i];
+            }
+        } break;
+
+        case SvgSegment_Elliptical: {
+            svg_path_segement Cubics[4];
+            u32 CubicCount = SvgArcToCubics(S, Cubics);
+            for (u32 i=0; i<CubicCount; ++i) {
+                Count += SvgSegmentCrossings(Cubics + i, Py, Xs + Count, Directions + Count);
+            }
+        } break;
+    }
+
+    return Count;
+}
+
+// note: open contours are implicitly closed, same as when they are filled
+s32
+SvgPathWinding(svg_path *Path, svg_v2 P)
+{
+    s32 Winding = 0;
+
+    if (!Path->Segments.Count || !SvgBoundsContain(Path->Bounds, P)) {
+        return Winding;
+    }
+
+    u32 At = 0;
+    svg_contour Contour;
+
+    while (SvgNextContour(Path, &At, &Contour)) {
+        for (u32 i=0; i<Contour.Count; ++i) {
+            Winding += SvgSegmentWinding(Contour.Segments + i, P);
+        }
+
+        if (!Contour.Closed) {
+            Winding += SvgLineWinding(Contour.Segments[Contour.Count - 1].P2, Contour.Segments[0].P1, P);
+        }
+    }
+
+    return Winding;
+}
+
+// note: decodes the path of E first in a lazily parsed document
+b32
+SvgElementContainsPoint(svg *Svg, svg_element *E, svg_v2 P)
+{
+    b32 Result = false;
+
+    switch (E->Type) {
+        case SvgElement_Path: {
+            s32 Winding = SvgPathWinding(SvgElementPath(Svg, E), P);
+            Result = (E->FillRule == SvgFillRule_EvenOdd) ? (Winding & 1) : (Winding != 0);
+        } break;
+
+        case SvgElement_Rect: {
+            svg_rect R = E->Rect;
+            Result = (P.x >= R.P.x && P.x < R.P.x + R.Dim.x &&
+                      P.y >= R.P.y && P.y < R.P.y + R.Dim.y);
+        } break;
+
+        case SvgElement_Circle: {
+            svg_v2 D = P - E->Circle.Center;
+            Result = SvgDot(D, D) <= E->Circle.R * E->Circle.R;
+        } break;
+
+        default: {
+        } break;
+    }
+
+    return Result;
+}
+
+// note: elements are painted in document order, so the last one containing the point is on top
+svg_element *
+SvgHitTest(svg *Svg, svg_v2 P)
+{
+    for (s32 i=Svg->Elements.Count - 1; i>=0; --i) {
+        svg_element *E = Svg->Elements.Data + i;
+        if (SvgElementContainsPoint(Svg, E, P)) {
+            return E;
+        }
+    }
+
+    return 0;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_HIT
@@ -0,0 +1,201 @@
+#ifndef INCLUDE_GUARD_LS_SVG_JOBS
+#define INCLUDE_GUARD_LS_SVG_JOBS
+
+/*  Work-stealing pool for data parallel loops.
+
+    SvgParallelFor splits the index range evenly between the workers. Each worker pops indices from
+    the front of its own range and, once that runs dry, steals from the back of the others. A range
+    is packed into a single 64-bit atomic, so taking an index from either end is one CAS. The thread
+    that calls SvgParallelFor works as worker 0. */
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define SVG_MAX_WORKERS 64
+
+typedef void svg_job_proc(void *Data, u32 Index, u32 Worker);
+
+// note: one cache line each, owners and thieves of different ranges don't share lines
+struct alignas(64) svg_job_range {
+    std::atomic<u64> Range; // (Begin << 32) | End
+};
+
+struct svg_job_pool {
+    u32 WorkerCount;
+    std::thread *Threads;
+    svg_job_range Ranges[SVG_MAX_WORKERS];
+
+    std::mutex Mutex;
+    std::condition_variable Wake;
+    std::condition_variable Done;
+    u64 Generation;
+    u32 Busy;
+    b32 Quit;
+
+    svg_job_proc *Proc;
+    void *Data;
+};
+
+internal b32
+SvgJobPopFront(svg_job_range *Range, u32 *Index)
+{
+    u64 Old = Range->Range.load(std::memory_order_relaxed);
+
+    for (;;) {
+        u32 Begin = (u32)(Old >> 32);
+        u32 End = (u32)Old;
+        if (Begin >= End) {
+            return false;
+        }
+
+        u64 New = ((u64)(Begin + 1) << 32) | End;
+        if (Range->Range.compare_exchange_weak(Old, New, std::memory_order_acquire, std::memory_order_relaxed)) {
+            *Index = Begin;
+            return true;
+        }
+    }
+}
+
+internal b32
+SvgJobPopBack(svg_job_range *Range, u32 *Index)
+{
+    u64 Old = Range->Range.load(std::memory_order_relaxed);
+
+    for (;;) {
+        u32 Begin = (u32)(Old >> 32);
+        u32 End = (u32)Old;
+        if (Begin >= End) {
+            return false;
+        }
+
+        u64 New = ((u64)Begin << 32) | (End - 1);
+        if (Range->Range.compare_exchange_weak(Old, New, std::memory_order_acquire, std::memory_order_relaxed)) {
+            *Index = End - 1;
+            return true;
+        }
+    }
+}
+
+internal void
+SvgJobRun(svg_job_pool *Pool, u32 Worker)
+{
+    u32 Index;
+
+    while (SvgJobPopFront(Pool->Ranges + Worker, &Index)) {
+        Pool->Proc(Pool->Data, Index, Worker);
+    }
+
+    for (u32 i=1; i<Pool->WorkerCount; ++i) {
+        svg_job_range *Victim = Pool->Ranges + (Worker + i) % Pool->WorkerCount;
+        while (SvgJobPopBack(Victim, &Index)) {
+            Pool->Proc(Pool->Data, Index, Worker);
+        }
+    }
+}
+
+internal void
+SvgJobWorker(svg_job_pool *Pool, u32 Worker)
+{
+    u64 Seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> Lock(Pool->Mutex);
+            Pool->Wake.wait(Lock, [&] { return Pool->Quit || Pool->Generation != Seen; });
+            if (Pool->Quit) {
+                return;
+            }
+            Seen = Pool->Generation;
+        }
+
+        SvgJobRun(Pool, Worker);
+
+        std::lock_guard<std::mutex> Lock(Pool->Mutex);
+        if (--Pool->Busy == 0) {
+            Pool->Done.notify_one();
+        }
+    }
+}
+
+// note: ThreadCount 0 uses every hardware thread, 1 runs everything on the calling thread
+void
+SvgJobPoolStart(svg_job_pool *Pool, u32 ThreadCount)
+{
+    if (!ThreadCount) {
+        ThreadCount = std::thread::hardware_concurrency();
+    }
+
+    if (ThreadCount < 1) ThreadCount = 1;
+    if (ThreadCount > SVG_MAX_WORKERS) ThreadCount = SVG_MAX_WORKERS;
+
+    Pool->WorkerCount = ThreadCount;
+    Pool->Generation = 0;
+    Pool->Busy = 0;
+    Pool->Quit = false;
+    Pool->Proc = 0;
+    Pool->Data = 0;
+
+    for (u32 i=0; i<SVG_MAX_WORKERS; ++i) {
+        Pool->Ranges[i].Range.store(0, std::memory_order_relaxed);
+    }
+
+    Pool->Threads = (ThreadCount > 1) ? new std::thread[ThreadCount - 1] : 0;
+    for (u32 i=1; i<ThreadCount; ++i) {
+        Pool->Threads[i - 1] = std::thread(SvgJobWorker, Pool, i);
+    }
+}
+
+void
+SvgJobPoolStop(svg_job_pool *Pool)
+{
+    {
+        std::lock_guard<std::mutex> Lock(Pool->Mutex);
+        Pool->Quit = true;
+    }
+    Pool->Wake.notify_all();
+
+    for (u32 i=1; i<Pool->WorkerCount; ++i) {
+        Pool->Threads[i - 1].join();
+    }
+
+    delete[] Pool->Threads;
+    Pool->Threads = 0;
+    Pool->WorkerCount = 0;
+}
+
+// note: Pool may be null, which runs the loop serially as worker 0
+void
+SvgParallelFor(svg_job_pool *Pool, u32 Count, svg_job_proc *Proc, void *Data)
+{
+    if (!Pool || Pool->WorkerCount <= 1 || Count <= 1) {
+        for (u32 i=0; i<Count; ++i) {
+            Proc(Data, i, 0);
+        }
+        return;
+    }
+
+    u32 Workers = Pool->WorkerCount;
+    for (u32 i=0; i<Workers; ++i) {
+        u64 Begin = (u64)Count * i / Workers;
+        u64 End = (u64)Count * (i + 1) / Workers;
+        Pool->Ranges[i].Range.store((Begin << 32) | End, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(Pool->Mutex);
+        Pool->Proc = Proc;
+        Pool->Data = Data;
+        Pool->Busy = Workers - 1;
+        ++Pool->Generation;
+    }
+    Pool->Wake.notify_all();
+
+    SvgJobRun(Pool, 0);
+
+    std::unique_lock<std::mutex> Lock(Pool->Mutex);
+    Pool->Done.wait(Lock, [&] { return Pool->Busy == 0; });
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_JOBS
@@ -0,0 +1,331 @@
+#ifndef INCLUDE_GUARD_LS_SVG_LOD
+#define INCLUDE_GUARD_LS_SVG_LOD
+
+/*  Level of detail cache of flattened geometry.
+
+    Every element gets SVG_LOD_LEVELS polylines in path space, level L is flattened with tolerance
+    BaseTolerance * 2^L. A request for a screen scale picks the coarsest level that is still within
+    SVG_RASTER_TOLERANCE pixels at that scale, which is an exponent extraction, and flattens it the
+    first time it is asked for. Any thread may ask, the first one builds the level and the others
+    wait for it.
+
+    Levels are allocated when first asked for, up front there is only a table of one pointer per
+    element and level. Everything counts against the byte budget: the table, the levels and their
+    polylines. A polyline returned by SvgLodGet is held until it is given back with SvgLodDone. A
+    level built over the budget makes room right away, a hand goes around the table and evicts the
+    levels nobody asked for this frame. When there are none left, a level given back over the budget
+    is evicted itself, so a frame that asks for more than fits keeps the levels it found and rebuilds
+    the rest, instead of every level pushing out the one it will need next. Either way the cache
+    stays within the budget, give or take the levels being built, unless the budget is too small to
+    hold even the table and the entries of one frame.
+
+    A request pins the level before it looks at its state, an eviction claims the state before it
+    looks at the pins. Either the eviction sees the level held and puts it back, or the request sees
+    it evicted and builds it again. Evicted levels keep their entry, a request may still be reading
+    the pointer. SvgLodTrim ends a frame and frees them, no thread may use the cache then. */
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#define SVG_LOD_LEVELS 16
+
+enum svg_lod_state_ {
+    SvgLodState_Empty,
+    SvgLodState_Building,
+    SvgLodState_Ready,
+    SvgLodState_Evicting,
+};
+
+struct svg_lod_entry {
+    std::atomic<u32> State;
+    std::atomic<u32> Users;   // requests holding the polyline, from SvgLodGet to SvgLodDone
+    std::atomic<u32> LastUse; // frame of the last request
+    svg_polyline Polyline;
+    size_t Bytes;
+};
+
+struct svg_lod_cache {
+    svg *Svg;
+    std::atomic<svg_lod_entry *> *Entries; // Element * SVG_LOD_LEVELS + Level, null until requested
+    u32 ElementCount;
+    r32 BaseTolerance;
+
+    size_t Budget;
+    std::atomic<size_t> Bytes;
+    std::atomic<size_t> Peak; // most bytes held at any time
+
+    u32 Frame;
+
+    std::mutex EvictMutex;
+    u32 Hand;         // next table index the eviction looks at
+    u32 HandFrame;    // frame the hand started its turn in
+    u32 HandSteps;    // entries passed this frame, after a full turn nothing old is left to evict
+    u32 EvictedCount; // entries left empty by evictions, SvgLodTrim frees them
+};
+
+// note: Budget is in bytes the cache holds, the table included. BaseTolerance in path units is the finest level
+void
+SvgLodInit(svg_lod_cache *Cache, svg *Svg, r32 BaseTolerance, size_t Budget)
+{
+    Cache->Svg = Svg;
+    Cache->ElementCount = Svg->Elements.Count;
+    Cache->BaseTolerance = BaseTolerance;
+    Cache->Budget = Budget;
+    Cache->Frame = 1;
+    Cache->Hand = 0;
+    Cache->HandFrame = 0;
+    Cache->HandSteps = 0;
+    Cache->EvictedCount = 0;
+
+    size_t EntryCount = (size_t)Cache->ElementCount * SVG_LOD_LEVELS;
+    size_t TableBytes = EntryCount * sizeof(std::atomic<svg_lod_entry *>);
+    Cache->Entries = (std::atomic<svg_lod_entry *> *)malloc(TableBytes);
+    for (size_t i=0; i<EntryCount; ++i) {
+        new (Cache->Entries + i) std::atomic<svg_lod_entry *>(0);
+    }
+
+    Cache->Bytes = TableBytes;
+    Cache->Peak = TableBytes;
+}
+
+// note: coarsest level whose tolerance is at most SVG_RASTER_TOLERANCE / Scale
+inline u32
+SvgLodLevel(svg_lod_cache *Cache, r32 Scale)
+{
+    r32 Ratio = SVG_RASTER_TOLERANCE / (Scale * Cache->BaseTolerance);
+    if (!(Ratio >= 1.0f)) {
+        return 0;
+    }
+
+    s32 Level = ilogbf(Ratio);
+    return (Level < SVG_LOD_LEVELS - 1) ? (u32)Level : SVG_LOD_LEVELS - 1;
+}
+
+inline r32
+SvgLodTolerance(svg_lod_cache *Cache, u32 Level)
+{
+    return ldexpf(Cache->BaseTolerance, (s32)Level);
+}
+
+internal void
+SvgLodGrow(svg_lod_cache *Cache, size_t Bytes)
+{
+    size_t Now = (Cache->Bytes += Bytes);
+    size_t Peak = Cache->Peak.load(std::memory_order_relaxed);
+    while (Now > Peak && !Cache->Peak.compare_exchange_weak(Peak, Now, std::memory_order_relaxed)) {
+    }
+}
+
+// note: frees the level at table index Index and its entry, only while no other thread uses the cache
+internal void
+SvgLodRelease(svg_lod_cache *Cache, u32 Index)
+{
+    svg_lod_entry *Entry = Cache->Entries[Index].load(std::memory_order_relaxed);
+    if (!Entry) {
+        return;
+    }
+
+    Entry->Polyline.Points.Free();
+    Entry->Polyline.ContourEnds.Free();
+
+    Cache->Bytes -= sizeof(svg_lod_entry) + Entry->Bytes;
+    Cache->Entries[Index].store(0, std::memory_order_relaxed);
+    free(Entry);
+}
+
+// note: evicts the level of Entry unless a request holds it, the entry stays. Only with EvictMutex held
+internal b32
+SvgLodEvict(svg_lod_cache *Cache, svg_lod_entry *Entry)
+{
+    u32 State = SvgLodState_Ready;
+    if (!Entry->State.compare_exchange_strong(State, SvgLodState_Evicting)) {
+        return false;
+    }
+
+    if (Entry->Users.load()) {
+        Entry->State.store(SvgLodState_Ready, std::memory_order_release);
+        return false;
+    }
+
+    Entry->Polyline.Points.Free();
+    Entry->Polyline.ContourEnds.Free();
+    Cache->Bytes -= Entry->Bytes;
+    Entry->Bytes = 0;
+    Cache->EvictedCount++;
+    Entry->State.store(SvgLodState_Empty, std::memory_order_release);
+    return true;
+}
+
+/*  Evicts levels of earlier frames until the cache fits its budget. Nothing becomes old within a
+    frame, so one turn of the hand per frame finds all there is. When a level is given back, Last,
+    and the cache is still over it goes next, then any level nobody holds. Safe to call while other
+    threads use the cache. */
+internal void
+SvgLodMakeRoom(svg_lod_cache *Cache, svg_lod_entry *Last)
+{
+    std::lock_guard<std::mutex> Lock(Cache->EvictMutex);
+    u32 EntryCount = Cache->ElementCount * SVG_LOD_LEVELS;
+    u32 Frame = Cache->Frame;
+
+    if (Cache->HandFrame != Frame) {
+        Cache->HandFrame = Frame;
+        Cache->HandSteps = 0;
+    }
+
+    while (Cache->Bytes > Cache->Budget && Cache->HandSteps < EntryCount) {
+        svg_lod_entry *Entry = Cache->Entries[Cache->Hand].load(std::memory_order_acquire);
+        Cache->Hand = (Cache->Hand + 1 < EntryCount) ? Cache->Hand + 1 : 0;
+        Cache->HandSteps++;
+
+        if (Entry && Entry->LastUse.load(std::memory_order_relaxed) != Frame) {
+            SvgLodEvict(Cache, Entry);
+        }
+    }
+
+    if (Last && Cache->Bytes > Cache->Budget) {
+        SvgLodEvict(Cache, Last);
+    }
+
+    // note: the entries of evicted levels stay until the trim, levels of this frame make up for them.
+    //       A second turn at most, a budget too small for the entries alone can't be met anyway
+    while (Last && Cache->Bytes > Cache->Budget && Cache->HandSteps < 2 * EntryCount) {
+        svg_lod_entry *Entry = Cache->Entries[Cache->Hand].load(std::memory_order_acquire);
+        Cache->Hand = (Cache->Hand + 1 < EntryCount) ? Cache->Hand + 1 : 0;
+        Cache->HandSteps++;
+
+        if (Entry) {
+            SvgLodEvict(Cache, Entry);
+        }
+    }
+}
+
+/*  Path space polyline of Element for drawing at Scale (pixels per path unit), null for elements
+    without geometry. Safe to call from any number of threads, every polyline returned has to be
+    given back with SvgLodDone. */
+svg_polyline *
+SvgLodGet(svg_lod_cache *Cache, u32 Element, r32 Scale)
+{
+    if (Element >= Cache->ElementCount) {
+        return 0;
+    }
+
+    svg_element *E = Cache->Svg->Elements.Data + Element;
+    svg_path *Path = SvgElementPath(Cache->Svg, E);
+    if (E->Type != SvgElement_Path || !Path->Segments.Count) {
+        return 0;
+    }
+
+    u32 Level = SvgLodLevel(Cache, Scale);
+    std::atomic<svg_lod_entry *> *Slot = Cache->Entries + (size_t)Element * SVG_LOD_LEVELS + Level;
+
+    svg_lod_entry *Entry = Slot->load(std::memory_order_acquire);
+    if (!Entry) {
+        // note: all zero is an empty entry once the atomics are made. When another thread got a level in
+        //       first it is the one used
+        svg_lod_entry *New = (svg_lod_entry *)calloc(1, sizeof(svg_lod_entry));
+        new (&New->State) std::atomic<u32>(SvgLodState_Empty);
+        new (&New->Users) std::atomic<u32>(0);
+        new (&New->LastUse) std::atomic<u32>(Cache->Frame);
+
+        if (Slot->compare_exchange_strong(Entry, New, std::memory_order_acq_rel)) {
+            Entry = New;
+            SvgLodGrow(Cache, sizeof(svg_lod_entry));
+        } else {
+            free(New);
+        }
+    }
+
+    // note: the pin goes out before the state is read, see SvgLodEvict
+    Entry->LastUse.store(Cache->Frame, std::memory_order_relaxed);
+    Entry->Users.fetch_add(1);
+
+    for (;;) {
+        u32 State = Entry->State.load();
+        if (State == SvgLodState_Ready) {
+            return &Entry->Polyline;
+        }
+
+        if (State == SvgLodState_Empty &&
+            Entry->State.compare_exchange_strong(State, SvgLodState_Building, std::memory_order_acquire))
+        {
+            break;
+        }
+
+        // note: another thread is flattening or evicting this level, it won't take long
+        std::this_thread::yield();
+    }
+
+    svg_polyline *Polyline = &Entry->Polyline;
+    Polyline->Points.Count = 0;
+    Polyline->ContourEnds.Count = 0;
+    SvgFlattenPath(Path, SvgScaleTransform(1.0f), SvgLodTolerance(Cache, Level), Polyline);
+
+    // note: levels live long, give back the slack of the doubling growth
+    Polyline->Points.Data = (svg_v2 *)SvgReallocate(Polyline->Points.Allocator, Polyline->Points.Data,
+                                                    Polyline->Points.Cap * sizeof(svg_v2),
+                                                    Polyline->Points.Count * sizeof(svg_v2));
+    Polyline->Points.Cap = Polyline->Points.Count;
+    Polyline->ContourEnds.Data = (u32 *)SvgReallocate(Polyline->ContourEnds.Allocator, Polyline->ContourEnds.Data,
+                                                      Polyline->ContourEnds.Cap * sizeof(u32),
+                                                      Polyline->ContourEnds.Count * sizeof(u32));
+    Polyline->ContourEnds.Cap = Polyline->ContourEnds.Count;
+
+    Entry->Bytes = Polyline->Points.Cap * sizeof(svg_v2) + Polyline->ContourEnds.Cap * sizeof(u32);
+    SvgLodGrow(Cache, Entry->Bytes);
+    Entry->State.store(SvgLodState_Ready, std::memory_order_release);
+
+    if (Cache->Bytes > Cache->Budget) {
+        SvgLodMakeRoom(Cache, 0);
+    }
+
+    return Polyline;
+}
+
+// note: gives back a polyline from SvgLodGet, it may be evicted from then on
+inline void
+SvgLodDone(svg_lod_cache *Cache, svg_polyline *Polyline)
+{
+    svg_lod_entry *Entry = (svg_lod_entry *)((u8 *)Polyline - offsetof(svg_lod_entry, Polyline));
+    if (Entry->Users.fetch_sub(1) == 1 && Cache->Bytes > Cache->Budget) {
+        SvgLodMakeRoom(Cache, Entry);
+    }
+}
+
+/*  Ends a frame and frees the entries of evicted levels. Levels this frame asked for keep theirs
+    while the cache fits, the next frame likely builds them again. Not safe to call while other
+    threads use the cache, polylines still held stay valid. */
+void
+SvgLodTrim(svg_lod_cache *Cache)
+{
+    if (Cache->EvictedCount) {
+        u32 EntryCount = Cache->ElementCount * SVG_LOD_LEVELS;
+        for (u32 i=0; i<EntryCount; ++i) {
+            svg_lod_entry *Entry = Cache->Entries[i].load(std::memory_order_relaxed);
+            if (Entry && Entry->State.load(std::memory_order_relaxed) == SvgLodState_Empty &&
+                (Entry->LastUse.load(std::memory_order_relaxed) != Cache->Frame || Cache->Bytes > Cache->Budget))
+            {
+                SvgLodRelease(Cache, i);
+            }
+        }
+
+        Cache->EvictedCount = 0;
+    }
+
+    Cache->Frame++;
+}
+
+void
+SvgLodFree(svg_lod_cache *Cache)
+{
+    u32 EntryCount = Cache->ElementCount * SVG_LOD_LEVELS;
+    for (u32 i=0; i<EntryCount; ++i) {
+        SvgLodRelease(Cache, i);
+    }
+
+    free(Cache->Entries);
+    Cache->Bytes = 0;
+    Cache->Entries = 0;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_LOD
@@ -0,0 +1,378 @@
+#ifndef INCLUDE_GUARD_LS_SVG_MEASURE
+#define INCLUDE_GUARD_LS_SVG_MEASURE
+
+/*  Arc length of paths.
+
+    SvgMeasurePath builds a table of cumulative lengths once, after that a distance along the path
+    turns into a point or a direction with a binary search and Newton steps instead of integrating
+    the curves again. Curves are cut into SVG_MEASURE_STEPS equal parameter steps and every step is
+    integrated with 5 point Gauss-Legendre quadrature. Arcs are converted to cubics first.
+
+    Distances run over all contours of the path, a move adds no length (like getPointAtLength).
+    Dashing restarts the pattern on every contour, like stroke-dasharray. */
+
+#define SVG_MEASURE_STEPS 16
+#define SVG_MEASURE_ITERATIONS 8
+
+// note: end of one step of a piece, Length is from the start of the path
+struct svg_length_sample {
+    r32 Length;
+    r32 t;
+    u32 Piece;
+};
+
+struct svg_measured_contour {
+    u32 FirstPiece;
+    u32 PieceCount;
+    u32 FirstSample;
+    u32 SampleCount;
+    r32 Start;
+    r32 Length;
+    b32 Closed;
+};
+
+// note: scratch memory and output, keep it around between calls
+struct svg_path_measure {
+    svg_array<svg_path_segement> Pieces; // lines, quadratics and cubics
+    svg_array<svg_length_sample> Samples;
+    svg_array<svg_measured_contour> Contours;
+    r32 Length;
+};
+
+internal svg_v2
+SvgSegmentDerivative(svg_path_segement *S, r32 t)
+{
+    r32 u = 1.0f - t;
+
+    switch (S->Type) {
+        case SvgSegment_QuadraticBezier: {
+            return ((S->C1 - S->P1) * u + (S->P2 - S->C1) * t) * 2.0f;
+        }
+        case SvgSegment_CubicBezier: {
+            return ((S->C1 - S->P1) * (u * u) + (S->C2 - S->C1) * (2.0f * u * t) + (S->P2 - S->C2) * (t * t)) * 3.0f;
+        }
+        default: {
+            return S->P2 - S->P1;
+        }
+    }
+}
+
+// note: length of the piece between t0 and t1
+internal r32
+SvgSegmentLength(svg_path_segement *S, r32 t0, r32 t1)
+{
+    if (S->Type == SvgSegment_Line) {
+        return SvgLength(S->P2 - S->P1) * (t1 - t0);
+    }
+
+    static const r32 Nodes[5] = {0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f};
+    static const r32 Weights[5] = {0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f};
+
+    r32 Half = 0.5f * (t1 - t0);
+    r32 Mid = 0.5f * (t0 + t1);
+    r32 Result = 0.0f;
+
+    for (u32 i=0; i<5; ++i) {
+        Result += Weights[i] * SvgLength(SvgSegmentDerivative(S, Mid + Half * Nodes[i]));
+    }
+
+    return Result * Half;
+}
+
+internal void
+SvgMeasurePiece(svg_path_measure *M, svg_path_segement Piece)
+{
+    b32 Degenerate = (Piece.P1 == Piece.P2);
+    if (Piece.Type != SvgSegment_Line) {
+        Degenerate = Degenerate && Piece.C1 == Piece.P1 && (Piece.Type != SvgSegment_CubicBezier || Piece.C2 == Piece.P1);
+    }
+
+    if (Degenerate) {
+        return;
+    }
+
+    u32 Index = M->Pieces.Count;
+    M->Pieces.Push(Piece);
+
+    u32 Steps = (Piece.Type == SvgSegment_Line) ? 1 : SVG_MEASURE_STEPS;
+    r32 Step = 1.0f / Steps;
+
+    for (u32 i=0; i<Steps; ++i) {
+        r32 t0 = i * Step;
+        r32 t1 = (i + 1 < Steps) ? (i + 1) * Step : 1.0f;
+        M->Length += SvgSegmentLength(&Piece, t0, t1);
+        M->Samples.Push({M->Length, t1, Index});
+    }
+}
+
+void
+SvgMeasurePath(svg_path_measure *M, svg_path *Path)
+{
+    M->Pieces.Count = 0;
+    M->Samples.Count = 0;
+    M->Contours.Count = 0;
+    M->Length = 0.0f;
+
+    u32 At = 0;
+    svg_contour Contour;
+
+    while (SvgNextContour(Path, &At, &Contour)) {
+        svg_measured_contour Measured = {};
+        Measured.FirstPiece = M->Pieces.Count;
+        Measured.FirstSample = M->Samples.Count;
+        Measured.Start = M->Length;
+        Measured.Closed = Contour.Closed;
+
+        for (u32 i=0; i<Contour.Count; ++i) {
+            svg_path_segement *Segment = Contour.Segments + i;
+
+            if (Segment->Type == SvgSegment_Elliptical) {
+                svg_path_segement Cubics[4];
+                u32 Count = SvgArcToCubics(Segment, Cubics);
+                for (u32 c=0; c<Count; ++c) {
+                    SvgMeasurePiece(M, Cubics[c]);
+                }
+            } else {
+                SvgMeasurePiece(M, *Segment);
+            }
+        }
+
+        Measured.PieceCount = M->Pieces.Count - Measured.FirstPiece;
+        Measured.SampleCount = M->Samples.Count - Measured.FirstSample;
+        Measured.Length = M->Length - Measured.Start;
+
+        if (Measured.PieceCount) {
+            M->Contours.Push(Measured);
+        }
+    }
+}
+
+/*  Piece and parameter at Distance within the samples First .. First + Count, clamped to them. The
+    step comes from a binary search, the parameter from interpolating within the step and a few
+    Newton steps on the length. Where Distance is on a step boundary After picks the later step. */
+internal void
+SvgMeasureFind(svg_path_measure *M, u32 First, u32 Count, r32 Distance, b32 After, u32 *Piece, r32 *Parameter)
+{
+    svg_length_sample *Samples = M->Samples.Data;
+    r32 Begin = First ? Samples[First - 1].Length : 0.0f;
+    r32 End = Samples[First + Count - 1].Length;
+    Distance = (Distance < Begin) ? Begin : (Distance > End) ? End : Distance;
+
+    u32 Low = First;
+    u32 High = First + Count - 1;
+
+    while (Low < High) {
+        u32 Mid = (Low + High) / 2;
+        if (Samples[Mid].Length < Distance || (After && Samples[Mid].Length == Distance)) {
+            Low = Mid + 1;
+        } else {
+            High = Mid;
+        }
+    }
+
+    // note: moves add no length, so the sample before a contour ends where the contour starts
+    svg_length_sample *Sample = Samples + Low;
+    b32 SamePiece = Low > 0 && Samples[Low - 1].Piece == Sample->Piece;
+    r32 L0 = Low ? Samples[Low - 1].Length : 0.0f;
+    r32 t0 = SamePiece ? Samples[Low - 1].t : 0.0f;
+    r32 t1 = Sample->t;
+
+    svg_path_segement *S = M->Pieces.Data + Sample->Piece;
+    r32 StepLength = Sample->Length - L0;
+    r32 t = (StepLength > 0.0f) ? t0 + (t1 - t0) * (Distance - L0) / StepLength : t0;
+
+    if (S->Type != SvgSegment_Line) {
+        // note: Newton steps that fall outside the bracket bisect instead, the speed can go to zero at a cusp
+        r32 Low = t0;
+        r32 High = t1;
+        r32 Target = Distance - L0;
+
+        for (u32 i=0; i<SVG_MEASURE_ITERATIONS; ++i) {
+            r32 Error = SvgSegmentLength(S, t0, t) - Target;
+            if (fabsf(Error) <= 1e-5f * StepLength) {
+                break;
+            }
+
+            if (Error > 0.0f) {
+                High = t;
+            } else {
+                Low = t;
+            }
+
+            r32 Speed = SvgLength(SvgSegmentDerivative(S, t));
+            r32 Next = (Speed > 0.0f) ? t - Error / Speed : Low;
+            t = (Next > Low && Next < High) ? Next : 0.5f * (Low + High);
+        }
+    }
+
+    *Piece = Sample->Piece;
+    *Parameter = t;
+}
+
+// note: piece and parameter at Distance from the start of the path, false for an empty path
+b32
+SvgMeasureLocate(svg_path_measure *M, r32 Distance, u32 *Piece, r32 *Parameter)
+{
+    if (!M->Samples.Count) {
+        return false;
+    }
+
+    SvgMeasureFind(M, 0, M->Samples.Count, Distance, false, Piece, Parameter);
+    return true;
+}
+
+svg_v2
+SvgPointAt(svg_path_measure *M, r32 Distance)
+{
+    u32 Piece;
+    r32 t;
+    if (!SvgMeasureLocate(M, Distance, &Piece, &t)) {
+        return {0.0f, 0.0f};
+    }
+
+    return SvgSegmentAt(M->Pieces.Data + Piece, t);
+}
+
+// note: unit direction of travel
+svg_v2
+SvgTangentAt(svg_path_measure *M, r32 Distance)
+{
+    u32 Piece;
+    r32 t;
+    if (!SvgMeasureLocate(M, Distance, &Piece, &t)) {
+        return {1.0f, 0.0f};
+    }
+
+    return SvgSegmentTangent(M->Pieces.Data + Piece, t);
+}
+
+// note: appends the part of the piece between t0 and t1, keeping the end points of the piece exact
+internal void
+SvgDashPiece(svg_path *Out, svg_path_segement *S, r32 t0, r32 t1)
+{
+    svg_path_segement Result = *S;
+    svg_path_segement Unused;
+
+    if (t0 > 0.0f) {
+        SvgSplitSegment(S, t0, &Unused, &Result);
+    }
+
+    if (t1 < 1.0f) {
+        svg_path_segement Rest = Result;
+        SvgSplitSegment(&Rest, (t1 - t0) / (1.0f - t0), &Result, &Unused);
+    }
+
+    SvgPushSegment(Out, Result);
+}
+
+// note: appends the path between two distances as one contour, a zero length dash becomes a point
+internal void
+SvgDashRange(svg_path_measure *M, svg_measured_contour *Contour, r32 From, r32 To, svg_path *Out)
+{
+    u32 Piece0, Piece1;
+    r32 t0, t1;
+    SvgMeasureFind(M, Contour->FirstSample, Contour->SampleCount, From, true, &Piece0, &t0);
+    SvgMeasureFind(M, Contour->FirstSample, Contour->SampleCount, To, false, &Piece1, &t1);
+
+    if (From >= To) {
+        svg_v2 P = SvgSegmentAt(M->Pieces.Data + Piece0, t0);
+        SvgAddLineSegment(Out, P, P);
+        return;
+    }
+
+    if (Piece0 == Piece1) {
+        SvgDashPiece(Out, M->Pieces.Data + Piece0, t0, t1);
+        return;
+    }
+
+    SvgDashPiece(Out, M->Pieces.Data + Piece0, t0, 1.0f);
+    for (u32 i=Piece0 + 1; i<Piece1; ++i) {
+        SvgPushSegment(Out, M->Pieces.Data[i]);
+    }
+    SvgDashPiece(Out, M->Pieces.Data + Piece1, 0.0f, t1);
+}
+
+/*  Cuts the measured path into dashes and appends them to Out. Dashes alternate on and off, an odd
+    count is repeated once to make it even (svg spec). Offset shifts the pattern along the path. A
+    dash running over the start of a closed contour continues into the first dash so the stroke
+    gets a join there instead of two caps. A pattern with no length appends the path unchanged. */
+void
+SvgDashPath(svg_path_measure *M, r32 *Dashes, u32 DashCount, r32 Offset, svg_path *Out)
+{
+    u32 PatternCount = (DashCount & 1) ? 2 * DashCount : DashCount;
+    r32 Pattern = 0.0f;
+    for (u32 i=0; i<PatternCount; ++i) {
+        Pattern += Dashes[i % DashCount];
+    }
+
+    for (u32 c=0; c<M->Contours.Count; ++c) {
+        svg_measured_contour *Contour = M->Contours.Data + c;
+        r32 Start = Contour->Start;
+        r32 End = Contour->Start + Contour->Length;
+
+        if (!(Pattern > 0.0f)) {
+            SvgBeginSubpath(Out);
+            for (u32 i=0; i<Contour->PieceCount; ++i) {
+                SvgPushSegment(Out, M->Pieces.Data[Contour->FirstPiece + i]);
+            }
+            if (Contour->Closed) {
+                SvgCloseSubpath(Out);
+            }
+            continue;
+        }
+
+        // note: where in the pattern the contour starts
+        r32 Phase = fmodf(Offset, Pattern);
+        if (Phase < 0.0f) {
+            Phase += Pattern;
+        }
+
+        u32 Index = 0;
+        while (Phase > 0.0f && Phase >= Dashes[Index % DashCount]) {
+            Phase -= Dashes[Index % DashCount];
+            Index = (Index + 1) % PatternCount;
+        }
+
+        r32 Left = Dashes[Index % DashCount] - Phase;
+        b32 Wrap = Contour->Closed && !(Index & 1);
+        r32 WrapEnd = Start;
+
+        for (r32 At = Start; At < End; ) {
+            r32 DashEnd = (At + Left < End) ? At + Left : End;
+            if (Left > 0.0f && DashEnd == At) {
+                // note: the dashes are too short for float precision this far along the path
+                break;
+            }
+
+            if (!(Index & 1)) {
+                if (Wrap && At == Start) {
+                    // note: the first dash is written last, behind the dash it continues
+                    WrapEnd = DashEnd;
+                } else {
+                    // note: every dash is an open subpath, even where a zero length gap joins two
+                    SvgBeginSubpath(Out);
+                    SvgDashRange(M, Contour, At, DashEnd, Out);
+                    if (Wrap && DashEnd == End) {
+                        SvgDashRange(M, Contour, Start, WrapEnd, Out);
+                        Wrap = false;
+                    }
+                }
+            }
+
+            At = DashEnd;
+            Index = (Index + 1) % PatternCount;
+            Left = Dashes[Index % DashCount];
+        }
+
+        if (Wrap) {
+            // the whole contour is one dash, or the last dash stops short of the end
+            SvgBeginSubpath(Out);
+            SvgDashRange(M, Contour, Start, WrapEnd, Out);
+            if (WrapEnd >= End) {
+                SvgCloseSubpath(Out);
+            }
+        }
+    }
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_MEASURE
@@ -0,0 +1,334 @@
+#ifndef INCLUDE_GUARD_LS_SVG_PACK
+#define INCLUDE_GUARD_LS_SVG_PACK
+
+/*  Compact path encoding for keeping large icon libraries resident.
+
+    Every path gets its own grid, cells a power of two path units wide, centered on multiples of
+    that. Points are stored as grid cells, each one a zig-zag varint delta from the previous
+    point, so nearby points take a byte or two per coordinate. The first point is a delta from cell
+    0, which makes it the absolute position of the path and leaves nothing else to store per path.
+
+    A path's bytes are a varint with the size of the rest, nothing more for an empty path. Then the
+    exponent of the cell size as a zig-zag varint, a varint with the segment count, a verb byte per
+    segment and the points. The verb says what follows: the segment type, whether it starts a
+    subpath (its start point is stored, otherwise it is the previous end point), whether it ends a
+    closed one and the arc flags. Arcs store their radii in grid cells and the angle in 1/64
+    degrees.
+
+    Paths follow each other in one byte array. Only every SVG_PACK_BLOCK-th path has its offset
+    stored, the ones in between are found by skipping over sizes.
+
+    Decoding is a forward iterator that produces svg_path_segement values on the fly. Contour
+    continuity survives exactly, start and end points are computed from the same grid cell. */
+
+#define SVG_PACK_MOVE (1 << 2)
+#define SVG_PACK_LARGE_ARC (1 << 3)
+#define SVG_PACK_CLOCKWISE (1 << 4)
+#define SVG_PACK_CLOSE (1 << 5)
+
+// note: grid cells are clamped to +-2^SVG_PACK_GRID_BITS, which keeps the deltas inside s32
+#define SVG_PACK_GRID_BITS 29
+
+// note: paths per stored offset, finding a path skips over at most SVG_PACK_BLOCK - 1 others
+#define SVG_PACK_BLOCK 16
+
+struct svg_pack {
+    svg_array<u32> Blocks; // offset into Bytes of every SVG_PACK_BLOCK-th path
+    svg_array<u8> Bytes;
+    u32 PathCount;
+};
+
+struct svg_unpacker {
+    r32 Quantum; // grid cell size in path units
+    u8 *Verbs;
+    u8 *At;
+    u32 Index;
+    u32 SegmentCount;
+    u8 Verb; // of the last segment, for its subpath flags
+    s32 X, Y; // grid cell of the current point
+};
+
+inline u32 SvgZigZag(s32 Value) { return ((u32)Value << 1) ^ (u32)(Value >> 31); }
+inline s32 SvgUnZigZag(u32 Value) { return (s32)(Value >> 1) ^ -(s32)(Value & 1); }
+
+// note: writes Value to Out, at most 5 bytes, returns how many
+inline u32
+SvgVarintBytes(u8 *Out, u32 Value)
+{
+    u32 Count = 0;
+    while (Value >= 0x80) {
+        Out[Count++] = (u8)(Value | 0x80);
+        Value >>= 7;
+    }
+    Out[Count++] = (u8)Value;
+
+    return Count;
+}
+
+internal void
+SvgPackVarint(svg_array<u8> *Bytes, u32 Value)
+{
+    u8 Varint[5];
+    u32 Count = SvgVarintBytes(Varint, Value);
+    memcpy(Bytes->AllocN(Count), Varint, Count);
+}
+
+inline u32
+SvgUnpackVarint(u8 **At)
+{
+    u8 *P = *At;
+    u32 Result = *P & 0x7f;
+    u32 Shift = 7;
+
+    while (*P++ & 0x80) {
+        Result |= (u32)(*P & 0x7f) << Shift;
+        Shift += 7;
+    }
+
+    *At = P;
+    return Result;
+}
+
+// note: grid cell of P, clamped so deltas stay in range for any input
+inline s32
+SvgPackCell(r32 Value, r32 Quantum)
+{
+    r32 Cell = floorf(Value / Quantum + 0.5f);
+    r32 Max = (r32)(1 << SVG_PACK_GRID_BITS);
+    return (s32)SvgMin(SvgMax(Cell, -Max), Max);
+}
+
+internal void
+SvgPackPoint(svg_array<u8> *Bytes, svg_v2 P, r32 Quantum, s32 *X, s32 *Y)
+{
+    s32 CellX = SvgPackCell(P.x, Quantum);
+    s32 CellY = SvgPackCell(P.y, Quantum);
+
+    SvgPackVarint(Bytes, SvgZigZag(CellX - *X));
+    SvgPackVarint(Bytes, SvgZigZag(CellY - *Y));
+
+    *X = CellX;
+    *Y = CellY;
+}
+
+/*  Appends Path to the pack and returns its index. Quantum is the grid cell size in path units,
+    rounded down to a power of two, the largest error is half of it per axis. With Quantum 0 the
+    cell size is the power of two nearest to 1/65536 of the larger side of the bounds, which keeps
+    most coordinates in two or three bytes. */
+u32
+SvgPackPath(svg_pack *Pack, svg_path *Path, r32 Quantum)
+{
+    if (Pack->PathCount % SVG_PACK_BLOCK == 0) {
+        Pack->Blocks.Push(Pack->Bytes.Count);
+    }
+
+    if (!Path->Segments.Count) {
+        SvgPackVarint(&Pack->Bytes, 0);
+        return Pack->PathCount++;
+    }
+
+    // note: the first point is in absolute cells, the grid has to reach the farthest coordinate
+    svg_bounds B = Path->Bounds;
+    r32 Extent = SvgMax(B.Max.x - B.Min.x, B.Max.y - B.Min.y);
+    r32 Farthest = SvgMax(SvgMax(fabsf(B.Min.x), fabsf(B.Max.x)), SvgMax(fabsf(B.Min.y), fabsf(B.Max.y)));
+    if (Quantum <= 0.0f) {
+        // note: rounded down below, this makes it the nearest power of two
+        Quantum = Extent / 65536.0f * 1.41421356f;
+    }
+    Quantum = SvgMax(SvgMax(Quantum, Farthest / (r32)(1 << (SVG_PACK_GRID_BITS - 1))), 1e-30f);
+
+    // note: 2^(Exponent - 1) <= Quantum < 2^Exponent
+    s32 Exponent;
+    frexpf(Quantum, &Exponent);
+    Exponent -= 1;
+    Quantum = ldexpf(1.0f, Exponent);
+
+    u32 Start = Pack->Bytes.Count;
+    SvgPackVarint(&Pack->Bytes, SvgZigZag(Exponent));
+    SvgPackVarint(&Pack->Bytes, Path->Segments.Count);
+
+    svg_path_segement *Segments = Path->Segments.Data;
+    u32 Verbs = Pack->Bytes.Count;
+
+    u32 At = 0;
+    svg_contour Contour;
+    while (SvgNextContour(Path, &At, &Contour)) {
+        for (u32 i=0; i<Contour.Count; ++i) {
+            svg_path_segement *S = Contour.Segments + i;
+            u8 Verb = (u8)S->Type;
+
+            Verb |= (i == 0) ? SVG_PACK_MOVE : 0;
+            Verb |= (Contour.Closed && i == Contour.Count - 1) ? SVG_PACK_CLOSE : 0;
+            if (S->Type == SvgSegment_Elliptical) {
+                Verb |= S->UseLargeArc ? SVG_PACK_LARGE_ARC : 0;
+                Verb |= S->Clockwise ? SVG_PACK_CLOCKWISE : 0;
+            }
+
+            Pack->Bytes.Push(Verb);
+        }
+    }
+
+    s32 X = 0;
+    s32 Y = 0;
+
+    for (u32 i=0; i<Path->Segments.Count; ++i) {
+        svg_path_segement *S = Segments + i;
+
+        if (Pack->Bytes.Data[Verbs + i] & SVG_PACK_MOVE) {
+            SvgPackPoint(&Pack->Bytes, S->P1, Quantum, &X, &Y);
+        }
+
+        switch (S->Type) {
+            case SvgSegment_QuadraticBezier: {
+                SvgPackPoint(&Pack->Bytes, S->C1, Quantum, &X, &Y);
+            } break;
+            case SvgSegment_CubicBezier: {
+                SvgPackPoint(&Pack->Bytes, S->C1, Quantum, &X, &Y);
+                SvgPackPoint(&Pack->Bytes, S->C2, Quantum, &X, &Y);
+            } break;
+            case SvgSegment_Elliptical: {
+                SvgPackVarint(&Pack->Bytes, (u32)SvgPackCell(fabsf(S->Rx), Quantum));
+                SvgPackVarint(&Pack->Bytes, (u32)SvgPackCell(fabsf(S->Ry), Quantum));
+                SvgPackVarint(&Pack->Bytes, SvgZigZag((s32)floorf(S->Angle * 64.0f + 0.5f)));
+            } break;
+            default: break;
+        }
+
+        SvgPackPoint(&Pack->Bytes, S->P2, Quantum, &X, &Y);
+    }
+
+    // note: the size goes in front of what it measures, which is only known now
+    u32 Size = Pack->Bytes.Count - Start;
+    u8 Varint[5];
+    u32 VarintSize = SvgVarintBytes(Varint, Size);
+    Pack->Bytes.AllocN(VarintSize);
+    memmove(Pack->Bytes.Data + Start + VarintSize, Pack->Bytes.Data + Start, Size);
+    memcpy(Pack->Bytes.Data + Start, Varint, VarintSize);
+
+    return Pack->PathCount++;
+}
+
+// note: packs every element so pack indices match element indices, elements without a path are empty
+void
+SvgPackSvg(svg_pack *Pack, svg *Svg, r32 Quantum)
+{
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+
+        if (E->Type == SvgElement_Path) {
+            SvgPackPath(Pack, SvgElementPath(Svg, E), Quantum);
+        } else {
+            svg_path Empty = {};
+            SvgPackPath(Pack, &Empty, Quantum);
+        }
+    }
+}
+
+inline svg_unpacker
+SvgUnpacker(svg_pack *Pack, u32 Index)
+{
+    svg_unpacker Result = {};
+
+    u8 *At = Pack->Bytes.Data + Pack->Blocks.Data[Index / SVG_PACK_BLOCK];
+    for (u32 i=0; i<Index % SVG_PACK_BLOCK; ++i) {
+        u32 Size = SvgUnpackVarint(&At);
+        At += Size;
+    }
+
+    if (SvgUnpackVarint(&At)) {
+        Result.Quantum = ldexpf(1.0f, SvgUnZigZag(SvgUnpackVarint(&At)));
+        Result.SegmentCount = SvgUnpackVarint(&At);
+        Result.Verbs = At;
+        Result.At = At + Result.SegmentCount;
+    }
+
+    return Result;
+}
+
+inline svg_v2
+SvgUnpackPoint(svg_unpacker *U)
+{
+    U->X += SvgUnZigZag(SvgUnpackVarint(&U->At));
+    U->Y += SvgUnZigZag(SvgUnpackVarint(&U->At));
+
+    return {U->X * U->Quantum, U->Y * U->Quantum};
+}
+
+// note: next segment of the path, false after the last one
+b32
+SvgUnpackNext(svg_unpacker *U, svg_path_segement *Out)
+{
+    if (U->Index >= U->SegmentCount) {
+        return false;
+    }
+
+    u8 Verb = U->Verbs[U->Index++];
+    U->Verb = Verb;
+
+    svg_v2 Start = {U->X * U->Quantum, U->Y * U->Quantum};
+    if (Verb & SVG_PACK_MOVE) {
+        Start = SvgUnpackPoint(U);
+    }
+
+    Out->Type = (svg_segment_)(Verb & 3);
+    Out->P1 = Start;
+
+    switch (Out->Type) {
+        case SvgSegment_QuadraticBezier: {
+            Out->C1 = SvgUnpackPoint(U);
+        } break;
+        case SvgSegment_CubicBezier: {
+            Out->C1 = SvgUnpackPoint(U);
+            Out->C2 = SvgUnpackPoint(U);
+        } break;
+        case SvgSegment_Elliptical: {
+            Out->Rx = SvgUnpackVarint(&U->At) * U->Quantum;
+            Out->Ry = SvgUnpackVarint(&U->At) * U->Quantum;
+            Out->Angle = SvgUnZigZag(SvgUnpackVarint(&U->At)) * (1.0f / 64.0f);
+            Out->UseLargeArc = !!(Verb & SVG_PACK_LARGE_ARC);
+            Out->Clockwise = !!(Verb & SVG_PACK_CLOCKWISE);
+        } break;
+        default: break;
+    }
+
+    Out->P2 = SvgUnpackPoint(U);
+
+    return true;
+}
+
+// note: appends the decoded segments of a packed path to Out, with its subpaths
+void
+SvgUnpackPath(svg_pack *Pack, u32 Index, svg_path *Out)
+{
+    svg_unpacker U = SvgUnpacker(Pack, Index);
+    svg_path_segement S;
+
+    while (SvgUnpackNext(&U, &S)) {
+        if (U.Verb & SVG_PACK_MOVE) {
+            SvgBeginSubpath(Out);
+        }
+
+        SvgPushSegment(Out, S);
+
+        if (U.Verb & SVG_PACK_CLOSE) {
+            SvgCloseSubpath(Out);
+        }
+    }
+}
+
+// note: encoded size of the whole pack, the block offsets included
+inline size_t
+SvgPackedSize(svg_pack *Pack)
+{
+    return Pack->Blocks.Count * sizeof(u32) + Pack->Bytes.Count;
+}
+
+void
+SvgPackFree(svg_pack *Pack)
+{
+    Pack->Blocks.Free();
+    Pack->Bytes.Free();
+    *Pack = {};
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_PACK
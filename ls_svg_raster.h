@@ -0,0 +1,500 @@
+#ifndef INCLUDE_GUARD_LS_SVG_RASTER
+#define INCLUDE_GUARD_LS_SVG_RASTER
+
+/*  Anti-aliased scanline rasterizer.
+
+    Paths are flattened in device space and every line deposits its exact signed area into a grid
+    of cells (one row is Width + 2 cells, the extra ones take the spill of the right edge). A prefix
+    sum along a row turns the cells into winding-weighted coverage, which the fill rule maps to alpha.
+    The prefix sum pass also clears the cells, so the grid is always zero between fills. */
+
+#if defined(__AVX2__)
+#define LS_SVG_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LS_SVG_SSE2
+#endif
+
+#if defined(LS_SVG_AVX2) || defined(LS_SVG_SSE2)
+#include <immintrin.h>
+#endif
+
+#define SVG_RASTER_TOLERANCE 0.2f
+
+struct svg_image {
+    u8 *Pixels; // premultiplied RGBA8
+    u32 Width;
+    u32 Height;
+    u32 Pitch;
+};
+
+// note: columns [MinX, MaxX) of a cell row that lines have touched, everything else is zero
+struct svg_row_extent {
+    s32 MinX;
+    s32 MaxX;
+};
+
+// note: scratch memory, keep it around between calls
+struct svg_rasterizer {
+    svg_array<r32> Cells;
+    svg_array<svg_row_extent> Rows;
+    svg_array<u8> Coverage;
+    svg_polyline Polyline;
+
+    s32 Width;
+    s32 Height;
+
+    // note: rows [MinRow, MaxRow) have been touched since the last resolve
+    s32 MinRow;
+    s32 MaxRow;
+};
+
+internal void
+SvgRasterizerBegin(svg_rasterizer *R, s32 Width, s32 Height)
+{
+    u32 CellCount = (Width + 2) * Height;
+
+    if (R->Cells.Count < CellCount) {
+        u32 Old = R->Cells.Count;
+        R->Cells.AllocN(CellCount - Old);
+        memset(R->Cells.Data + Old, 0, (CellCount - Old) * sizeof(r32));
+    }
+
+    if (R->Rows.Count < (u32)Height) {
+        u32 Old = R->Rows.Count;
+        R->Rows.AllocN(Height - Old);
+        for (u32 i=Old; i<(u32)Height; ++i) {
+            R->Rows.Data[i] = {0x7fffffff, 0};
+        }
+    }
+
+    // note: padded so the blend kernel can always read whole groups of pixels
+    if (R->Coverage.Count < (u32)Width + 8) {
+        R->Coverage.AllocN(Width + 8 - R->Coverage.Count);
+    }
+
+    R->Width = Width;
+    R->Height = Height;
+    R->MinRow = Height;
+    R->MaxRow = 0;
+}
+
+// note: x has to be within [0, Width]
+internal void
+SvgAccumulateClippedLine(svg_rasterizer *R, svg_v2 P0, svg_v2 P1)
+{
+    if (P0.y == P1.y) {
+        return;
+    }
+
+    r32 Dir = 1.0f;
+    if (P0.y > P1.y) {
+        svg_v2 Tmp = P0;
+        P0 = P1;
+        P1 = Tmp;
+        Dir = -1.0f;
+    }
+
+    s32 Stride = R->Width + 2;
+    r32 Right = (r32)R->Width;
+    r32 DxDy = (P1.x - P0.x) / (P1.y - P0.y);
+    r32 X = P0.x;
+    s32 Y0 = (s32)floorf(P0.y);
+
+    if (P0.y < 0.0f) {
+        X -= P0.y * DxDy;
+        Y0 = 0;
+    }
+
+    s32 Y1 = (s32)ceilf(P1.y);
+    if (Y1 > R->Height) {
+        Y1 = R->Height;
+    }
+
+    if (Y0 < Y1) {
+        if (Y0 < R->MinRow) R->MinRow = Y0;
+        if (Y1 > R->MaxRow) R->MaxRow = Y1;
+    }
+
+    for (s32 y=Y0; y<Y1; ++y) {
+        r32 *Row = R->Cells.Data + y * Stride;
+        svg_row_extent *Extent = R->Rows.Data + y;
+
+        r32 Dy = SvgMin((r32)(y + 1), P1.y) - SvgMax((r32)y, P0.y);
+        r32 XNext = X + DxDy * Dy;
+        r32 D = Dy * Dir;
+
+        // note: stepping X accumulates rounding, lines ending on a border can drift just past it
+        r32 X0 = SvgMax(SvgMin(X, XNext), 0.0f);
+        r32 X1 = SvgMin(SvgMax(X, XNext), Right);
+        r32 X0Floor = floorf(X0);
+        s32 X0i = (s32)X0Floor;
+        r32 X1Ceil = ceilf(X1);
+        s32 X1i = (s32)X1Ceil;
+
+        if (X0i < Extent->MinX) Extent->MinX = X0i;
+        if (X1i + 1 > Extent->MaxX) Extent->MaxX = X1i + 1;
+        if (X0i + 2 > Extent->MaxX) Extent->MaxX = X0i + 2;
+
+        if (X1i <= X0i + 1) {
+            // note: the line stays within one pixel column on this row
+            r32 XMid = 0.5f * (X + XNext) - X0Floor;
+            Row[X0i] += D - D * XMid;
+            Row[X0i + 1] += D * XMid;
+        } else {
+            r32 S = 1.0f / (X1 - X0);
+            r32 X0f = X0 - X0Floor;
+            r32 A0 = 0.5f * S * (1.0f - X0f) * (1.0f - X0f);
+            r32 X1f = X1 - X1Ceil + 1.0f;
+            r32 Am = 0.5f * S * X1f * X1f;
+
+            Row[X0i] += D * A0;
+
+            if (X1i == X0i + 2) {
+                Row[X0i + 1] += D * (1.0f - A0 - Am);
+            } else {
+                r32 A1 = S * (1.5f - X0f);
+                Row[X0i + 1] += D * (A1 - A0);
+
+                for (s32 x=X0i + 2; x<X1i - 1; ++x) {
+                    Row[x] += D * S;
+                }
+
+                r32 A2 = A1 + (X1i - X0i - 3) * S;
+                Row[X1i - 1] += D * (1.0f - A2 - Am);
+            }
+
+            Row[X1i] += D * Am;
+        }
+
+        X = XNext;
+    }
+}
+
+// note: parts of the line outside [0, Width] are replaced by vertical lines on the border,
+//       which leaves the coverage of every pixel inside unchanged
+internal void
+SvgAccumulateLine(svg_rasterizer *R, svg_v2 P0, svg_v2 P1)
+{
+    r32 Right = (r32)R->Width;
+
+    if (P0.x >= 0.0f && P0.x <= Right && P1.x >= 0.0f && P1.x <= Right) {
+        SvgAccumulateClippedLine(R, P0, P1);
+        return;
+    }
+
+    r32 Splits[4] = {0.0f};
+    u32 SplitCount = 1;
+    r32 Dx = P1.x - P0.x;
+
+    if (Dx != 0.0f) {
+        r32 T0 = (0.0f - P0.x) / Dx;
+        r32 T1 = (Right - P0.x) / Dx;
+        if (T0 > T1) {
+            r32 Tmp = T0;
+            T0 = T1;
+            T1 = Tmp;
+        }
+
+        if (T0 > 0.0f && T0 < 1.0f) Splits[SplitCount++] = T0;
+        if (T1 > 0.0f && T1 < 1.0f) Splits[SplitCount++] = T1;
+    }
+
+    Splits[SplitCount] = 1.0f;
+
+    svg_v2 A = P0;
+    for (u32 i=0; i<SplitCount; ++i) {
+        svg_v2 B = (i == SplitCount - 1) ? P1 : SvgLerp(P0, P1, Splits[i + 1]);
+        svg_v2 Ca = {SvgMin(SvgMax(A.x, 0.0f), Right), A.y};
+        svg_v2 Cb = {SvgMin(SvgMax(B.x, 0.0f), Right), B.y};
+
+        SvgAccumulateClippedLine(R, Ca, Cb);
+        A = B;
+    }
+}
+
+// note: prefix sums Count cells into 8-bit coverage and clears them
+internal void
+SvgAccumulateCoverage(r32 *Cells, u8 *Coverage, u32 Count, svg_fill_rule_ Rule)
+{
+    u32 i = 0;
+    r32 Sum = 0.0f;
+
+#if defined(LS_SVG_AVX2)
+    __m256 Offset = _mm256_setzero_ps();
+    __m256 SignMask = _mm256_set1_ps(-0.0f);
+    __m256 One = _mm256_set1_ps(1.0f);
+    __m256 Half = _mm256_set1_ps(0.5f);
+    __m256 Two = _mm256_set1_ps(2.0f);
+    __m256 Max = _mm256_set1_ps(255.0f);
+
+    for (; i + 8 <= Count; i += 8) {
+        __m256 X = _mm256_loadu_ps(Cells + i);
+        _mm256_storeu_ps(Cells + i, _mm256_setzero_ps());
+
+        // prefix sum within both 128-bit lanes, then carry the low lane total into the high lane
+        X = _mm256_add_ps(X, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(X), 4)));
+        X = _mm256_add_ps(X, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(X), 8)));
+        __m256 LaneTotal = _mm256_permute_ps(X, _MM_SHUFFLE(3, 3, 3, 3));
+        X = _mm256_add_ps(X, _mm256_permute2f128_ps(LaneTotal, LaneTotal, 0x08));
+        X = _mm256_add_ps(X, Offset);
+
+        __m256 Last = _mm256_permute_ps(X, _MM_SHUFFLE(3, 3, 3, 3));
+        Offset = _mm256_permute2f128_ps(Last, Last, 0x11);
+
+        __m256 A = _mm256_andnot_ps(SignMask, X);
+        if (Rule == SvgFillRule_EvenOdd) {
+            __m256 Floor = _mm256_floor_ps(_mm256_mul_ps(A, Half));
+            A = _mm256_sub_ps(A, _mm256_mul_ps(Floor, Two));
+            A = _mm256_sub_ps(One, _mm256_andnot_ps(SignMask, _mm256_sub_ps(One, A)));
+        } else {
+            A = _mm256_min_ps(A, One);
+        }
+
+        __m256i Int = _mm256_cvtps_epi32(_mm256_mul_ps(A, Max));
+        __m128i Packed = _mm_packs_epi32(_mm256_castsi256_si128(Int), _mm256_extracti128_si256(Int, 1));
+        Packed = _mm_packus_epi16(Packed, Packed);
+        _mm_storel_epi64((__m128i *)(Coverage + i), Packed);
+    }
+
+    Sum = _mm256_cvtss_f32(Offset);
+#elif defined(LS_SVG_SSE2)
+    __m128 Offset = _mm_setzero_ps();
+    __m128 SignMask = _mm_set1_ps(-0.0f);
+    __m128 One = _mm_set1_ps(1.0f);
+    __m128 Half = _mm_set1_ps(0.5f);
+    __m128 Two = _mm_set1_ps(2.0f);
+    __m128 Max = _mm_set1_ps(255.0f);
+
+    for (; i + 4 <= Count; i += 4) {
+        __m128 X = _mm_loadu_ps(Cells + i);
+        _mm_storeu_ps(Cells + i, _mm_setzero_ps());
+
+        X = _mm_add_ps(X, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(X), 4)));
+        X = _mm_add_ps(X, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(X), 8)));
+        X = _mm_add_ps(X, Offset);
+        Offset = _mm_shuffle_ps(X, X, _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m128 A = _mm_andnot_ps(SignMask, X);
+        if (Rule == SvgFillRule_EvenOdd) {
+            // note: A is positive so truncation is floor
+            __m128 Floor = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(A, Half)));
+            A = _mm_sub_ps(A, _mm_mul_ps(Floor, Two));
+            A = _mm_sub_ps(One, _mm_andnot_ps(SignMask, _mm_sub_ps(One, A)));
+        } else {
+            A = _mm_min_ps(A, One);
+        }
+
+        __m128i Int = _mm_cvtps_epi32(_mm_mul_ps(A, Max));
+        Int = _mm_packs_epi32(Int, Int);
+        Int = _mm_packus_epi16(Int, Int);
+        *(u32 *)(Coverage + i) = (u32)_mm_cvtsi128_si32(Int);
+    }
+
+    Sum = _mm_cvtss_f32(Offset);
+#endif
+
+    for (; i<Count; ++i) {
+        Sum += Cells[i];
+        Cells[i] = 0.0f;
+
+        r32 A = fabsf(Sum);
+        if (Rule == SvgFillRule_EvenOdd) {
+            A -= 2.0f * floorf(A * 0.5f);
+            A = 1.0f - fabsf(1.0f - A);
+        } else {
+            A = SvgMin(A, 1.0f);
+        }
+
+        Coverage[i] = (u8)(A * 255.0f + 0.5f);
+    }
+}
+
+inline u32
+SvgMul255(u32 A, u32 B)
+{
+    u32 X = A * B + 128;
+    return (X + (X >> 8)) >> 8;
+}
+
+#if defined(LS_SVG_SSE2) || defined(LS_SVG_AVX2)
+// note: SvgMul255 on 16-bit lanes
+inline __m128i
+SvgMul255x8(__m128i A, __m128i B)
+{
+    __m128i X = _mm_add_epi16(_mm_mullo_epi16(A, B), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(X, _mm_srli_epi16(X, 8)), 8);
+}
+#endif
+
+// note: source-over of a straight alpha color into premultiplied pixels
+internal void
+SvgBlendRow(u8 *Dest, u8 *Coverage, u32 Count, u32 Color)
+{
+    u32 R = (Color >> 24) & 0xff;
+    u32 G = (Color >> 16) & 0xff;
+    u32 B = (Color >> 8) & 0xff;
+    u32 A = Color & 0xff;
+    u32 i = 0;
+
+#if defined(LS_SVG_SSE2) || defined(LS_SVG_AVX2)
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Max = _mm_set1_epi16(255);
+    __m128i Alpha = _mm_set1_epi16((s16)A);
+    __m128i Source = _mm_setr_epi16((s16)R, (s16)G, (s16)B, 255, (s16)R, (s16)G, (s16)B, 255);
+    u32 Solid = R | (G << 8) | (B << 16) | (0xffu << 24);
+
+    for (; i + 4 <= Count; i += 4, Dest += 16) {
+        u32 Group = *(u32 *)(Coverage + i);
+
+        if (Group == 0) {
+            continue;
+        } else if (Group == 0xffffffff && A == 255) {
+            __m128i Fill = _mm_set1_epi32((s32)Solid);
+            _mm_storeu_si128((__m128i *)Dest, Fill);
+            continue;
+        }
+
+        // spread the 4 coverage bytes over the 4 channels of their pixel
+        __m128i C = _mm_unpacklo_epi8(_mm_cvtsi32_si128((s32)Group), Zero);
+        C = _mm_unpacklo_epi16(C, C);
+        __m128i CLo = _mm_unpacklo_epi32(C, C);
+        __m128i CHi = _mm_unpackhi_epi32(C, C);
+
+        __m128i ALo = SvgMul255x8(Alpha, CLo);
+        __m128i AHi = SvgMul255x8(Alpha, CHi);
+
+        __m128i Pixels = _mm_loadu_si128((__m128i *)Dest);
+        __m128i DLo = _mm_unpacklo_epi8(Pixels, Zero);
+        __m128i DHi = _mm_unpackhi_epi8(Pixels, Zero);
+
+        DLo = _mm_add_epi16(SvgMul255x8(Source, ALo), SvgMul255x8(DLo, _mm_sub_epi16(Max, ALo)));
+        DHi = _mm_add_epi16(SvgMul255x8(Source, AHi), SvgMul255x8(DHi, _mm_sub_epi16(Max, AHi)));
+
+        _mm_storeu_si128((__m128i *)Dest, _mm_packus_epi16(DLo, DHi));
+    }
+#endif
+
+    for (; i<Count; ++i, Dest += 4) {
+        u32 C = Coverage[i];
+
+        if (!C) {
+            continue;
+        }
+
+        u32 Alpha = SvgMul255(A, C);
+
+        if (Alpha == 255) {
+            Dest[0] = (u8)R;
+            Dest[1] = (u8)G;
+            Dest[2] = (u8)B;
+            Dest[3] = 255;
+        } else {
+            u32 Inv = 255 - Alpha;
+            Dest[0] = (u8)(SvgMul255(R, Alpha) + SvgMul255(Dest[0], Inv));
+            Dest[1] = (u8)(SvgMul255(G, Alpha) + SvgMul255(Dest[1], Inv));
+            Dest[2] = (u8)(SvgMul255(B, Alpha) + SvgMul255(Dest[2], Inv));
+            Dest[3] = (u8)(Alpha + SvgMul255(Dest[3], Inv));
+        }
+    }
+}
+
+/*  Turns the accumulated cells into coverage and composites it into Image. The grid covers the image
+    rectangle starting at (OriginX, OriginY), which lets tiles reuse the same code. With OpenRight the
+    row sums aren't known to return to zero, the coverage at the end of the extent then carries on
+    to the right border. */
+void
+SvgRasterResolve(svg_rasterizer *R, svg_fill_rule_ Rule, u32 Color, svg_image *Image,
+                 s32 OriginX, s32 OriginY, b32 OpenRight)
+{
+    s32 Stride = R->Width + 2;
+    u8 *Coverage = R->Coverage.Data;
+
+    for (s32 y=R->MinRow; y<R->MaxRow; ++y) {
+        svg_row_extent *Extent = R->Rows.Data + y;
+        s32 X0 = Extent->MinX;
+        s32 X1 = Extent->MaxX;
+
+        if (X1 <= X0) {
+            continue;
+        }
+
+        // note: closed contours sum to zero over a row, so nothing right of the extent is covered
+        SvgAccumulateCoverage(R->Cells.Data + y * Stride + X0, Coverage, X1 - X0, Rule);
+
+        s32 VisibleX1 = (X1 < R->Width) ? X1 : R->Width;
+        if (OpenRight && X1 < R->Width && Coverage[X1 - X0 - 1]) {
+            memset(Coverage + X1 - X0, Coverage[X1 - X0 - 1], R->Width - X1);
+            VisibleX1 = R->Width;
+        }
+
+        if (VisibleX1 > X0) {
+            u8 *Dest = Image->Pixels + (OriginY + y) * Image->Pitch + (OriginX + X0) * 4;
+            SvgBlendRow(Dest, Coverage, VisibleX1 - X0, Color);
+        }
+
+        *Extent = {0x7fffffff, 0};
+    }
+
+    R->MinRow = R->Height;
+    R->MaxRow = 0;
+}
+
+// note: contours are closed implicitly
+void
+SvgRasterAccumulatePolyline(svg_rasterizer *R, svg_polyline *Polyline)
+{
+    u32 Start = 0;
+    svg_v2 *Points = Polyline->Points.Data;
+
+    for (u32 c=0; c<Polyline->ContourEnds.Count; ++c) {
+        u32 End = Polyline->ContourEnds.Data[c];
+
+        for (u32 i=Start; i<End; ++i) {
+            svg_v2 B = (i + 1 < End) ? Points[i + 1] : Points[Start];
+            SvgAccumulateLine(R, Points[i], B);
+        }
+
+        Start = End;
+    }
+}
+
+void
+SvgRasterizeElement(svg_rasterizer *R, svg *Svg, svg_element *E, svg_transform T, svg_image *Image)
+{
+    // note: the parser only produces paths
+    if (E->Type != SvgElement_Path || !(E->Fill & 0xff)) {
+        return;
+    }
+
+    svg_path *Path = SvgElementPath(Svg, E);
+    if (!Path->Segments.Count) {
+        return;
+    }
+
+    svg_bounds Bounds = SvgTransformBounds(T, Path->Bounds);
+    if (Bounds.Max.x < 0.0f || Bounds.Max.y < 0.0f || Bounds.Min.x >= R->Width || Bounds.Min.y >= R->Height) {
+        return;
+    }
+
+    R->Polyline.Points.Count = 0;
+    R->Polyline.ContourEnds.Count = 0;
+    SvgFlattenPath(Path, T, SVG_RASTER_TOLERANCE, &R->Polyline);
+
+    SvgRasterAccumulatePolyline(R, &R->Polyline);
+    SvgRasterResolve(R, E->FillRule, E->Fill, Image, 0, 0, false);
+}
+
+// note: composites over whatever is in Image, clear it first for a fresh render
+void
+SvgRasterize(svg_rasterizer *R, svg *Svg, svg_image *Image, svg_transform T)
+{
+    SvgRasterizerBegin(R, Image->Width, Image->Height);
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        SvgRasterizeElement(R, Svg, Svg->Elements.Data + i, T, Image);
+    }
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_RASTER
@@ -0,0 +1,652 @@
+#ifndef INCLUDE_GUARD_LS_SVG_SDF
+#define INCLUDE_GUARD_LS_SVG_SDF
+
+/*  Signed distance fields straight from the path geometry.
+
+    Every sample is the distance from the pixel center to the nearest edge of the element, positive
+    inside. Lines and quadratics are solved in closed form. For cubics the closest points are roots
+    of a quintic, each one is bracketed between the roots of its derivative, recursively down to a
+    line, and refined by Newton steps that fall back to bisection, so none is missed on loops and
+    cusps. The sign comes from the exact winding number, the crossings of each row
+    center with the edges are computed once per row and swept from left to right. Element bounds
+    skip elements that are farther away than Range or can't beat the current best sample.
+
+    The multi-channel variant colors the edges of every contour so that the two sides of a corner
+    never share all channels, each channel then stores the signed pseudo-distance to its nearest
+    edge. The median of the three channels keeps corners sharp when the field is magnified. Samples
+    where the median disagrees with the true sign fall back to the plain distance.
+
+    Elements are combined by taking the one with the largest signed distance at each sample. Rows
+    are generated in parallel on the job pool. */
+
+// note: sin of the smallest angle between two edges that still counts as a corner
+#define SVG_SDF_CORNER_CROSS 0.14f
+
+enum svg_sdf_color_ {
+    SvgSdfColor_Red = 1,
+    SvgSdfColor_Green = 2,
+    SvgSdfColor_Blue = 4,
+    SvgSdfColor_Cyan = SvgSdfColor_Green | SvgSdfColor_Blue,
+    SvgSdfColor_Magenta = SvgSdfColor_Red | SvgSdfColor_Blue,
+    SvgSdfColor_Yellow = SvgSdfColor_Red | SvgSdfColor_Green,
+    SvgSdfColor_White = SvgSdfColor_Red | SvgSdfColor_Green | SvgSdfColor_Blue,
+};
+
+// note: lines and beziers in field space, arcs are converted to cubics
+struct svg_sdf_edge {
+    svg_path_segement Segment;
+    svg_bounds Bounds;
+    u32 Color;
+    s32 Inside; // +1 if the filled side is left of the edge, -1 if right, 0 for edges inside the fill
+};
+
+struct svg_sdf_shape {
+    u32 FirstEdge;
+    u32 EdgeCount;
+    svg_bounds Bounds;
+    svg_fill_rule_ FillRule;
+};
+
+// note: 127.5 is the outline, 0 and 255 are Range field pixels outside and inside
+struct svg_field {
+    u8 *Pixels;
+    u32 Width;
+    u32 Height;
+    u32 Pitch;
+    u32 Channels; // 1 for SDF, 3 for MSDF
+};
+
+struct svg_sdf_crossing {
+    r32 X;
+    s32 Direction;
+};
+
+struct svg_sdf_scratch {
+    svg_array<r32> Best;
+    svg_array<r32> Channels;
+    svg_array<svg_sdf_crossing> Crossings;
+};
+
+// note: scratch memory, keep it around between calls
+struct svg_sdf_generator {
+    svg_array<svg_sdf_edge> Edges;
+    svg_array<svg_sdf_shape> Shapes;
+    svg_sdf_scratch Scratch[SVG_MAX_WORKERS];
+
+    svg_field *Field;
+    r32 Range;
+};
+
+/*  Roots of the polynomial with coefficients C (C[0] the constant) in (0, 1), ascending. Between two
+    roots of the derivative the polynomial is monotone, so every sign change there brackets exactly
+    one root. At most Degree roots, Degree up to 5. */
+internal u32
+SvgSdfPolyRoots(r64 *C, u32 Degree, r64 *Roots)
+{
+    while (Degree && C[Degree] == 0.0) {
+        --Degree;
+    }
+
+    if (Degree == 0) {
+        return 0;
+    }
+
+    if (Degree == 1) {
+        r64 t = -C[0] / C[1];
+        if (t > 0.0 && t < 1.0) {
+            Roots[0] = t;
+            return 1;
+        }
+        return 0;
+    }
+
+    r64 Derivative[5];
+    for (u32 i=0; i<Degree; ++i) {
+        Derivative[i] = (i + 1) * C[i + 1];
+    }
+
+    r64 Bounds[6];
+    u32 BoundCount = 1;
+    Bounds[0] = 0.0;
+    BoundCount += SvgSdfPolyRoots(Derivative, Degree - 1, Bounds + 1);
+    Bounds[BoundCount++] = 1.0;
+
+    u32 Count = 0;
+    r64 Fa = SvgPolyAt(C, Degree, 0.0);
+
+    for (u32 i=0; i + 1<BoundCount; ++i) {
+        r64 Lo = Bounds[i];
+        r64 Hi = Bounds[i + 1];
+        r64 Fb = SvgPolyAt(C, Degree, Hi);
+
+        if (Fa == 0.0 && Lo > 0.0) {
+            // note: a double root where the derivative vanishes too
+            Roots[Count++] = Lo;
+        } else if ((Fa < 0.0) != (Fb < 0.0) && Fb != 0.0) {
+            b32 Rising = (Fa < 0.0);
+            r64 t = 0.5 * (Lo + Hi);
+
+            for (u32 Step=0; Step<64; ++Step) {
+                r64 F = SvgPolyAt(C, Degree, t);
+                if (F == 0.0) {
+                    break;
+                }
+
+                if ((F < 0.0) == Rising) {
+                    Lo = t;
+                } else {
+                    Hi = t;
+                }
+
+                r64 Next = t - F / SvgPolyAt(Derivative, Degree - 1, t);
+                if (!(Next > Lo && Next < Hi)) {
+                    Next = 0.5 * (Lo + Hi);
+                }
+
+                if (fabs(Next - t) < 1e-12) {
+                    t = Next;
+                    break;
+                }
+                t = Next;
+            }
+
+            Roots[Count++] = t;
+        }
+
+        Fa = Fb;
+    }
+
+    return Count;
+}
+
+// note: closest parameter on the segment
+internal r32
+SvgSegmentClosest(svg_path_segement *S, svg_v2 P)
+{
+    r32 Best = 0.0f;
+
+    switch (S->Type) {
+        case SvgSegment_Line: {
+            svg_v2 D = S->P2 - S->P1;
+            r32 LengthSq = SvgDot(D, D);
+            if (LengthSq > 0.0f) {
+                Best = SvgMin(SvgMax(SvgDot(P - S->P1, D) / LengthSq, 0.0f), 1.0f);
+            }
+        } break;
+
+        case SvgSegment_QuadraticBezier: {
+            // d/dt |B(t) - P|^2 = 0 is a cubic
+            svg_v2 Q = S->P1 - P;
+            svg_v2 A = S->C1 - S->P1;
+            svg_v2 B = S->P2 - S->C1 - A;
+
+            r64 Roots[3];
+            u32 Count = SvgSolveCubic(SvgDot(B, B), 3.0 * SvgDot(A, B), 2.0 * SvgDot(A, A) + SvgDot(Q, B), SvgDot(Q, A), Roots);
+
+            svg_v2 D = S->P1 - P;
+            r32 BestSq = SvgDot(D, D);
+            D = S->P2 - P;
+            if (SvgDot(D, D) < BestSq) {
+                BestSq = SvgDot(D, D);
+                Best = 1.0f;
+            }
+
+            for (u32 i=0; i<Count; ++i) {
+                if (Roots[i] > 0.0 && Roots[i] < 1.0) {
+                    D = SvgSegmentAt(S, (r32)Roots[i]) - P;
+                    if (SvgDot(D, D) < BestSq) {
+                        BestSq = SvgDot(D, D);
+                        Best = (r32)Roots[i];
+                    }
+                }
+            }
+        } break;
+
+        case SvgSegment_CubicBezier: {
+            // d/dt |B(t) - P|^2 = 0 is a quintic. With B(t) - P = Q + 3At + 3Bt^2 + Ct^3 it is
+            // (Q + 3At + 3Bt^2 + Ct^3) . (A + 2Bt + Ct^2)
+            r64 Ax = S->C1.x - S->P1.x;
+            r64 Ay = S->C1.y - S->P1.y;
+            r64 Bx = (r64)S->C2.x - 2.0 * S->C1.x + S->P1.x;
+            r64 By = (r64)S->C2.y - 2.0 * S->C1.y + S->P1.y;
+            r64 Cx = (r64)S->P2.x - 3.0 * S->C2.x + 3.0 * S->C1.x - S->P1.x;
+            r64 Cy = (r64)S->P2.y - 3.0 * S->C2.y + 3.0 * S->C1.y - S->P1.y;
+            r64 Qx = (r64)S->P1.x - P.x;
+            r64 Qy = (r64)S->P1.y - P.y;
+
+            r64 C[6];
+            C[0] = Qx * Ax + Qy * Ay;
+            C[1] = 2.0 * (Qx * Bx + Qy * By) + 3.0 * (Ax * Ax + Ay * Ay);
+            C[2] = Qx * Cx + Qy * Cy + 9.0 * (Ax * Bx + Ay * By);
+            C[3] = 4.0 * (Ax * Cx + Ay * Cy) + 6.0 * (Bx * Bx + By * By);
+            C[4] = 5.0 * (Bx * Cx + By * Cy);
+            C[5] = Cx * Cx + Cy * Cy;
+
+            svg_v2 D = S->P1 - P;
+            r32 BestSq = SvgDot(D, D);
+            D = S->P2 - P;
+            if (SvgDot(D, D) < BestSq) {
+                BestSq = SvgDot(D, D);
+                Best = 1.0f;
+            }
+
+            r64 Roots[5];
+            u32 Count = SvgSdfPolyRoots(C, 5, Roots);
+
+            for (u32 i=0; i<Count; ++i) {
+                D = SvgCubicAt(S->P1, S->C1, S->C2, S->P2, (r32)Roots[i]) - P;
+                if (SvgDot(D, D) < BestSq) {
+                    BestSq = SvgDot(D, D);
+                    Best = (r32)Roots[i];
+                }
+            }
+        } break;
+
+        default: {
+        } break;
+    }
+
+    return Best;
+}
+
+/*  Distance from P to the segment, Side is the signed perpendicular distance (positive left of the
+    edge direction). Beyond the end points Side is measured to the tangent line extended from the
+    end, which is what keeps corners sharp in the multi-channel field. Orthogonality breaks ties
+    between edges at the same distance, the one seen head-on wins. */
+internal r32
+SvgSegmentDistance(svg_path_segement *S, svg_v2 P, r32 *Side, r32 *Orthogonality)
+{
+    r32 t = SvgSegmentClosest(S, P);
+    svg_v2 Q = SvgSegmentAt(S, t);
+    svg_v2 Tangent = SvgSegmentTangent(S, t);
+    svg_v2 D = P - Q;
+
+    r32 Distance = SvgLength(D);
+    r32 Cross = SvgCross(Tangent, D);
+
+    *Side = (Cross >= 0.0f) ? Distance : -Distance;
+    *Orthogonality = (Distance > 0.0f) ? fabsf(Cross) / Distance : 1.0f;
+
+    if (t == 0.0f && SvgDot(D, Tangent) < 0.0f) {
+        *Side = Cross;
+    } else if (t == 1.0f && SvgDot(D, Tangent) > 0.0f) {
+        *Side = Cross;
+    }
+
+    return Distance;
+}
+
+inline r32
+SvgBoundsDistance(svg_bounds B, svg_v2 P)
+{
+    r32 Dx = SvgMax(SvgMax(B.Min.x - P.x, P.x - B.Max.x), 0.0f);
+    r32 Dy = SvgMax(SvgMax(B.Min.y - P.y, P.y - B.Max.y), 0.0f);
+    return sqrtf(Dx * Dx + Dy * Dy);
+}
+
+inline b32
+SvgFillRuleInside(svg_fill_rule_ Rule, s32 Winding)
+{
+    return (Rule == SvgFillRule_EvenOdd) ? (Winding & 1) : (Winding != 0);
+}
+
+internal void
+SvgSdfAddEdge(svg_sdf_generator *G, svg_path_segement S, svg_transform T)
+{
+    S.P1 = SvgTransformPoint(T, S.P1);
+    S.P2 = SvgTransformPoint(T, S.P2);
+    S.C1 = SvgTransformPoint(T, S.C1);
+    S.C2 = SvgTransformPoint(T, S.C2);
+
+    if (S.Type == SvgSegment_Line) {
+        if (S.P1 == S.P2) {
+            return;
+        }
+    } else if (S.P1 == S.P2 && S.C1 == S.P1 && (S.Type == SvgSegment_QuadraticBezier || S.C2 == S.P1)) {
+        return;
+    }
+
+    svg_sdf_edge Edge = {};
+    Edge.Segment = S;
+    Edge.Bounds = SvgSegmentBounds(&S);
+    Edge.Color = SvgSdfColor_White;
+    G->Edges.Push(Edge);
+}
+
+// note: switches channels at every corner, a contour without corners stays white
+internal void
+SvgSdfColorContour(svg_sdf_edge *Edges, u32 Count)
+{
+    u32 Corners[64];
+    u32 CornerCount = 0;
+
+    for (u32 i=0; i<Count && CornerCount<ArrayCount(Corners); ++i) {
+        svg_v2 A = SvgSegmentTangent(&Edges[(i + Count - 1) % Count].Segment, 1.0f);
+        svg_v2 B = SvgSegmentTangent(&Edges[i].Segment, 0.0f);
+
+        if (SvgDot(A, B) <= 0.0f || fabsf(SvgCross(A, B)) > SVG_SDF_CORNER_CROSS) {
+            Corners[CornerCount++] = i;
+        }
+    }
+
+    if (CornerCount == 0) {
+        return;
+    }
+
+    if (CornerCount == 1) {
+        // note: teardrop, spread three colors over the edges so the corner still has two sides
+        u32 Colors[3] = {SvgSdfColor_Magenta, SvgSdfColor_White, SvgSdfColor_Yellow};
+        for (u32 i=0; i<Count; ++i) {
+            u32 Color = SvgSdfColor_White;
+            if (Count > 1) {
+                Color = Colors[(s32)(3.0f + 2.875f * i / (Count - 1) - 1.4375f + 0.5f) - 2];
+            }
+            Edges[(Corners[0] + i) % Count].Color = Color;
+        }
+        return;
+    }
+
+    u32 Colors[3] = {SvgSdfColor_Cyan, SvgSdfColor_Magenta, SvgSdfColor_Yellow};
+
+    for (u32 c=0; c<CornerCount; ++c) {
+        u32 Color = Colors[c % 3];
+        if (c == CornerCount - 1 && c % 3 == 0) {
+            // note: the last spline touches the first one
+            Color = Colors[1];
+        }
+
+        u32 End = (c + 1 < CornerCount) ? Corners[c + 1] : Corners[0] + Count;
+        for (u32 i=Corners[c]; i<End; ++i) {
+            Edges[i % Count].Color = Color;
+        }
+    }
+}
+
+internal s32
+SvgSdfWinding(svg_sdf_edge *Edges, u32 Count, svg_v2 P)
+{
+    s32 Winding = 0;
+    for (u32 i=0; i<Count; ++i) {
+        Winding += SvgSegmentWinding(&Edges[i].Segment, P);
+    }
+    return Winding;
+}
+
+internal void
+SvgSdfAddElement(svg_sdf_generator *G, svg *Svg, svg_element *E, svg_transform T)
+{
+    // note: the parser only produces paths
+    if (E->Type != SvgElement_Path || !(E->Fill & 0xff)) {
+        return;
+    }
+
+    svg_path *Path = SvgElementPath(Svg, E);
+    if (!Path->Segments.Count) {
+        return;
+    }
+
+    svg_sdf_shape Shape = {};
+    Shape.FirstEdge = G->Edges.Count;
+    Shape.FillRule = E->FillRule;
+
+    u32 At = 0;
+    svg_contour Contour;
+
+    while (SvgNextContour(Path, &At, &Contour)) {
+        u32 First = G->Edges.Count;
+
+        for (u32 i=0; i<Contour.Count; ++i) {
+            svg_path_segement *S = Contour.Segments + i;
+
+            if (S->Type == SvgSegment_Elliptical) {
+                svg_path_segement Cubics[4];
+                u32 Count = SvgArcToCubics(S, Cubics);
+                for (u32 j=0; j<Count; ++j) {
+                    SvgSdfAddEdge(G, Cubics[j], T);
+                }
+            } else {
+                SvgSdfAddEdge(G, *S, T);
+            }
+        }
+
+        if (!Contour.Closed) {
+            svg_path_segement Close = {};
+            Close.Type = SvgSegment_Line;
+            Close.P1 = Contour.Segments[Contour.Count - 1].P2;
+            Close.P2 = Contour.Segments[0].P1;
+            SvgSdfAddEdge(G, Close, T);
+        }
+
+        if (G->Edges.Count > First) {
+            SvgSdfColorContour(G->Edges.Data + First, G->Edges.Count - First);
+        }
+    }
+
+    Shape.EdgeCount = G->Edges.Count - Shape.FirstEdge;
+    if (!Shape.EdgeCount) {
+        return;
+    }
+
+    svg_sdf_edge *Edges = G->Edges.Data + Shape.FirstEdge;
+    Shape.Bounds = Edges[0].Bounds;
+    for (u32 i=1; i<Shape.EdgeCount; ++i) {
+        Shape.Bounds = SvgBoundsUnion(Shape.Bounds, Edges[i].Bounds);
+    }
+
+    // note: probe both sides of every edge, only edges with fill on exactly one side are outline
+    r32 Size = SvgMax(Shape.Bounds.Max.x - Shape.Bounds.Min.x, Shape.Bounds.Max.y - Shape.Bounds.Min.y);
+    r32 Epsilon = SvgMax(Size * 1e-4f, 1e-4f);
+
+    for (u32 i=0; i<Shape.EdgeCount; ++i) {
+        svg_path_segement *S = &Edges[i].Segment;
+        svg_v2 M = SvgSegmentAt(S, 0.5f);
+        svg_v2 Tangent = SvgSegmentTangent(S, 0.5f);
+        svg_v2 Normal = {-Tangent.y, Tangent.x};
+
+        b32 Left = SvgFillRuleInside(Shape.FillRule, SvgSdfWinding(Edges, Shape.EdgeCount, M + Normal * Epsilon));
+        b32 Right = SvgFillRuleInside(Shape.FillRule, SvgSdfWinding(Edges, Shape.EdgeCount, M - Normal * Epsilon));
+
+        Edges[i].Inside = (Left == Right) ? 0 : (Left ? 1 : -1);
+    }
+
+    G->Shapes.Push(Shape);
+}
+
+internal void
+SvgSdfRow(void *Data, u32 y, u32 Worker)
+{
+    svg_sdf_generator *G = (svg_sdf_generator *)Data;
+    svg_sdf_scratch *Scratch = G->Scratch + Worker;
+    svg_field *Field = G->Field;
+    b32 Multi = (Field->Channels == 3);
+    r32 Range = G->Range;
+    u32 Width = Field->Width;
+
+    Scratch->Best.Count = 0;
+    Scratch->Channels.Count = 0;
+    r32 *Best = Scratch->Best.AllocN(Width);
+    r32 *Channels = Scratch->Channels.AllocN(Width * 3);
+
+    for (u32 x=0; x<Width; ++x) {
+        Best[x] = -Range;
+    }
+
+    for (u32 x=0; x<Width * 3; ++x) {
+        Channels[x] = -Range;
+    }
+
+    r32 Py = y + 0.5f;
+
+    for (u32 s=0; s<G->Shapes.Count; ++s) {
+        svg_sdf_shape *Shape = G->Shapes.Data + s;
+        svg_bounds Bounds = Shape->Bounds;
+
+        if (Py < Bounds.Min.y - Range || Py > Bounds.Max.y + Range) {
+            continue;
+        }
+
+        svg_sdf_edge *Edges = G->Edges.Data + Shape->FirstEdge;
+
+        // row crossings, sorted by x
+        Scratch->Crossings.Count = 0;
+        for (u32 i=0; i<Shape->EdgeCount; ++i) {
+            if (Py < Edges[i].Bounds.Min.y || Py > Edges[i].Bounds.Max.y) {
+                continue;
+            }
+
+            r32 Xs[12];
+            s32 Directions[12];
+            u32 Count = SvgSegmentCrossings(&Edges[i].Segment, Py, Xs, Directions);
+
+            for (u32 j=0; j<Count; ++j) {
+                svg_sdf_crossing Crossing = {Xs[j], Directions[j]};
+                Scratch->Crossings.Push(Crossing);
+
+                svg_sdf_crossing *Crossings = Scratch->Crossings.Data;
+                u32 k = Scratch->Crossings.Count - 1;
+                for (; k>0 && Crossings[k - 1].X > Crossing.X; --k) {
+                    Crossings[k] = Crossings[k - 1];
+                }
+                Crossings[k] = Crossing;
+            }
+        }
+
+        s32 X0 = (s32)SvgMax(floorf(Bounds.Min.x - Range), 0.0f);
+        s32 X1 = (s32)SvgMin(ceilf(Bounds.Max.x + Range), (r32)Width);
+
+        u32 Next = 0;
+        s32 Winding = 0;
+
+        for (s32 x=X0; x<X1; ++x) {
+            svg_v2 P = {x + 0.5f, Py};
+
+            // note: the ray counts crossings to the right, sweeping from the left adds them up the same way
+            while (Next < Scratch->Crossings.Count && Scratch->Crossings.Data[Next].X <= P.x) {
+                Winding -= Scratch->Crossings.Data[Next].Direction;
+                ++Next;
+            }
+
+            b32 Inside = SvgFillRuleInside(Shape->FillRule, Winding);
+
+            // note: upper bound of this shape's distance, inside the bounds are still an upper bound
+            r32 Limit;
+            if (Inside) {
+                Limit = SvgMin(SvgMin(P.x - Bounds.Min.x, Bounds.Max.x - P.x), SvgMin(P.y - Bounds.Min.y, Bounds.Max.y - P.y));
+            } else {
+                Limit = -SvgBoundsDistance(Bounds, P);
+            }
+
+            if (Limit <= Best[x]) {
+                continue;
+            }
+
+            // note: everything past Range saturates, pseudo-distances can be shorter than the true
+            //       distance so channels search a bit further
+            r32 Nearest = Range;
+            r32 ChannelRange = 2.0f * Range;
+            r32 ChannelDistance[3] = {ChannelRange, ChannelRange, ChannelRange};
+            r32 ChannelOrthogonality[3] = {0.0f, 0.0f, 0.0f};
+            r32 ChannelSide[3] = {0.0f, 0.0f, 0.0f};
+
+            for (u32 i=0; i<Shape->EdgeCount; ++i) {
+                svg_sdf_edge *Edge = Edges + i;
+                if (!Edge->Inside) {
+                    continue;
+                }
+
+                r32 Bound = SvgBoundsDistance(Edge->Bounds, P);
+                b32 Useful = (Bound < Nearest);
+                if (Multi) {
+                    for (u32 c=0; c<3; ++c) {
+                        if ((Edge->Color & (1 << c)) && Bound <= ChannelDistance[c]) {
+                            Useful = true;
+                        }
+                    }
+                }
+
+                if (!Useful) {
+                    continue;
+                }
+
+                r32 Side;
+                r32 Orthogonality;
+                r32 Distance = SvgSegmentDistance(&Edge->Segment, P, &Side, &Orthogonality);
+
+                if (Distance < Nearest) {
+                    Nearest = Distance;
+                }
+
+                if (Multi) {
+                    for (u32 c=0; c<3; ++c) {
+                        if (!(Edge->Color & (1 << c))) {
+                            continue;
+                        }
+
+                        if (Distance < ChannelDistance[c] ||
+                            (Distance == ChannelDistance[c] && Orthogonality > ChannelOrthogonality[c]))
+                        {
+                            ChannelDistance[c] = Distance;
+                            ChannelOrthogonality[c] = Orthogonality;
+                            ChannelSide[c] = Side * Edge->Inside;
+                        }
+                    }
+                }
+            }
+
+            r32 Signed = Inside ? Nearest : -Nearest;
+            if (Signed <= Best[x]) {
+                continue;
+            }
+
+            Best[x] = Signed;
+
+            if (Multi) {
+                r32 *Out = Channels + x * 3;
+                for (u32 c=0; c<3; ++c) {
+                    Out[c] = (ChannelDistance[c] < ChannelRange) ? ChannelSide[c] : Signed;
+                }
+
+                r32 Median = SvgMax(SvgMin(Out[0], Out[1]), SvgMin(SvgMax(Out[0], Out[1]), Out[2]));
+                if ((Median > 0.0f) != (Signed > 0.0f)) {
+                    Out[0] = Out[1] = Out[2] = Signed;
+                }
+            }
+        }
+    }
+
+    u8 *Row = Field->Pixels + y * Field->Pitch;
+    r32 Scale = 127.5f / Range;
+
+    if (Multi) {
+        for (u32 x=0; x<Width * 3; ++x) {
+            r32 Value = 127.5f + Channels[x] * Scale;
+            Row[x] = (u8)SvgMin(SvgMax(Value + 0.5f, 0.0f), 255.0f);
+        }
+    } else {
+        for (u32 x=0; x<Width; ++x) {
+            r32 Value = 127.5f + Best[x] * Scale;
+            Row[x] = (u8)SvgMin(SvgMax(Value + 0.5f, 0.0f), 255.0f);
+        }
+    }
+}
+
+/*  Fills Field with the distance field of Svg. T maps document units to field pixels, Range is the
+    distance in field pixels where samples saturate. Field->Channels picks SDF (1) or MSDF (3).
+    Pool may be null. */
+void
+SvgGenerateDistanceField(svg_sdf_generator *G, svg *Svg, svg_field *Field, svg_transform T, r32 Range,
+                         svg_job_pool *Pool)
+{
+    G->Edges.Count = 0;
+    G->Shapes.Count = 0;
+    G->Field = Field;
+    G->Range = SvgMax(Range, 1e-3f);
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        SvgSdfAddElement(G, Svg, Svg->Elements.Data + i, T);
+    }
+
+    SvgParallelFor(Pool, Field->Height, SvgSdfRow, G);
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_SDF
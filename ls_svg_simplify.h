@@ -0,0 +1,400 @@
+#ifndef INCLUDE_GUARD_LS_SVG_SIMPLIFY
+#define INCLUDE_GUARD_LS_SVG_SIMPLIFY
+
+/*  Path simplification.
+
+    Only runs of consecutive lines are touched, curves are kept as they are. A run first loses the
+    points that sit on the line through their neighbours, then Douglas-Peucker drops every point
+    that is within Tolerance of the simplified polyline. With FitCurves the run is also cut at sharp
+    corners and each piece in between is fitted with cubics (Schneider, "An algorithm for
+    automatically fitting digitized curves", Graphics Gems), which replace the lines where they take
+    fewer segments. The result is written back into the path as lines and cubics, contours keep
+    their end points exactly. Tolerance is in path units. */
+
+#define SVG_SIMPLIFY_COLLINEAR 0.01f  // of Tolerance
+#define SVG_SIMPLIFY_CORNER -0.5f     // cosine of the turn, sharper turns are never smoothed over
+#define SVG_SIMPLIFY_ITERATIONS 4
+
+// note: scratch memory, keep it around between calls
+struct svg_simplifier {
+    svg_array<svg_v2> Points;
+    svg_array<u8> Keep;
+    svg_array<u32> Stack;
+    svg_array<r32> Parameters;
+    svg_array<svg_path_segement> Fitted;
+    svg_path Result;
+};
+
+internal r32
+SvgSegmentDistanceSq(svg_v2 P, svg_v2 A, svg_v2 B)
+{
+    svg_v2 D = B - A;
+    r32 LengthSq = SvgDot(D, D);
+    r32 t = (LengthSq > 0.0f) ? SvgDot(P - A, D) / LengthSq : 0.0f;
+    t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+
+    svg_v2 E = A + D * t - P;
+    return SvgDot(E, E);
+}
+
+// note: marks the points of First .. Last that Douglas-Peucker keeps, returns the number of lines
+internal u32
+SvgSimplifyLines(svg_simplifier *S, u32 First, u32 Last, r32 Tolerance)
+{
+    svg_v2 *Points = S->Points.Data;
+    u8 *Keep = S->Keep.Data;
+    r32 ToleranceSq = Tolerance * Tolerance;
+    u32 Lines = 1;
+
+    for (u32 i=First; i<=Last; ++i) {
+        Keep[i] = (i == First || i == Last);
+    }
+
+    S->Stack.Count = 0;
+    S->Stack.Push(First);
+    S->Stack.Push(Last);
+
+    while (S->Stack.Count) {
+        u32 B = S->Stack.Data[--S->Stack.Count];
+        u32 A = S->Stack.Data[--S->Stack.Count];
+
+        r32 Farthest = 0.0f;
+        u32 Split = 0;
+
+        for (u32 i=A + 1; i<B; ++i) {
+            r32 DistanceSq = SvgSegmentDistanceSq(Points[i], Points[A], Points[B]);
+            if (DistanceSq > Farthest) {
+                Farthest = DistanceSq;
+                Split = i;
+            }
+        }
+
+        if (Farthest > ToleranceSq) {
+            Keep[Split] = true;
+            Lines++;
+            S->Stack.Push(A);
+            S->Stack.Push(Split);
+            S->Stack.Push(Split);
+            S->Stack.Push(B);
+        }
+    }
+
+    return Lines;
+}
+
+internal svg_path_segement
+SvgCubicSegment(svg_v2 P1, svg_v2 C1, svg_v2 C2, svg_v2 P2)
+{
+    svg_path_segement Result = {};
+    Result.Type = SvgSegment_CubicBezier;
+    Result.P1 = P1;
+    Result.C1 = C1;
+    Result.C2 = C2;
+    Result.P2 = P2;
+    return Result;
+}
+
+// note: least squares handle lengths along the end tangents for the parameters of First .. Last
+internal svg_path_segement
+SvgFitHandles(svg_simplifier *S, u32 First, u32 Last, svg_v2 T1, svg_v2 T2)
+{
+    svg_v2 *Points = S->Points.Data;
+    r32 *u = S->Parameters.Data;
+    svg_v2 P0 = Points[First];
+    svg_v2 P3 = Points[Last];
+
+    r32 C00 = 0.0f, C01 = 0.0f, C11 = 0.0f;
+    r32 X0 = 0.0f, X1 = 0.0f;
+
+    for (u32 i=First; i<=Last; ++i) {
+        r32 t = u[i];
+        r32 s = 1.0f - t;
+        r32 B0 = s * s * s;
+        r32 B1 = 3.0f * s * s * t;
+        r32 B2 = 3.0f * s * t * t;
+        r32 B3 = t * t * t;
+
+        svg_v2 A1 = T1 * B1;
+        svg_v2 A2 = T2 * B2;
+        svg_v2 Rest = Points[i] - (P0 * (B0 + B1) + P3 * (B2 + B3));
+
+        C00 += SvgDot(A1, A1);
+        C01 += SvgDot(A1, A2);
+        C11 += SvgDot(A2, A2);
+        X0 += SvgDot(A1, Rest);
+        X1 += SvgDot(A2, Rest);
+    }
+
+    r32 Determinant = C00 * C11 - C01 * C01;
+    r32 Alpha1 = (Determinant != 0.0f) ? (X0 * C11 - X1 * C01) / Determinant : 0.0f;
+    r32 Alpha2 = (Determinant != 0.0f) ? (C00 * X1 - C01 * X0) / Determinant : 0.0f;
+
+    // note: a degenerate or backwards solution falls back to a third of the chord
+    r32 Chord = SvgLength(P3 - P0);
+    r32 Epsilon = 1e-6f * Chord;
+    if (Alpha1 < Epsilon || Alpha2 < Epsilon) {
+        Alpha1 = Chord / 3.0f;
+        Alpha2 = Alpha1;
+    }
+
+    return SvgCubicSegment(P0, P0 + T1 * Alpha1, P3 + T2 * Alpha2, P3);
+}
+
+internal r32
+SvgFitError(svg_simplifier *S, u32 First, u32 Last, svg_path_segement *C, u32 *Split)
+{
+    r32 Result = 0.0f;
+    *Split = (First + Last) / 2;
+
+    for (u32 i=First + 1; i<Last; ++i) {
+        svg_v2 D = SvgCubicAt(C->P1, C->C1, C->C2, C->P2, S->Parameters.Data[i]) - S->Points.Data[i];
+        r32 DistanceSq = SvgDot(D, D);
+        if (DistanceSq > Result) {
+            Result = DistanceSq;
+            *Split = i;
+        }
+    }
+
+    return Result;
+}
+
+// note: one Newton step towards the parameter of the closest point on the cubic, for every point
+internal void
+SvgFitReparameterize(svg_simplifier *S, u32 First, u32 Last, svg_path_segement *C)
+{
+    svg_v2 D1[3] = {(C->C1 - C->P1) * 3.0f, (C->C2 - C->C1) * 3.0f, (C->P2 - C->C2) * 3.0f};
+    svg_v2 D2[2] = {(D1[1] - D1[0]) * 2.0f, (D1[2] - D1[1]) * 2.0f};
+
+    for (u32 i=First; i<=Last; ++i) {
+        r32 t = S->Parameters.Data[i];
+        r32 s = 1.0f - t;
+
+        svg_v2 Q = SvgCubicAt(C->P1, C->C1, C->C2, C->P2, t) - S->Points.Data[i];
+        svg_v2 Q1 = D1[0] * (s * s) + D1[1] * (2.0f * s * t) + D1[2] * (t * t);
+        svg_v2 Q2 = D2[0] * s + D2[1] * t;
+
+        r32 Denominator = SvgDot(Q1, Q1) + SvgDot(Q, Q2);
+        if (Denominator != 0.0f) {
+            t -= SvgDot(Q, Q1) / Denominator;
+            S->Parameters.Data[i] = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+        }
+    }
+}
+
+internal void
+SvgFitCubics(svg_simplifier *S, u32 First, u32 Last, svg_v2 T1, svg_v2 T2, r32 Tolerance)
+{
+    svg_v2 *Points = S->Points.Data;
+
+    if (Last - First == 1) {
+        r32 Third = SvgLength(Points[Last] - Points[First]) / 3.0f;
+        S->Fitted.Push(SvgCubicSegment(Points[First], Points[First] + T1 * Third, Points[Last] + T2 * Third, Points[Last]));
+        return;
+    }
+
+    // chord length parameters
+    r32 *u = S->Parameters.Data;
+    u[First] = 0.0f;
+    for (u32 i=First + 1; i<=Last; ++i) {
+        u[i] = u[i - 1] + SvgLength(Points[i] - Points[i - 1]);
+    }
+    for (u32 i=First + 1; i<=Last; ++i) {
+        u[i] /= u[Last];
+    }
+
+    r32 ToleranceSq = Tolerance * Tolerance;
+    u32 Split;
+    svg_path_segement Cubic = SvgFitHandles(S, First, Last, T1, T2);
+    r32 Error = SvgFitError(S, First, Last, &Cubic, &Split);
+
+    // note: close fits get a few rounds of moving the parameters to the closest points
+    for (u32 i=0; Error > ToleranceSq && Error < 4.0f * ToleranceSq && i<SVG_SIMPLIFY_ITERATIONS; ++i) {
+        SvgFitReparameterize(S, First, Last, &Cubic);
+        Cubic = SvgFitHandles(S, First, Last, T1, T2);
+        Error = SvgFitError(S, First, Last, &Cubic, &Split);
+    }
+
+    if (Error <= ToleranceSq) {
+        S->Fitted.Push(Cubic);
+        return;
+    }
+
+    svg_v2 Center = SvgNormalize(Points[Split - 1] - Points[Split + 1]);
+    if (Center == svg_v2{0.0f, 0.0f}) {
+        Center = SvgNormalize(Points[Split - 1] - Points[Split]);
+    }
+
+    SvgFitCubics(S, First, Split, T1, Center, Tolerance);
+    SvgFitCubics(S, Split, Last, Center * -1.0f, T2, Tolerance);
+}
+
+// note: lines through the kept points of First .. Last
+internal void
+SvgEmitLines(svg_simplifier *S, u32 First, u32 Last)
+{
+    u32 Previous = First;
+    for (u32 i=First + 1; i<=Last; ++i) {
+        if (S->Keep.Data[i]) {
+            SvgAddLineSegment(&S->Result, S->Points.Data[Previous], S->Points.Data[i]);
+            Previous = i;
+        }
+    }
+}
+
+// note: simplifies the run of lines through S->Points and appends it to S->Result
+internal void
+SvgSimplifyRun(svg_simplifier *S, r32 Tolerance, b32 FitCurves)
+{
+    svg_v2 *Points = S->Points.Data;
+    u32 Count = S->Points.Count;
+
+    S->Keep.Count = 0;
+    S->Keep.AllocN(Count);
+
+    if (!FitCurves) {
+        SvgSimplifyLines(S, 0, Count - 1, Tolerance);
+        SvgEmitLines(S, 0, Count - 1);
+        return;
+    }
+
+    S->Parameters.Count = 0;
+    S->Parameters.AllocN(Count);
+
+    for (u32 First=0; First + 1 < Count; ) {
+        u32 Last = First + 1;
+        while (Last + 1 < Count) {
+            svg_v2 In = SvgNormalize(Points[Last] - Points[Last - 1]);
+            svg_v2 Out = SvgNormalize(Points[Last + 1] - Points[Last]);
+            if (SvgDot(In, Out) < SVG_SIMPLIFY_CORNER) {
+                break;
+            }
+            ++Last;
+        }
+
+        u32 Lines = SvgSimplifyLines(S, First, Last, Tolerance);
+
+        S->Fitted.Count = 0;
+        if (Lines > 1) {
+            svg_v2 T1 = SvgNormalize(Points[First + 1] - Points[First]);
+            svg_v2 T2 = SvgNormalize(Points[Last - 1] - Points[Last]);
+            SvgFitCubics(S, First, Last, T1, T2, Tolerance);
+        }
+
+        if (S->Fitted.Count && S->Fitted.Count < Lines) {
+            for (u32 i=0; i<S->Fitted.Count; ++i) {
+                SvgPushSegment(&S->Result, S->Fitted.Data[i]);
+            }
+        } else {
+            SvgEmitLines(S, First, Last);
+        }
+
+        First = Last;
+    }
+}
+
+// note: simplifies one contour and appends it to S->Result
+internal void
+SvgSimplifyContour(svg_simplifier *S, svg_contour *Contour, r32 Tolerance, r32 CollinearSq, b32 FitCurves)
+{
+    svg_path_segement *Segments = Contour->Segments;
+    u32 Count = Contour->Count;
+
+    for (u32 i=0; i<Count; ) {
+        if (Segments[i].Type != SvgSegment_Line) {
+            SvgPushSegment(&S->Result, Segments[i++]);
+            continue;
+        }
+
+        // collect the run, dropping zero length lines and points on a straight continuation. A merged
+        // line keeps the direction it started with, so the dropped points stay within Collinear of it.
+        S->Points.Count = 0;
+        S->Points.Push(Segments[i].P1);
+        svg_v2 Direction = {};
+
+        for (; i<Count && Segments[i].Type == SvgSegment_Line; ++i) {
+            svg_path_segement *Line = Segments + i;
+            u32 Last = S->Points.Count - 1;
+
+            if (Line->P1 != S->Points.Data[Last]) {
+                break; // note: a new contour starts here
+            }
+
+            if (Line->P2 == Line->P1) {
+                continue;
+            }
+
+            if (Last > 0) {
+                svg_v2 A = S->Points.Data[Last - 1];
+                svg_v2 Offset = Line->P2 - A;
+                r32 Along = SvgDot(Offset, Direction);
+                r32 Across = SvgCross(Direction, Offset);
+
+                if (Along > SvgDot(S->Points.Data[Last] - A, Direction) && Across * Across <= CollinearSq) {
+                    S->Points.Data[Last] = Line->P2;
+                    continue;
+                }
+            }
+
+            Direction = SvgNormalize(Line->P2 - Line->P1);
+            S->Points.Push(Line->P2);
+        }
+
+        if (S->Points.Count == 1) {
+            // note: a run of zero length lines, keep one so the contour still has its point
+            svg_v2 P = S->Points.Data[0];
+            SvgAddLineSegment(&S->Result, P, P);
+            continue;
+        }
+
+        SvgSimplifyRun(S, Tolerance, FitCurves);
+    }
+}
+
+/*  Rewrites Path with fewer segments, see the top of the file. With FitCurves false only lines are
+    produced, so the result is within Tolerance of the original at every point. Fitted cubics are
+    within Tolerance at the original points. */
+void
+SvgSimplifyPath(svg_simplifier *S, svg_path *Path, r32 Tolerance, b32 FitCurves)
+{
+    SvgResetPath(&S->Result);
+    r32 Collinear = SVG_SIMPLIFY_COLLINEAR * Tolerance;
+    r32 CollinearSq = Collinear * Collinear;
+
+    u32 At = 0;
+    svg_contour Contour;
+    while (SvgNextContour(Path, &At, &Contour)) {
+        SvgBeginSubpath(&S->Result);
+        SvgSimplifyContour(S, &Contour, Tolerance, CollinearSq, FitCurves);
+        if (Contour.Closed) {
+            SvgCloseSubpath(&S->Result);
+        }
+    }
+
+    // note: copied rather than swapped, the path keeps its arrays and with them its allocator
+    svg_path *Result = &S->Result;
+    Path->Segments.Count = 0;
+    Path->Segments.FitN(Result->Segments.Count);
+    memcpy(Path->Segments.Data, Result->Segments.Data, Result->Segments.Count * sizeof(svg_path_segement));
+    Path->Segments.Count = Result->Segments.Count;
+
+    Path->Subpaths.Count = 0;
+    Path->Subpaths.FitN(Result->Subpaths.Count);
+    memcpy(Path->Subpaths.Data, Result->Subpaths.Data, Result->Subpaths.Count * sizeof(svg_subpath));
+    Path->Subpaths.Count = Result->Subpaths.Count;
+
+    Path->Bounds = Result->Bounds;
+}
+
+void
+SvgSimplify(svg_simplifier *S, svg *Svg, r32 Tolerance, b32 FitCurves)
+{
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        svg_path *Path = SvgElementPath(Svg, E);
+        if (E->Type == SvgElement_Path && Path->Segments.Count) {
+            SvgSimplifyPath(S, Path, Tolerance, FitCurves);
+        }
+    }
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_SIMPLIFY
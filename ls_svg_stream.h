@@ -0,0 +1,190 @@
+#ifndef INCLUDE_GUARD_LS_SVG_STREAM
+#define INCLUDE_GUARD_LS_SVG_STREAM
+
+/*  Streaming renderer for images too large to keep in memory.
+
+    The image is produced in horizontal bands of BandHeight rows, every finished band goes to a sink
+    and its memory is reused for the next one. All paths are flattened once into an edge list that
+    is bucketed by the first band each edge touches. A band keeps the active edges sorted by element,
+    so painting order holds. Edges join the list in the band they start in and leave after the band
+    they end in. Peak memory is the band plus the edges, independent of the image height. */
+
+struct svg_stream_edge {
+    svg_v2 P0;
+    svg_v2 P1;
+    r32 MaxY;
+    u32 Element;
+};
+
+// note: Band is only valid during the call, Y is its first row in the full image
+typedef void svg_band_sink(void *Data, svg_image *Band, u32 Y);
+
+// note: scratch memory, keep it around between calls
+struct svg_streamer {
+    svg_array<svg_stream_edge> Edges;  // element order
+    svg_array<svg_stream_edge> Sorted; // by first band, element order within a band
+    svg_array<u32> BandStarts;
+    svg_array<u32> Active;
+    svg_array<u32> Merged;
+    svg_array<u8> Pixels;
+    svg_polyline Polyline;
+    svg_rasterizer Rasterizer;
+};
+
+internal void
+SvgStreamAddElement(svg_streamer *S, svg *Svg, svg_element *E, u32 Element, svg_transform T, u32 Width, u32 Height)
+{
+    // note: the parser only produces paths
+    if (E->Type != SvgElement_Path || !(E->Fill & 0xff)) {
+        return;
+    }
+
+    svg_path *Path = SvgElementPath(Svg, E);
+    if (!Path->Segments.Count) {
+        return;
+    }
+
+    svg_bounds Bounds = SvgTransformBounds(T, Path->Bounds);
+    if (Bounds.Max.x < 0.0f || Bounds.Max.y < 0.0f || Bounds.Min.x >= Width || Bounds.Min.y >= Height) {
+        return;
+    }
+
+    svg_polyline *Polyline = &S->Polyline;
+    Polyline->Points.Count = 0;
+    Polyline->ContourEnds.Count = 0;
+    SvgFlattenPath(Path, T, SVG_RASTER_TOLERANCE, Polyline);
+
+    // note: contours are closed implicitly
+    u32 Start = 0;
+    svg_v2 *Points = Polyline->Points.Data;
+
+    for (u32 c=0; c<Polyline->ContourEnds.Count; ++c) {
+        u32 End = Polyline->ContourEnds.Data[c];
+
+        for (u32 i=Start; i<End; ++i) {
+            svg_v2 A = Points[i];
+            svg_v2 B = (i + 1 < End) ? Points[i + 1] : Points[Start];
+            r32 MinY = SvgMin(A.y, B.y);
+            r32 MaxY = SvgMax(A.y, B.y);
+
+            if (A.y == B.y || MaxY <= 0.0f || MinY >= Height) {
+                continue;
+            }
+
+            S->Edges.Push({A, B, MaxY, Element});
+        }
+
+        Start = End;
+    }
+}
+
+void
+SvgRasterizeStreaming(svg_streamer *S, svg *Svg, u32 Width, u32 Height, u32 BandHeight,
+                      svg_transform T, svg_band_sink *Sink, void *Data)
+{
+    if (!Width || !Height || !BandHeight) {
+        return;
+    }
+
+    S->Edges.Count = 0;
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        SvgStreamAddElement(S, Svg, Svg->Elements.Data + i, i, T, Width, Height);
+    }
+
+    // counting sort by first band, stable so every bucket stays in element order
+    u32 BandCount = (Height + BandHeight - 1) / BandHeight;
+
+    S->BandStarts.Count = 0;
+    u32 *Starts = S->BandStarts.AllocN(BandCount + 1);
+    memset(Starts, 0, (BandCount + 1) * sizeof(u32));
+
+    for (u32 i=0; i<S->Edges.Count; ++i) {
+        svg_stream_edge *Edge = S->Edges.Data + i;
+        r32 MinY = SvgMin(Edge->P0.y, Edge->P1.y);
+        u32 Band = (MinY > 0.0f) ? (u32)MinY / BandHeight : 0;
+        Starts[Band + 1]++;
+    }
+
+    for (u32 i=0; i<BandCount; ++i) {
+        Starts[i + 1] += Starts[i];
+    }
+
+    S->Sorted.Count = 0;
+    if (S->Edges.Count) {
+        S->Sorted.AllocN(S->Edges.Count);
+    }
+
+    for (u32 i=0; i<S->Edges.Count; ++i) {
+        svg_stream_edge *Edge = S->Edges.Data + i;
+        r32 MinY = SvgMin(Edge->P0.y, Edge->P1.y);
+        u32 Band = (MinY > 0.0f) ? (u32)MinY / BandHeight : 0;
+        S->Sorted.Data[Starts[Band]++] = *Edge;
+    }
+
+    // note: the scatter moved every start to the end of its bucket, which is the next bucket's start
+    for (u32 i=BandCount; i>0; --i) {
+        Starts[i] = Starts[i - 1];
+    }
+    Starts[0] = 0;
+
+    svg_image Band = {};
+    Band.Width = Width;
+    Band.Pitch = Width * 4;
+
+    S->Pixels.Count = 0;
+    Band.Pixels = S->Pixels.AllocN(Band.Pitch * BandHeight);
+
+    S->Active.Count = 0;
+    svg_stream_edge *Edges = S->Sorted.Data;
+    svg_rasterizer *R = &S->Rasterizer;
+
+    for (u32 b=0; b<BandCount; ++b) {
+        u32 Top = b * BandHeight;
+        Band.Height = (Height - Top < BandHeight) ? Height - Top : BandHeight;
+
+        // merge the edges starting in this band into the active list, dropping the finished ones
+        S->Merged.Count = 0;
+        u32 i = 0;
+        u32 j = Starts[b];
+        u32 JEnd = Starts[b + 1];
+
+        while (i < S->Active.Count || j < JEnd) {
+            u32 Index;
+            if (j >= JEnd || (i < S->Active.Count && Edges[S->Active.Data[i]].Element <= Edges[j].Element)) {
+                Index = S->Active.Data[i++];
+            } else {
+                Index = j++;
+            }
+
+            if (Edges[Index].MaxY > Top) {
+                S->Merged.Push(Index);
+            }
+        }
+
+        svg_array<u32> Swap = S->Active;
+        S->Active = S->Merged;
+        S->Merged = Swap;
+
+        memset(Band.Pixels, 0, Band.Pitch * Band.Height);
+        SvgRasterizerBegin(R, Width, Band.Height);
+
+        svg_v2 Offset = {0.0f, (r32)Top};
+        u32 Count = S->Active.Count;
+
+        for (u32 a=0; a<Count; ) {
+            u32 Element = Edges[S->Active.Data[a]].Element;
+
+            for (; a<Count && Edges[S->Active.Data[a]].Element == Element; ++a) {
+                svg_stream_edge *Edge = Edges + S->Active.Data[a];
+                SvgAccumulateLine(R, Edge->P0 - Offset, Edge->P1 - Offset);
+            }
+
+            svg_element *E = Svg->Elements.Data + Element;
+            SvgRasterResolve(R, E->FillRule, E->Fill, &Band, 0, 0, false);
+        }
+
+        Sink(Data, &Band, Top);
+    }
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_STREAM
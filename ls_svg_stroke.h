@@ -0,0 +1,536 @@
+#ifndef INCLUDE_GUARD_LS_SVG_STROKE
+#define INCLUDE_GUARD_LS_SVG_STROKE
+
+/*  Stroke expansion.
+
+    Turns the centerline of a path into an outline that is filled with the nonzero rule. Lines are
+    offset exactly, quadratics are raised to cubics and arcs are converted to cubics, then every
+    cubic is offset by moving its end points along the normals and scaling its handles by the change
+    in speed (1 - d * curvature). The result is compared with the true offset at a few points and
+    split in half until it is within Tolerance, so curves stay curves instead of being flattened.
+
+    An open contour becomes one closed outline: the left side, the end cap, the right side backwards
+    and the start cap. A closed contour becomes two loops with opposite winding. Outer joins are
+    mitered, rounded or beveled, inner joins go through the vertex itself, which nonzero filling
+    covers without gaps however short the neighbouring segments are.
+
+    Where a curve bends tighter than half the width the true offset on the inside runs backwards and
+    its loop would cancel the winding of the rest of the outline, a closed circle thicker than its
+    radius would get a hole. The inner offset stops at the center of curvature there instead, every
+    point of the stroke is at most that far from its nearest point on the curve, so the outline still
+    covers all of it and the winding never goes negative. */
+
+#define SVG_STROKE_MAX_DEPTH 8
+#define SVG_STROKE_NONE 0xffffffff
+
+struct svg_stroker {
+    svg_array<svg_path_segement> Pieces; // lines and cubics of the current contour
+    svg_path_measure Measure;            // dashing
+    svg_path Dashed;
+    svg_path *Out;
+    svg_v2 Pen;
+    r32 HalfWidth;
+    r32 Tolerance;
+    svg_stroke_style Style;
+};
+
+// note: scratch memory, keep it around between calls
+struct svg_stroke_batch {
+    svg_stroker Strokers[SVG_MAX_WORKERS];
+    svg_array<u32> Slots; // element of the stroke outline in Out, for every input element
+    svg *Svg;
+    svg *Out;
+    r32 Tolerance;
+};
+
+// note: the normal points left of the direction of travel in y-up space, right on screen
+inline svg_v2
+SvgPerp(svg_v2 A)
+{
+    return {-A.y, A.x};
+}
+
+inline svg_v2
+SvgRotate(svg_v2 A, r32 Cos, r32 Sin)
+{
+    return {A.x * Cos - A.y * Sin, A.x * Sin + A.y * Cos};
+}
+
+internal void
+SvgStrokeMoveTo(svg_stroker *S, svg_v2 P)
+{
+    SvgBeginSubpath(S->Out);
+    S->Pen = P;
+}
+
+internal void
+SvgStrokeLineTo(svg_stroker *S, svg_v2 P)
+{
+    if (P != S->Pen) {
+        SvgAddLineSegment(S->Out, S->Pen, P);
+        S->Pen = P;
+    }
+}
+
+internal void
+SvgStrokeCubicTo(svg_stroker *S, svg_v2 C1, svg_v2 C2, svg_v2 P)
+{
+    SvgAddCubicBezierSegment(S->Out, S->Pen, P, C1, C2);
+    S->Pen = P;
+}
+
+// note: circular arc around Center from Center + Radius to End, at most a quarter turn per cubic.
+//       End is hit exactly, contours are told apart by their end points matching.
+internal void
+SvgStrokeArc(svg_stroker *S, svg_v2 Center, svg_v2 Radius, r32 Angle, svg_v2 End)
+{
+    u32 Steps = (u32)ceilf(fabsf(Angle) / (SVG_PI * 0.5f) - 0.001f);
+    if (Steps < 1) {
+        Steps = 1;
+    }
+
+    r32 Step = Angle / Steps;
+    r32 K = (4.0f / 3.0f) * tanf(Step * 0.25f);
+    r32 Cos = cosf(Step);
+    r32 Sin = sinf(Step);
+
+    for (u32 i=0; i<Steps; ++i) {
+        svg_v2 Next = SvgRotate(Radius, Cos, Sin);
+        svg_v2 P = (i + 1 < Steps) ? Center + Next : End;
+        SvgStrokeCubicTo(S, Center + Radius + SvgPerp(Radius) * K, Center + Next - SvgPerp(Next) * K, P);
+        Radius = Next;
+    }
+}
+
+// note: Pen is on the outline of the previous piece at P, T0 and T1 are the directions before and after
+internal void
+SvgStrokeJoin(svg_stroker *S, svg_v2 P, svg_v2 T0, svg_v2 T1)
+{
+    r32 d = S->HalfWidth;
+    svg_v2 N0 = SvgPerp(T0) * d;
+    svg_v2 N1 = SvgPerp(T1) * d;
+    svg_v2 B = P + N1;
+
+    r32 Cross = SvgCross(T0, T1);
+    r32 Dot = SvgDot(T0, T1);
+
+    // note: a full turn back (a cusp) has no inner side, both sides go around the outside of it
+    if (Cross > 0.0f || Dot > 0.9999f) {
+        // inner side (or no real corner), pivoting on the vertex keeps the fill closed. The next piece
+        // starts from here, its offset may be pulled in from B
+        if (Dot <= 0.9999f) {
+            SvgStrokeLineTo(S, P);
+        }
+        return;
+    }
+
+    // note: the previous piece may have ended pulled in towards its center of curvature
+    SvgStrokeLineTo(S, P + N0);
+
+    switch (S->Style.Join) {
+        case SvgLineJoin_Miter: {
+            // note: miter length over stroke width is 1 / sin(theta / 2) = sqrt(2 / (1 + cos(turn)))
+            r32 Limit = S->Style.MiterLimit;
+            if (1.0f + Dot > 0.0f && 2.0f <= Limit * Limit * (1.0f + Dot)) {
+                SvgStrokeLineTo(S, P + (N0 + N1) * (1.0f / (1.0f + Dot)));
+            }
+            SvgStrokeLineTo(S, B);
+        } break;
+
+        case SvgLineJoin_Round: {
+            SvgStrokeArc(S, P, N0, -atan2f(fabsf(Cross), Dot), B);
+        } break;
+
+        default: {
+            SvgStrokeLineTo(S, B);
+        } break;
+    }
+}
+
+// note: Pen is at P + N * d or pulled in from there, T is the direction of travel into the cap
+internal void
+SvgStrokeCap(svg_stroker *S, svg_v2 P, svg_v2 T)
+{
+    r32 d = S->HalfWidth;
+    svg_v2 N = SvgPerp(T) * d;
+    svg_v2 B = P - N;
+    SvgStrokeLineTo(S, P + N);
+
+    switch (S->Style.Cap) {
+        case SvgLineCap_Round: {
+            SvgStrokeArc(S, P, N, -SVG_PI, B);
+        } break;
+
+        case SvgLineCap_Square: {
+            svg_v2 E = T * d;
+            SvgStrokeLineTo(S, P + N + E);
+            SvgStrokeLineTo(S, B + E);
+            SvgStrokeLineTo(S, B);
+        } break;
+
+        default: {
+            SvgStrokeLineTo(S, B);
+        } break;
+    }
+}
+
+// note: distance of the left offset where the curvature is K, no further than the center of curvature
+inline r32
+SvgStrokeReach(r32 d, r32 K)
+{
+    return (d * K > 1.0f) ? 1.0f / K : d;
+}
+
+/*  Point of the left offset of the cubic at t, or the center of curvature where that is closer.
+    Curvature gets the signed curvature, positive turning left, 2/3 * (A x B) / |A|^3 from B'(t) = 3A
+    and B''(t) = 6B. It is 0 where the curve stops. */
+inline svg_v2
+SvgStrokeOffsetAt(svg_path_segement *C, r32 t, r32 d, r32 *Curvature)
+{
+    r32 s = 1.0f - t;
+    svg_v2 A = (C->C1 - C->P1) * (s * s) + (C->C2 - C->C1) * (2.0f * s * t) + (C->P2 - C->C2) * (t * t);
+    svg_v2 B = (C->C2 - C->C1 * 2.0f + C->P1) * s + (C->P2 - C->C2 * 2.0f + C->C1) * t;
+    svg_v2 P = SvgCubicAt(C->P1, C->C1, C->C2, C->P2, t);
+
+    r32 Length = SvgLength(A);
+    if (Length <= 0.0f) {
+        *Curvature = 0.0f;
+        return P + SvgPerp(SvgSegmentTangent(C, t)) * d;
+    }
+
+    *Curvature = (2.0f / 3.0f) * SvgCross(A, B) / (Length * Length * Length);
+    return P + SvgPerp(A) * (SvgStrokeReach(d, *Curvature) / Length);
+}
+
+internal void
+SvgStrokeOffsetCubic(svg_stroker *S, svg_path_segement *C, u32 Depth)
+{
+    r32 d = S->HalfWidth;
+    r32 K0, K1;
+    svg_v2 Q0 = SvgStrokeOffsetAt(C, 0.0f, d, &K0);
+    svg_v2 Q3 = SvgStrokeOffsetAt(C, 1.0f, d, &K1);
+
+    // note: where the radius of curvature is below d the offset is pinned to the center of curvature,
+    // which moves along the normal, the handles collapse there and the splitting below follows it
+    r32 Scale0 = SvgMax(1.0f - d * K0, 0.0f);
+    r32 Scale1 = SvgMax(1.0f - d * K1, 0.0f);
+    svg_v2 Q1 = Q0 + (C->C1 - C->P1) * Scale0;
+    svg_v2 Q2 = Q3 + (C->C2 - C->P2) * Scale1;
+
+    if (Depth < SVG_STROKE_MAX_DEPTH) {
+        r32 ToleranceSq = S->Tolerance * S->Tolerance;
+
+        for (u32 i=1; i<4; ++i) {
+            r32 t = i * 0.25f;
+            r32 K;
+            svg_v2 Exact = SvgStrokeOffsetAt(C, t, d, &K);
+            svg_v2 Error = SvgCubicAt(Q0, Q1, Q2, Q3, t) - Exact;
+
+            if (SvgDot(Error, Error) > ToleranceSq) {
+                svg_path_segement A, B;
+                SvgSplitSegment(C, 0.5f, &A, &B);
+                SvgStrokeOffsetCubic(S, &A, Depth + 1);
+                SvgStrokeOffsetCubic(S, &B, Depth + 1);
+                return;
+            }
+        }
+    }
+
+    // note: a cusp in the centerline turns the offset around, the line covers the jump
+    SvgStrokeLineTo(S, Q0);
+    SvgStrokeCubicTo(S, Q1, Q2, Q3);
+}
+
+inline svg_path_segement
+SvgStrokePiece(svg_stroker *S, u32 Index, b32 Reverse)
+{
+    u32 Count = S->Pieces.Count;
+    svg_path_segement Result = S->Pieces.Data[Reverse ? Count - 1 - Index : Index];
+
+    if (Reverse) {
+        svg_v2 P = Result.P1;
+        Result.P1 = Result.P2;
+        Result.P2 = P;
+
+        if (Result.Type == SvgSegment_CubicBezier) {
+            svg_v2 C = Result.C1;
+            Result.C1 = Result.C2;
+            Result.C2 = C;
+        }
+    }
+
+    return Result;
+}
+
+/*  One side of the contour, left of the direction of travel (so Reverse gives the right side). With
+    Move it starts a new outline, otherwise it continues from Pen. Returns the start point. */
+internal svg_v2
+SvgStrokeSide(svg_stroker *S, b32 Reverse, b32 Closed, b32 Move)
+{
+    u32 Count = S->Pieces.Count;
+    svg_path_segement First = SvgStrokePiece(S, 0, Reverse);
+    svg_path_segement Previous = First;
+
+    r32 K;
+    svg_v2 Start = (First.Type == SvgSegment_CubicBezier) ? SvgStrokeOffsetAt(&First, 0.0f, S->HalfWidth, &K) :
+                   First.P1 + SvgPerp(SvgSegmentTangent(&First, 0.0f)) * S->HalfWidth;
+    if (Move) {
+        SvgStrokeMoveTo(S, Start);
+    } else {
+        SvgStrokeLineTo(S, Start);
+    }
+
+    for (u32 i=0; i<Count; ++i) {
+        svg_path_segement Piece = SvgStrokePiece(S, i, Reverse);
+
+        if (i > 0) {
+            SvgStrokeJoin(S, Piece.P1, SvgSegmentTangent(&Previous, 1.0f), SvgSegmentTangent(&Piece, 0.0f));
+        }
+
+        if (Piece.Type == SvgSegment_CubicBezier) {
+            SvgStrokeOffsetCubic(S, &Piece, 0);
+        } else {
+            svg_v2 N = SvgPerp(SvgSegmentTangent(&Piece, 0.0f)) * S->HalfWidth;
+            SvgStrokeLineTo(S, Piece.P1 + N);
+            SvgStrokeLineTo(S, Piece.P2 + N);
+        }
+
+        Previous = Piece;
+    }
+
+    if (Closed) {
+        SvgStrokeJoin(S, First.P1, SvgSegmentTangent(&Previous, 1.0f), SvgSegmentTangent(&First, 0.0f));
+        SvgStrokeLineTo(S, Start);
+    }
+
+    return Start;
+}
+
+// note: interior parameter where the derivative vanishes, the tangent flips there
+internal b32
+SvgCubicCusp(svg_path_segement *C, r32 *Cusp)
+{
+    // derivative / 3 = A t^2 + B t + D
+    svg_v2 A = C->P2 - C->P1 + (C->C1 - C->C2) * 3.0f;
+    svg_v2 B = (C->C2 - C->C1 * 2.0f + C->P1) * 2.0f;
+    svg_v2 D = C->C1 - C->P1;
+    r32 Epsilon = 1e-4f * (SvgLength(C->C1 - C->P1) + SvgLength(C->C2 - C->C1) + SvgLength(C->P2 - C->C2));
+
+    for (u32 Axis=0; Axis<2; ++Axis) {
+        r32 a = Axis ? A.y : A.x;
+        r32 b = Axis ? B.y : B.x;
+        r32 c = Axis ? D.y : D.x;
+
+        r32 Roots[2];
+        u32 RootCount = 0;
+
+        if (fabsf(a) > 1e-12f) {
+            r32 Discriminant = b * b - 4.0f * a * c;
+            if (Discriminant >= 0.0f) {
+                r32 Root = sqrtf(Discriminant);
+                Roots[RootCount++] = (-b - Root) / (2.0f * a);
+                Roots[RootCount++] = (-b + Root) / (2.0f * a);
+            }
+        } else if (fabsf(b) > 1e-12f) {
+            Roots[RootCount++] = -c / b;
+        }
+
+        for (u32 i=0; i<RootCount; ++i) {
+            r32 t = Roots[i];
+            if (t > 1e-3f && t < 1.0f - 1e-3f && SvgLength((A * t + B) * t + D) <= Epsilon) {
+                *Cusp = t;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+internal void
+SvgStrokePushPiece(svg_stroker *S, svg_path_segement Piece)
+{
+    b32 Degenerate = (Piece.P1 == Piece.P2);
+    if (Piece.Type == SvgSegment_CubicBezier) {
+        Degenerate = Degenerate && Piece.C1 == Piece.P1 && Piece.C2 == Piece.P1;
+
+        // note: a cusp becomes a corner between two pieces so it gets a join like any other
+        r32 Cusp;
+        if (!Degenerate && SvgCubicCusp(&Piece, &Cusp)) {
+            svg_path_segement A, B;
+            SvgSplitSegment(&Piece, Cusp, &A, &B);
+            S->Pieces.Push(A);
+            S->Pieces.Push(B);
+            return;
+        }
+    }
+
+    if (!Degenerate) {
+        S->Pieces.Push(Piece);
+    }
+}
+
+internal void
+SvgStrokeContour(svg_stroker *S, svg_contour *Contour)
+{
+    S->Pieces.Count = 0;
+
+    for (u32 i=0; i<Contour->Count; ++i) {
+        svg_path_segement *Segment = Contour->Segments + i;
+
+        switch (Segment->Type) {
+            case SvgSegment_QuadraticBezier: {
+                svg_path_segement Cubic = *Segment;
+                Cubic.Type = SvgSegment_CubicBezier;
+                Cubic.C1 = Segment->P1 + (Segment->C1 - Segment->P1) * (2.0f / 3.0f);
+                Cubic.C2 = Segment->P2 + (Segment->C1 - Segment->P2) * (2.0f / 3.0f);
+                SvgStrokePushPiece(S, Cubic);
+            } break;
+
+            case SvgSegment_Elliptical: {
+                svg_path_segement Cubics[4];
+                u32 Count = SvgArcToCubics(Segment, Cubics);
+                for (u32 c=0; c<Count; ++c) {
+                    SvgStrokePushPiece(S, Cubics[c]);
+                }
+            } break;
+
+            default: {
+                SvgStrokePushPiece(S, *Segment);
+            } break;
+        }
+    }
+
+    r32 d = S->HalfWidth;
+
+    if (!S->Pieces.Count) {
+        // note: a zero length subpath still gets its caps, a dot or a square
+        svg_v2 P = Contour->Segments[0].P1;
+        if (S->Style.Cap == SvgLineCap_Round) {
+            SvgStrokeMoveTo(S, P + svg_v2{d, 0.0f});
+            SvgStrokeArc(S, P, svg_v2{d, 0.0f}, 2.0f * SVG_PI, P + svg_v2{d, 0.0f});
+        } else if (S->Style.Cap == SvgLineCap_Square) {
+            SvgStrokeMoveTo(S, P + svg_v2{-d, -d});
+            SvgStrokeLineTo(S, P + svg_v2{d, -d});
+            SvgStrokeLineTo(S, P + svg_v2{d, d});
+            SvgStrokeLineTo(S, P + svg_v2{-d, d});
+            SvgStrokeLineTo(S, P + svg_v2{-d, -d});
+        }
+        return;
+    }
+
+    if (Contour->Closed) {
+        SvgStrokeSide(S, false, true, true);
+        SvgStrokeSide(S, true, true, true);
+    } else {
+        svg_path_segement First = S->Pieces.Data[0];
+        svg_path_segement Last = S->Pieces.Data[S->Pieces.Count - 1];
+
+        svg_v2 Start = SvgStrokeSide(S, false, false, true);
+        SvgStrokeCap(S, Last.P2, SvgSegmentTangent(&Last, 1.0f));
+        SvgStrokeSide(S, true, false, false);
+        SvgStrokeCap(S, First.P1, SvgSegmentTangent(&First, 0.0f) * -1.0f);
+        SvgStrokeLineTo(S, Start);
+    }
+}
+
+// note: appends the outline of the stroke to Out, which is filled with the nonzero rule
+void
+SvgStrokePath(svg_stroker *S, svg_path *Path, svg_stroke_style Style, r32 Tolerance, svg_path *Out)
+{
+    if (Style.Width <= 0.0f) {
+        return;
+    }
+
+    S->Out = Out;
+    S->Style = Style;
+    S->HalfWidth = 0.5f * Style.Width;
+    S->Tolerance = Tolerance;
+    S->Pen = {};
+    u32 FirstSubpath = Out->Subpaths.Count;
+
+    u32 At = 0;
+    svg_contour Contour;
+    while (SvgNextContour(Path, &At, &Contour)) {
+        SvgStrokeContour(S, &Contour);
+    }
+
+    // note: every outline is a loop, a subpath left empty by the last move is dropped
+    if (Out->Subpaths.Count > FirstSubpath && Out->Subpaths.Data[Out->Subpaths.Count - 1].First == Out->Segments.Count) {
+        Out->Subpaths.Count--;
+    }
+    for (u32 i=FirstSubpath; i<Out->Subpaths.Count; ++i) {
+        Out->Subpaths.Data[i].Closed = true;
+    }
+}
+
+internal void
+SvgStrokeJob(void *Data, u32 Index, u32 Worker)
+{
+    svg_stroke_batch *Batch = (svg_stroke_batch *)Data;
+    u32 Slot = Batch->Slots.Data[Index];
+
+    if (Slot != SVG_STROKE_NONE) {
+        svg_stroker *S = Batch->Strokers + Worker;
+        svg_element *E = Batch->Svg->Elements.Data + Index;
+        svg_element *Outline = Batch->Out->Elements.Data + Slot;
+        svg_stroke_style *Style = &E->StrokeStyle;
+        svg_path *Path = SvgElementPath(Batch->Svg, E);
+
+        if (Style->DashCount) {
+            SvgResetPath(&S->Dashed);
+            SvgMeasurePath(&S->Measure, Path);
+            SvgDashPath(&S->Measure, Batch->Svg->Dashes.Data + Style->DashFirst, Style->DashCount, Style->DashOffset,
+                        &S->Dashed);
+            Path = &S->Dashed;
+        }
+
+        SvgStrokePath(S, Path, *Style, Batch->Tolerance, &Outline->Path);
+    }
+}
+
+/*  Fills Out with the elements of Svg, every stroked element is followed by a filled element for its
+    stroke outline, so the painting order holds. Out should be empty, it shares the geometry of the
+    unstroked elements with Svg, the paths of a lazily parsed Svg are decoded first. Dash patterns are
+    applied before stroking. Elements are stroked in parallel, Pool may be null. */
+void
+SvgStrokeDocument(svg_stroke_batch *Batch, svg *Svg, svg *Out, r32 Tolerance, svg_job_pool *Pool)
+{
+    Out->Elements.Count = 0;
+    Out->FillRule = Svg->FillRule;
+    Out->Fill = Svg->Fill;
+    Out->Stroke = 0;
+    Out->StrokeStyle = Svg->StrokeStyle;
+
+    Batch->Svg = Svg;
+    Batch->Out = Out;
+    Batch->Tolerance = Tolerance;
+    Batch->Slots.Count = 0;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+        svg_path *Path = SvgElementPath(Svg, E);
+
+        svg_element *Fill = Out->Elements.AllocN(1);
+        *Fill = *E;
+        Fill->Stroke = 0;
+
+        // note: the parser only produces paths
+        if (E->Type != SvgElement_Path || !Path->Segments.Count || !(E->Stroke & 0xff) || E->StrokeStyle.Width <= 0.0f) {
+            Batch->Slots.Push(SVG_STROKE_NONE);
+            continue;
+        }
+
+        Batch->Slots.Push(Out->Elements.Count);
+
+        svg_element *Outline = Out->Elements.AllocN(1);
+        Outline->Type = SvgElement_Path;
+        Outline->FillRule = SvgFillRule_NonZero;
+        Outline->Fill = E->Stroke;
+        Outline->StrokeStyle = E->StrokeStyle;
+    }
+
+    SvgParallelFor(Pool, Svg->Elements.Count, SvgStrokeJob, Batch);
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_STROKE
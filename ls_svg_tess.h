@@ -0,0 +1,717 @@
+#ifndef INCLUDE_GUARD_LS_SVG_TESS
+#define INCLUDE_GUARD_LS_SVG_TESS
+
+/*  Triangle tessellation of filled paths.
+
+    Every element is flattened and swept from top to bottom. The sweep stops at every vertex and at
+    every crossing of two edges, so between two stops the edges are straight, don't cross and keep
+    their left to right order. Walking that order with the fill rule gives the filled intervals.
+    An interval that is bounded by the same edges (or by the edges that continue them at a vertex)
+    in the next slab belongs to the same region, so every region is a y-monotone polygon. Closed
+    regions are triangulated with the classic monotone stack algorithm, which emits the triangles
+    in sweep order along the chains, consecutive triangles mostly share two vertices.
+
+    Where regions split and merge, the neighbouring boundary points are added to the flat tops and
+    bottoms, so the mesh has no T-junctions there. Vertices at the same position are shared within
+    an element. Indices are relative to the first vertex of their element's range (base vertex), so
+    most documents fit 16-bit indices. */
+
+#define SVG_TESS_NONE 0xffffffff
+#define SVG_TESS_MAX_SPLITS 64
+
+// note: slab order violations smaller than this are rounding, not crossings
+#define SVG_TESS_EPSILON 1e-4f
+
+struct svg_mesh_range {
+    u32 Element;
+    u32 FirstVertex;
+    u32 VertexCount;
+    u32 FirstIndex;
+    u32 IndexCount;
+};
+
+struct svg_mesh {
+    svg_array<svg_v2> Vertices;
+    svg_array<u32> Indices; // relative to the range's FirstVertex, clockwise on screen (y down)
+    svg_array<svg_mesh_range> Ranges;
+    u32 IndexSize; // 4, or 2 after SvgMeshIndices16
+};
+
+struct svg_tess_edge {
+    svg_v2 Top;
+    svg_v2 Bottom;
+    s32 Winding;
+};
+
+struct svg_tess_active {
+    u32 Edge;
+    r32 X0;  // at the top of the slab
+    r32 X1;  // at the bottom
+    r32 Mid;
+};
+
+struct svg_tess_interval {
+    u32 Left;
+    u32 Right;
+    r32 X0;
+    r32 X1;
+};
+
+// note: singly linked lists of chain vertices, top to bottom
+struct svg_tess_link {
+    u32 Vertex;
+    u32 Next;
+};
+
+struct svg_tess_region {
+    u32 Left;
+    u32 Right;
+    u32 LeftFirst;
+    u32 LeftLast;
+    u32 RightFirst;
+    u32 RightLast;
+};
+
+struct svg_tess_chain_vertex {
+    u32 Vertex;
+    svg_v2 P;
+    b32 Right;
+};
+
+// note: scratch memory, keep it around between calls
+struct svg_tessellator {
+    svg_array<svg_tess_edge> Edges;
+    svg_array<r32> Ys;
+    svg_array<svg_tess_active> Active;
+    svg_array<svg_tess_interval> Intervals;
+    svg_array<svg_tess_region> Regions;
+    svg_array<svg_tess_region> NextRegions;
+    svg_array<svg_tess_link> Links;
+    svg_array<r32> Boundary;
+    svg_array<svg_tess_chain_vertex> Chain;
+    svg_array<u32> Stack;
+    svg_array<u32> Hash;
+    svg_polyline Polyline;
+
+    svg_mesh *Mesh;
+    u32 FirstVertex;
+};
+
+inline r32
+SvgTessEdgeX(svg_tess_edge *E, r32 y)
+{
+    // note: exact at the end points, so edges meeting at a vertex agree on its position
+    if (y <= E->Top.y) return E->Top.x;
+    if (y >= E->Bottom.y) return E->Bottom.x;
+    return E->Top.x + (E->Bottom.x - E->Top.x) * ((y - E->Top.y) / (E->Bottom.y - E->Top.y));
+}
+
+internal int
+SvgTessCompareEdges(const void *A, const void *B)
+{
+    r32 YA = ((svg_tess_edge *)A)->Top.y;
+    r32 YB = ((svg_tess_edge *)B)->Top.y;
+    return (YA < YB) ? -1 : (YA > YB) ? 1 : 0;
+}
+
+internal int
+SvgTessCompareReals(const void *A, const void *B)
+{
+    r32 X = *(r32 *)A;
+    r32 Y = *(r32 *)B;
+    return (X < Y) ? -1 : (X > Y) ? 1 : 0;
+}
+
+inline u32
+SvgTessHash(svg_v2 P)
+{
+    u32 X, Y;
+    memcpy(&X, &P.x, 4);
+    memcpy(&Y, &P.y, 4);
+    u32 Result = X * 0x9e3779b1u ^ (Y + 0x7f4a7c15u) * 0x85ebca77u;
+    return Result ^ (Result >> 15);
+}
+
+internal void
+SvgTessRehash(svg_tessellator *Tess, u32 Size)
+{
+    Tess->Hash.Count = 0;
+    u32 *Table = Tess->Hash.AllocN(Size);
+    memset(Table, 0, Size * sizeof(u32));
+
+    svg_mesh *Mesh = Tess->Mesh;
+    for (u32 v=Tess->FirstVertex; v<Mesh->Vertices.Count; ++v) {
+        u32 Slot = SvgTessHash(Mesh->Vertices.Data[v]) & (Size - 1);
+        while (Table[Slot]) {
+            Slot = (Slot + 1) & (Size - 1);
+        }
+        Table[Slot] = v - Tess->FirstVertex + 1;
+    }
+}
+
+// note: vertex index relative to the element, vertices at the same position are shared
+internal u32
+SvgTessVertex(svg_tessellator *Tess, r32 x, r32 y)
+{
+    svg_mesh *Mesh = Tess->Mesh;
+    svg_v2 P = {x + 0.0f, y + 0.0f}; // note: folds -0 into 0
+
+    u32 Count = Mesh->Vertices.Count - Tess->FirstVertex;
+    if (2 * (Count + 1) > Tess->Hash.Count) {
+        SvgTessRehash(Tess, (Tess->Hash.Count < 64) ? 64 : 2 * Tess->Hash.Count);
+    }
+
+    u32 Mask = Tess->Hash.Count - 1;
+    u32 *Table = Tess->Hash.Data;
+    u32 Slot = SvgTessHash(P) & Mask;
+
+    while (Table[Slot]) {
+        svg_v2 Q = Mesh->Vertices.Data[Tess->FirstVertex + Table[Slot] - 1];
+        if (Q.x == P.x && Q.y == P.y) {
+            return Table[Slot] - 1;
+        }
+        Slot = (Slot + 1) & Mask;
+    }
+
+    Table[Slot] = Count + 1;
+    Mesh->Vertices.Push(P);
+    return Count;
+}
+
+internal void
+SvgTessChainAdd(svg_tessellator *Tess, u32 *First, u32 *Last, u32 Vertex)
+{
+    u32 Link = Tess->Links.Count;
+    Tess->Links.Push({Vertex, SVG_TESS_NONE});
+
+    if (*First == SVG_TESS_NONE) {
+        *First = Link;
+    } else {
+        Tess->Links.Data[*Last].Next = Link;
+    }
+    *Last = Link;
+}
+
+// note: first boundary point at or right of X
+internal u32
+SvgTessBoundaryStart(svg_tessellator *Tess, r32 X)
+{
+    u32 Low = 0;
+    u32 High = Tess->Boundary.Count;
+
+    while (Low < High) {
+        u32 Mid = (Low + High) / 2;
+        if (Tess->Boundary.Data[Mid] < X) {
+            Low = Mid + 1;
+        } else {
+            High = Mid;
+        }
+    }
+
+    return Low;
+}
+
+// note: other regions end or start exactly on this boundary point
+internal b32
+SvgTessBoundaryShared(svg_tessellator *Tess, r32 X)
+{
+    u32 Count = 0;
+    for (u32 i=SvgTessBoundaryStart(Tess, X); i<Tess->Boundary.Count && Tess->Boundary.Data[i] == X; ++i) {
+        ++Count;
+    }
+    return Count > 2;
+}
+
+internal void
+SvgTessTriangle(svg_tessellator *Tess, u32 A, u32 B, u32 C)
+{
+    svg_tess_chain_vertex *Chain = Tess->Chain.Data;
+    r32 Cross = SvgCross(Chain[B].P - Chain[A].P, Chain[C].P - Chain[A].P);
+
+    if (Cross == 0.0f) {
+        return;
+    }
+
+    svg_array<u32> *Indices = &Tess->Mesh->Indices;
+    Indices->Push(Chain[A].Vertex);
+    if (Cross > 0.0f) {
+        Indices->Push(Chain[B].Vertex);
+        Indices->Push(Chain[C].Vertex);
+    } else {
+        Indices->Push(Chain[C].Vertex);
+        Indices->Push(Chain[B].Vertex);
+    }
+}
+
+/*  Monotone polygon triangulation (de Berg et al., 3.3). The chains are merged into one list
+    sorted by y then x, a stack holds the vertices that still need triangles. */
+internal void
+SvgTessTriangulate(svg_tessellator *Tess, svg_tess_region *Region)
+{
+    svg_v2 *Vertices = Tess->Mesh->Vertices.Data + Tess->FirstVertex;
+    svg_tess_link *Links = Tess->Links.Data;
+
+    Tess->Chain.Count = 0;
+    u32 L = Region->LeftFirst;
+    u32 R = Region->RightFirst;
+
+    while (L != SVG_TESS_NONE || R != SVG_TESS_NONE) {
+        b32 TakeLeft = (R == SVG_TESS_NONE);
+
+        if (L != SVG_TESS_NONE && R != SVG_TESS_NONE) {
+            svg_v2 A = Vertices[Links[L].Vertex];
+            svg_v2 B = Vertices[Links[R].Vertex];
+            TakeLeft = (A.y < B.y || (A.y == B.y && A.x <= B.x));
+        }
+
+        u32 Link = TakeLeft ? L : R;
+        u32 Vertex = Links[Link].Vertex;
+        Tess->Chain.Push({Vertex, Vertices[Vertex], !TakeLeft});
+
+        if (TakeLeft) {
+            L = Links[L].Next;
+        } else {
+            R = Links[R].Next;
+        }
+    }
+
+    u32 Count = Tess->Chain.Count;
+    if (Count < 3) {
+        return;
+    }
+
+    svg_tess_chain_vertex *Chain = Tess->Chain.Data;
+    svg_array<u32> *Stack = &Tess->Stack;
+    Stack->Count = 0;
+    Stack->Push(0);
+    Stack->Push(1);
+
+    for (u32 j=2; j+1<Count; ++j) {
+        u32 Top = Stack->Data[Stack->Count - 1];
+
+        if (Chain[j].Right != Chain[Top].Right) {
+            // opposite chain, everything on the stack can see the new vertex
+            while (Stack->Count > 1) {
+                u32 V = Stack->Data[--Stack->Count];
+                SvgTessTriangle(Tess, j, V, Stack->Data[Stack->Count - 1]);
+            }
+            Stack->Count = 0;
+            Stack->Push(j - 1);
+            Stack->Push(j);
+        } else {
+            // same chain, cut off ears while the diagonal stays inside
+            u32 Last = Stack->Data[--Stack->Count];
+
+            while (Stack->Count) {
+                u32 Next = Stack->Data[Stack->Count - 1];
+                r32 Cross = SvgCross(Chain[j].P - Chain[Next].P, Chain[Last].P - Chain[Next].P);
+                b32 Inside = Chain[j].Right ? (Cross < 0.0f) : (Cross > 0.0f);
+
+                if (!Inside) {
+                    break;
+                }
+
+                SvgTessTriangle(Tess, j, Last, Next);
+                Last = Next;
+                --Stack->Count;
+            }
+
+            Stack->Push(Last);
+            Stack->Push(j);
+        }
+    }
+
+    for (u32 i=0; i+1<Stack->Count; ++i) {
+        SvgTessTriangle(Tess, Count - 1, Stack->Data[i], Stack->Data[i + 1]);
+    }
+}
+
+internal void
+SvgTessOpen(svg_tessellator *Tess, svg_tess_interval *Interval, r32 y)
+{
+    svg_tess_region Region = {Interval->Left, Interval->Right,
+                              SVG_TESS_NONE, SVG_TESS_NONE, SVG_TESS_NONE, SVG_TESS_NONE};
+    r32 X0 = Interval->X0;
+    r32 X1 = Interval->X1;
+
+    SvgTessChainAdd(Tess, &Region.LeftFirst, &Region.LeftLast, SvgTessVertex(Tess, X0, y));
+
+    // note: the flat top belongs to the right chain in y then x order
+    for (u32 i=SvgTessBoundaryStart(Tess, X0); i<Tess->Boundary.Count && Tess->Boundary.Data[i] < X1; ++i) {
+        r32 X = Tess->Boundary.Data[i];
+        if (X > X0 && (i == 0 || X != Tess->Boundary.Data[i - 1])) {
+            SvgTessChainAdd(Tess, &Region.RightFirst, &Region.RightLast, SvgTessVertex(Tess, X, y));
+        }
+    }
+
+    if (X1 > X0) {
+        SvgTessChainAdd(Tess, &Region.RightFirst, &Region.RightLast, SvgTessVertex(Tess, X1, y));
+    }
+
+    Tess->NextRegions.Push(Region);
+}
+
+internal void
+SvgTessClose(svg_tessellator *Tess, svg_tess_region *Region, r32 y)
+{
+    r32 X0 = SvgTessEdgeX(Tess->Edges.Data + Region->Left, y);
+    r32 X1 = SvgTessEdgeX(Tess->Edges.Data + Region->Right, y);
+
+    SvgTessChainAdd(Tess, &Region->LeftFirst, &Region->LeftLast, SvgTessVertex(Tess, X0, y));
+
+    // note: the flat bottom belongs to the left chain in y then x order
+    for (u32 i=SvgTessBoundaryStart(Tess, X0); i<Tess->Boundary.Count && Tess->Boundary.Data[i] < X1; ++i) {
+        r32 X = Tess->Boundary.Data[i];
+        if (X > X0 && (i == 0 || X != Tess->Boundary.Data[i - 1])) {
+            SvgTessChainAdd(Tess, &Region->LeftFirst, &Region->LeftLast, SvgTessVertex(Tess, X, y));
+        }
+    }
+
+    if (X1 > X0) {
+        SvgTessChainAdd(Tess, &Region->RightFirst, &Region->RightLast, SvgTessVertex(Tess, X1, y));
+    }
+
+    SvgTessTriangulate(Tess, Region);
+}
+
+// note: moves the open regions across the slab boundary at y, Intervals are the filled spans below it
+internal void
+SvgTessBoundary(svg_tessellator *Tess, r32 y)
+{
+    svg_tess_edge *Edges = Tess->Edges.Data;
+    svg_tess_region *Regions = Tess->Regions.Data;
+    svg_tess_interval *Intervals = Tess->Intervals.Data;
+    u32 RegionCount = Tess->Regions.Count;
+    u32 IntervalCount = Tess->Intervals.Count;
+
+    // note: mostly every region just carries on, that doesn't need the boundary points
+    if (RegionCount == IntervalCount) {
+        u32 r = 0;
+        for (; r<RegionCount; ++r) {
+            r32 X0 = SvgTessEdgeX(Edges + Regions[r].Left, y);
+            r32 X1 = SvgTessEdgeX(Edges + Regions[r].Right, y);
+            if (X0 != Intervals[r].X0 || X1 != Intervals[r].X1 || X1 <= X0) {
+                break;
+            }
+        }
+
+        if (r == RegionCount) {
+            for (r=0; r<RegionCount; ++r) {
+                svg_tess_region *Region = Regions + r;
+                if (Region->Left != Intervals[r].Left) {
+                    SvgTessChainAdd(Tess, &Region->LeftFirst, &Region->LeftLast, SvgTessVertex(Tess, Intervals[r].X0, y));
+                    Region->Left = Intervals[r].Left;
+                }
+                if (Region->Right != Intervals[r].Right) {
+                    SvgTessChainAdd(Tess, &Region->RightFirst, &Region->RightLast, SvgTessVertex(Tess, Intervals[r].X1, y));
+                    Region->Right = Intervals[r].Right;
+                }
+            }
+            return;
+        }
+    }
+
+    Tess->Boundary.Count = 0;
+    for (u32 r=0; r<RegionCount; ++r) {
+        Tess->Boundary.Push(SvgTessEdgeX(Edges + Regions[r].Left, y));
+        Tess->Boundary.Push(SvgTessEdgeX(Edges + Regions[r].Right, y));
+    }
+    for (u32 i=0; i<IntervalCount; ++i) {
+        Tess->Boundary.Push(Intervals[i].X0);
+        Tess->Boundary.Push(Intervals[i].X1);
+    }
+
+    // note: both halves are already nearly sorted
+    r32 *Boundary = Tess->Boundary.Data;
+    for (u32 i=1; i<Tess->Boundary.Count; ++i) {
+        r32 X = Boundary[i];
+        u32 j = i;
+        for (; j>0 && Boundary[j - 1] > X; --j) {
+            Boundary[j] = Boundary[j - 1];
+        }
+        Boundary[j] = X;
+    }
+
+    Tess->NextRegions.Count = 0;
+    u32 r = 0;
+    u32 i = 0;
+
+    while (r < RegionCount || i < IntervalCount) {
+        r32 RX0 = 0.0f;
+        r32 RX1 = 0.0f;
+
+        if (r < RegionCount) {
+            RX0 = SvgTessEdgeX(Edges + Regions[r].Left, y);
+            RX1 = SvgTessEdgeX(Edges + Regions[r].Right, y);
+        }
+
+        if (r < RegionCount && i < IntervalCount &&
+            RX0 == Intervals[i].X0 && RX1 == Intervals[i].X1 && RX1 > RX0) {
+            // the region continues, a vertex is only needed where its boundary changes edges
+            svg_tess_region Region = Regions[r];
+
+            if (Region.Left != Intervals[i].Left || SvgTessBoundaryShared(Tess, RX0)) {
+                SvgTessChainAdd(Tess, &Region.LeftFirst, &Region.LeftLast, SvgTessVertex(Tess, RX0, y));
+            }
+            if (Region.Right != Intervals[i].Right || SvgTessBoundaryShared(Tess, RX1)) {
+                SvgTessChainAdd(Tess, &Region.RightFirst, &Region.RightLast, SvgTessVertex(Tess, RX1, y));
+            }
+
+            Region.Left = Intervals[i].Left;
+            Region.Right = Intervals[i].Right;
+            Tess->NextRegions.Push(Region);
+            ++r;
+            ++i;
+        } else if (r < RegionCount && (i >= IntervalCount || RX0 <= Intervals[i].X0)) {
+            SvgTessClose(Tess, Regions + r, y);
+            ++r;
+        } else {
+            SvgTessOpen(Tess, Intervals + i, y);
+            ++i;
+        }
+    }
+
+    svg_array<svg_tess_region> Swap = Tess->Regions;
+    Tess->Regions = Tess->NextRegions;
+    Tess->NextRegions = Swap;
+}
+
+// note: sorts the active edges in the slab [Y0, Y1) and shortens it to the first crossing
+internal r32
+SvgTessSlab(svg_tessellator *Tess, r32 Y0, r32 Y1)
+{
+    svg_tess_edge *Edges = Tess->Edges.Data;
+    svg_tess_active *Active = Tess->Active.Data;
+    u32 Count = Tess->Active.Count;
+
+    for (u32 Iteration=0; Iteration<SVG_TESS_MAX_SPLITS; ++Iteration) {
+        r32 Mid = 0.5f * (Y0 + Y1);
+
+        for (u32 a=0; a<Count; ++a) {
+            svg_tess_edge *E = Edges + Active[a].Edge;
+            Active[a].X0 = SvgTessEdgeX(E, Y0);
+            Active[a].X1 = SvgTessEdgeX(E, Y1);
+            Active[a].Mid = SvgTessEdgeX(E, Mid);
+        }
+
+        // note: the order barely changes between slabs
+        for (u32 a=1; a<Count; ++a) {
+            svg_tess_active Item = Active[a];
+            u32 b = a;
+            for (; b>0 && Active[b - 1].Mid > Item.Mid; --b) {
+                Active[b] = Active[b - 1];
+            }
+            Active[b] = Item;
+        }
+
+        r32 Split = Y1;
+
+        for (u32 a=0; a+1<Count; ++a) {
+            r32 D0 = Active[a].X0 - Active[a + 1].X0;
+            r32 D1 = Active[a].X1 - Active[a + 1].X1;
+
+            if ((D0 > SVG_TESS_EPSILON || D1 > SVG_TESS_EPSILON) && D0 != D1) {
+                r32 y = Y0 + (Y1 - Y0) * (D0 / (D0 - D1));
+                if (y > Y0 && y < Split) {
+                    Split = y;
+                }
+            }
+        }
+
+        if (Split == Y1) {
+            break;
+        }
+
+        Y1 = Split;
+    }
+
+    return Y1;
+}
+
+internal void
+SvgTessIntervals(svg_tessellator *Tess, svg_fill_rule_ Rule)
+{
+    svg_tess_edge *Edges = Tess->Edges.Data;
+    svg_tess_active *Active = Tess->Active.Data;
+    s32 Winding = 0;
+    u32 Left = 0;
+
+    Tess->Intervals.Count = 0;
+
+    for (u32 a=0; a<Tess->Active.Count; ++a) {
+        b32 Before = (Rule == SvgFillRule_EvenOdd) ? (Winding & 1) : (Winding != 0);
+        Winding += Edges[Active[a].Edge].Winding;
+        b32 After = (Rule == SvgFillRule_EvenOdd) ? (Winding & 1) : (Winding != 0);
+
+        if (!Before && After) {
+            Left = a;
+        } else if (Before && !After) {
+            svg_tess_interval Interval = {Active[Left].Edge, Active[a].Edge, Active[Left].X0, Active[a].X0};
+            Tess->Intervals.Push(Interval);
+        }
+    }
+}
+
+void
+SvgTessellateElement(svg_tessellator *Tess, svg *Svg, svg_element *E, u32 Element, svg_transform T, r32 Tolerance,
+                     svg_mesh *Mesh)
+{
+    // note: the parser only produces paths
+    if (E->Type != SvgElement_Path || !(E->Fill & 0xff)) {
+        return;
+    }
+
+    svg_path *Path = SvgElementPath(Svg, E);
+    if (!Path->Segments.Count) {
+        return;
+    }
+
+    svg_polyline *Polyline = &Tess->Polyline;
+    Polyline->Points.Count = 0;
+    Polyline->ContourEnds.Count = 0;
+    SvgFlattenPath(Path, T, Tolerance, Polyline);
+
+    // note: contours are closed implicitly, horizontal edges don't bound any interval
+    Tess->Edges.Count = 0;
+    Tess->Ys.Count = 0;
+
+    u32 Start = 0;
+    svg_v2 *Points = Polyline->Points.Data;
+
+    for (u32 c=0; c<Polyline->ContourEnds.Count; ++c) {
+        u32 End = Polyline->ContourEnds.Data[c];
+
+        for (u32 i=Start; i<End; ++i) {
+            svg_v2 A = Points[i];
+            svg_v2 B = (i + 1 < End) ? Points[i + 1] : Points[Start];
+
+            if (A.y == B.y) {
+                continue;
+            }
+
+            svg_tess_edge Edge = (A.y < B.y) ? svg_tess_edge{A, B, 1} : svg_tess_edge{B, A, -1};
+            Tess->Edges.Push(Edge);
+            Tess->Ys.Push(A.y);
+            Tess->Ys.Push(B.y);
+        }
+
+        Start = End;
+    }
+
+    u32 EdgeCount = Tess->Edges.Count;
+    if (!EdgeCount) {
+        return;
+    }
+
+    qsort(Tess->Edges.Data, EdgeCount, sizeof(svg_tess_edge), SvgTessCompareEdges);
+    qsort(Tess->Ys.Data, Tess->Ys.Count, sizeof(r32), SvgTessCompareReals);
+
+    u32 YCount = 1;
+    for (u32 i=1; i<Tess->Ys.Count; ++i) {
+        if (Tess->Ys.Data[i] != Tess->Ys.Data[YCount - 1]) {
+            Tess->Ys.Data[YCount++] = Tess->Ys.Data[i];
+        }
+    }
+    Tess->Ys.Count = YCount;
+
+    Tess->Mesh = Mesh;
+    Tess->FirstVertex = Mesh->Vertices.Count;
+    Tess->Hash.Count = 0;
+    Tess->Links.Count = 0;
+    Tess->Active.Count = 0;
+    Tess->Regions.Count = 0;
+
+    svg_mesh_range Range = {};
+    Range.Element = Element;
+    Range.FirstVertex = Mesh->Vertices.Count;
+    Range.FirstIndex = Mesh->Indices.Count;
+
+    svg_tess_edge *Edges = Tess->Edges.Data;
+    r32 *Ys = Tess->Ys.Data;
+    r32 y = Ys[0];
+    u32 NextEdge = 0;
+    u32 NextY = 1;
+
+    for (;;) {
+        u32 Kept = 0;
+        for (u32 a=0; a<Tess->Active.Count; ++a) {
+            if (Edges[Tess->Active.Data[a].Edge].Bottom.y > y) {
+                Tess->Active.Data[Kept++] = Tess->Active.Data[a];
+            }
+        }
+        Tess->Active.Count = Kept;
+
+        for (; NextEdge<EdgeCount && Edges[NextEdge].Top.y <= y; ++NextEdge) {
+            Tess->Active.Push({NextEdge});
+        }
+
+        for (; NextY<YCount && Ys[NextY] <= y; ++NextY);
+
+        r32 Next = y;
+        if (NextY < YCount) {
+            Next = SvgTessSlab(Tess, y, Ys[NextY]);
+            SvgTessIntervals(Tess, E->FillRule);
+        } else {
+            Tess->Intervals.Count = 0;
+        }
+
+        SvgTessBoundary(Tess, y);
+
+        if (NextY >= YCount) {
+            break;
+        }
+
+        y = Next;
+    }
+
+    Range.VertexCount = Mesh->Vertices.Count - Range.FirstVertex;
+    Range.IndexCount = Mesh->Indices.Count - Range.FirstIndex;
+
+    if (Range.IndexCount) {
+        Mesh->Ranges.Push(Range);
+    } else {
+        Mesh->Vertices.Count = Range.FirstVertex;
+    }
+}
+
+// note: replaces the contents of Mesh, one range per element that produced triangles
+void
+SvgTessellate(svg_tessellator *Tess, svg *Svg, svg_transform T, r32 Tolerance, svg_mesh *Mesh)
+{
+    Mesh->Vertices.Count = 0;
+    Mesh->Indices.Count = 0;
+    Mesh->Ranges.Count = 0;
+    Mesh->IndexSize = 4;
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        SvgTessellateElement(Tess, Svg, Svg->Elements.Data + i, i, T, Tolerance, Mesh);
+    }
+}
+
+/*  Packs the indices into 16 bits in place and returns them, or null if a range has more vertices
+    than 16-bit indices can address. Mesh->Indices.Data then holds IndexCount u16 values. */
+u16 *
+SvgMeshIndices16(svg_mesh *Mesh)
+{
+    if (Mesh->IndexSize == 2) {
+        return (u16 *)Mesh->Indices.Data;
+    }
+
+    for (u32 i=0; i<Mesh->Ranges.Count; ++i) {
+        if (Mesh->Ranges.Data[i].VertexCount > 0x10000) {
+            return 0;
+        }
+    }
+
+    // note: the write position never overtakes the read position
+    u8 *Result = (u8 *)Mesh->Indices.Data;
+    for (u32 i=0; i<Mesh->Indices.Count; ++i) {
+        u16 Index = (u16)Mesh->Indices.Data[i];
+        memcpy(Result + 2 * i, &Index, 2);
+    }
+
+    Mesh->IndexSize = 2;
+    return (u16 *)Result;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_TESS
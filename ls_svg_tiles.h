@@ -0,0 +1,436 @@
+#ifndef INCLUDE_GUARD_LS_SVG_TILES
+#define INCLUDE_GUARD_LS_SVG_TILES
+
+/*  Tile-binned renderer.
+
+    All elements are flattened once in device space and every line is binned into the screen tiles
+    it passes through. A tile then renders on its own, with a coverage grid small enough to stay in
+    cache, so tiles spread over the job pool without any locking.
+
+    A tile only sees the lines that enter it, the rest of the path reaches it through its left border.
+    The winding along the left border x = X is the winding at the top left corner (the backdrop) plus
+    a step wherever a line crosses x = X inside the tile. Backdrops come from the lines crossing the
+    top border of a tile row, prefix-summed from left to right. Lines are clipped to the tile with
+    their parts left of the tile dropped, the border steps stand in for them.
+
+    Binning appends entries in paint order, a scatter pass afterwards groups them by tile so every
+    tile reads one contiguous range. */
+
+#define SVG_TILE_SIZE 64
+#define SVG_TILE_NONE 0xffffffff
+
+enum svg_tile_entry_ {
+    SvgTileEntry_Edge,
+    SvgTileEntry_Crossing,
+    SvgTileEntry_Fill,
+};
+
+struct svg_tile_edge {
+    svg_v2 P0;
+    svg_v2 P1;
+};
+
+// note: entries of an element are contiguous within a tile, its Fill entry comes last
+struct svg_tile_entry {
+    svg_tile_entry_ Type;
+    u32 Tile;
+
+    union {
+        svg_tile_edge Edge; // device space
+
+        struct {
+            r32 Y;    // tile space
+            s32 Sign; // winding step below Y
+        } Crossing;
+
+        struct {
+            u32 Element;
+            s32 Backdrop;
+        } Fill;
+    };
+};
+
+struct svg_tile {
+    u32 First;
+    u32 Count;
+    u32 Element; // last element that added entries
+};
+
+// note: scratch memory, keep it around between calls
+struct svg_tiler {
+    svg_array<svg_tile_entry> Entries; // paint order
+    svg_array<svg_tile_entry> Sorted;  // grouped by tile
+    svg_array<svg_tile> Tiles;
+    svg_array<s32> Backdrops;
+    svg_array<u32> Jobs;
+    svg_polyline Polyline;
+
+    s32 Width;
+    s32 Height;
+    s32 TilesX;
+    s32 TilesY;
+
+    svg_rasterizer Rasterizers[SVG_MAX_WORKERS];
+
+    svg *Svg;
+    svg_image *Image;
+};
+
+internal void
+SvgTileAppend(svg_tiler *Tiler, s32 TileX, s32 TileY, u32 Element, svg_tile_entry Entry)
+{
+    Entry.Tile = TileY * Tiler->TilesX + TileX;
+    Tiler->Entries.Push(Entry);
+
+    svg_tile *Tile = Tiler->Tiles.Data + Entry.Tile;
+    Tile->Count++;
+    Tile->Element = Element;
+}
+
+inline s32
+SvgClampS32(s32 Value, s32 Min, s32 Max)
+{
+    return (Value < Min) ? Min : ((Value > Max) ? Max : Value);
+}
+
+// note: Diff holds one row of TX1 - TX0 + 2 backdrop steps per tile row of the element
+internal void
+SvgTilerBinLine(svg_tiler *Tiler, u32 Element, svg_v2 A, svg_v2 B,
+                s32 TX0, s32 TX1, s32 TY0, s32 TY1, s32 *Diff)
+{
+    r32 Size = SVG_TILE_SIZE;
+    s32 Span = TX1 - TX0 + 2;
+    s32 Dir = 1;
+    svg_v2 Top = A;
+    svg_v2 Bottom = B;
+
+    if (A.y > B.y) {
+        Dir = -1;
+        Top = B;
+        Bottom = A;
+    }
+
+    // left borders the line crosses, a border at X counts as crossed when the end points lie on
+    // different sides of x < X
+    if (A.x != B.x) {
+        r32 MinX = SvgMin(A.x, B.x);
+        r32 MaxX = SvgMax(A.x, B.x);
+        s32 Col0 = SvgClampS32((s32)floorf(MinX / Size) + 1, TX0, TX1 + 1);
+        s32 Col1 = SvgClampS32((s32)floorf(MaxX / Size), TX0 - 1, TX1);
+        r32 DyDx = (B.y - A.y) / (B.x - A.x);
+
+        for (s32 tx=Col0; tx<=Col1; ++tx) {
+            r32 X = tx * Size;
+            if (!(MinX < X && X <= MaxX)) {
+                continue;
+            }
+
+            r32 Y = A.y + (X - A.x) * DyDx;
+            s32 ty = (s32)floorf(Y / Size);
+            if (ty < TY0 || ty > TY1) {
+                continue;
+            }
+
+            // note: the backdrop is the winding at the top left corner itself, with points on a border
+            //       right of it. A step right at the corner is already in it when the line is left of
+            //       the border above the corner, and a horizontal line there only moves the end points
+            //       of its neighbours, which count in the backdrop too.
+            if (Y == ty * Size && (A.y == B.y || Top.x < X)) {
+                continue;
+            }
+
+            svg_tile_entry Crossing = {SvgTileEntry_Crossing};
+            Crossing.Crossing.Y = Y - ty * Size;
+
+            if (A.y == B.y) {
+                // note: a horizontal line doesn't cover anything itself, but the lines at its ends
+                //       now sit on different sides of the border. The step is the limit of a
+                //       slightly sloped line, either way it only depends on the x direction.
+                Crossing.Crossing.Sign = (B.x > A.x) ? -1 : 1;
+            } else {
+                Crossing.Crossing.Sign = (Bottom.x < X) ? Dir : -Dir;
+            }
+
+            SvgTileAppend(Tiler, tx, ty, Element, Crossing);
+        }
+    }
+
+    if (A.y == B.y) {
+        return;
+    }
+
+    svg_tile_entry Entry = {SvgTileEntry_Edge};
+    Entry.Edge = {A, B};
+
+    r32 DxDy = (Bottom.x - Top.x) / (Bottom.y - Top.y);
+    s32 Row0 = SvgClampS32((s32)floorf(Top.y / Size), TY0, TY1 + 1);
+    s32 Row1 = SvgClampS32((s32)ceilf(Bottom.y / Size) - 1, TY0 - 1, TY1);
+
+    for (s32 ty=Row0; ty<=Row1; ++ty) {
+        r32 RowTop = ty * Size;
+        r32 Y0 = SvgMax(Top.y, RowTop);
+        r32 Y1 = SvgMin(Bottom.y, RowTop + Size);
+
+        if (Top.y <= RowTop) {
+            // note: crossing the top border adds to the backdrop of every tile right of the crossing
+            r32 X = Top.x + (RowTop - Top.y) * DxDy;
+            s32 Column = SvgClampS32((s32)floorf(X / Size) + 1, TX0, TX1 + 1);
+            Diff[(ty - TY0) * Span + Column - TX0] += Dir;
+        }
+
+        if (Y0 >= Y1) {
+            continue;
+        }
+
+        r32 Xa = Top.x + (Y0 - Top.y) * DxDy;
+        r32 Xb = Top.x + (Y1 - Top.y) * DxDy;
+        s32 Col0 = SvgClampS32((s32)floorf(SvgMin(Xa, Xb) / Size), TX0, TX1 + 1);
+        s32 Col1 = SvgClampS32((s32)floorf(SvgMax(Xa, Xb) / Size), TX0 - 1, TX1);
+
+        for (s32 tx=Col0; tx<=Col1; ++tx) {
+            SvgTileAppend(Tiler, tx, ty, Element, Entry);
+        }
+    }
+}
+
+internal void
+SvgTilerBinElement(svg_tiler *Tiler, svg *Svg, svg_element *E, u32 Element, svg_transform T)
+{
+    // note: the parser only produces paths
+    if (E->Type != SvgElement_Path || !(E->Fill & 0xff)) {
+        return;
+    }
+
+    svg_path *Path = SvgElementPath(Svg, E);
+    if (!Path->Segments.Count) {
+        return;
+    }
+
+    svg_bounds Bounds = SvgTransformBounds(T, Path->Bounds);
+    if (Bounds.Max.x < 0.0f || Bounds.Max.y < 0.0f || Bounds.Min.x >= Tiler->Width || Bounds.Min.y >= Tiler->Height) {
+        return;
+    }
+
+    r32 Size = SVG_TILE_SIZE;
+    s32 TX0 = SvgClampS32((s32)floorf(Bounds.Min.x / Size), 0, Tiler->TilesX - 1);
+    s32 TX1 = SvgClampS32((s32)floorf(Bounds.Max.x / Size), 0, Tiler->TilesX - 1);
+    s32 TY0 = SvgClampS32((s32)floorf(Bounds.Min.y / Size), 0, Tiler->TilesY - 1);
+    s32 TY1 = SvgClampS32((s32)floorf(Bounds.Max.y / Size), 0, Tiler->TilesY - 1);
+    s32 Span = TX1 - TX0 + 2;
+
+    Tiler->Backdrops.Count = 0;
+    s32 *Diff = Tiler->Backdrops.AllocN(Span * (TY1 - TY0 + 1));
+    memset(Diff, 0, Span * (TY1 - TY0 + 1) * sizeof(s32));
+
+    svg_polyline *Polyline = &Tiler->Polyline;
+    Polyline->Points.Count = 0;
+    Polyline->ContourEnds.Count = 0;
+    SvgFlattenPath(Path, T, SVG_RASTER_TOLERANCE, Polyline);
+
+    // note: contours are closed implicitly
+    u32 Start = 0;
+    svg_v2 *Points = Polyline->Points.Data;
+
+    for (u32 c=0; c<Polyline->ContourEnds.Count; ++c) {
+        u32 End = Polyline->ContourEnds.Data[c];
+
+        for (u32 i=Start; i<End; ++i) {
+            svg_v2 B = (i + 1 < End) ? Points[i + 1] : Points[Start];
+            SvgTilerBinLine(Tiler, Element, Points[i], B, TX0, TX1, TY0, TY1, Diff);
+        }
+
+        Start = End;
+    }
+
+    for (s32 ty=TY0; ty<=TY1; ++ty) {
+        s32 *Row = Diff + (ty - TY0) * Span;
+        s32 Backdrop = 0;
+
+        for (s32 tx=TX0; tx<=TX1; ++tx) {
+            Backdrop += Row[tx - TX0];
+
+            svg_tile *Tile = Tiler->Tiles.Data + ty * Tiler->TilesX + tx;
+            if (Tile->Element == Element || Backdrop) {
+                svg_tile_entry Fill = {SvgTileEntry_Fill};
+                Fill.Fill.Element = Element;
+                Fill.Fill.Backdrop = Backdrop;
+                SvgTileAppend(Tiler, tx, ty, Element, Fill);
+            }
+        }
+    }
+}
+
+// note: bins the whole document for a Width x Height render, nothing is drawn yet
+void
+SvgTilerBin(svg_tiler *Tiler, svg *Svg, svg_transform T, s32 Width, s32 Height)
+{
+    Tiler->Width = Width;
+    Tiler->Height = Height;
+    Tiler->TilesX = (Width + SVG_TILE_SIZE - 1) / SVG_TILE_SIZE;
+    Tiler->TilesY = (Height + SVG_TILE_SIZE - 1) / SVG_TILE_SIZE;
+
+    Tiler->Entries.Count = 0;
+    Tiler->Sorted.Count = 0;
+    Tiler->Jobs.Count = 0;
+    Tiler->Tiles.Count = 0;
+
+    u32 TileCount = Tiler->TilesX * Tiler->TilesY;
+    if (TileCount) {
+        Tiler->Tiles.AllocN(TileCount);
+    }
+
+    for (u32 i=0; i<TileCount; ++i) {
+        Tiler->Tiles.Data[i] = {0, 0, SVG_TILE_NONE};
+    }
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        SvgTilerBinElement(Tiler, Svg, Svg->Elements.Data + i, i, T);
+    }
+
+    u32 First = 0;
+    for (u32 i=0; i<TileCount; ++i) {
+        svg_tile *Tile = Tiler->Tiles.Data + i;
+        Tile->First = First;
+        First += Tile->Count;
+
+        if (Tile->Count) {
+            Tiler->Jobs.Push(i);
+        }
+
+        Tile->Count = 0;
+    }
+
+    if (Tiler->Entries.Count) {
+        Tiler->Sorted.AllocN(Tiler->Entries.Count);
+    }
+
+    // note: stable, so every tile keeps the paint order
+    for (u32 i=0; i<Tiler->Entries.Count; ++i) {
+        svg_tile_entry *Entry = Tiler->Entries.Data + i;
+        svg_tile *Tile = Tiler->Tiles.Data + Entry->Tile;
+        Tiler->Sorted.Data[Tile->First + Tile->Count++] = *Entry;
+    }
+}
+
+// note: only the part of the line right of x = 0 is kept, the border steps cover the rest
+internal void
+SvgAccumulateTileLine(svg_rasterizer *R, svg_v2 P0, svg_v2 P1)
+{
+    if (P0.x < 0.0f && P1.x < 0.0f) {
+        return;
+    }
+
+    if (P0.x < 0.0f || P1.x < 0.0f) {
+        svg_v2 Cut = SvgLerp(P0, P1, -P0.x / (P1.x - P0.x));
+        Cut.x = 0.0f;
+
+        if (P0.x < 0.0f) {
+            P0 = Cut;
+        } else {
+            P1 = Cut;
+        }
+    }
+
+    SvgAccumulateLine(R, P0, P1);
+}
+
+internal void
+SvgTileFillSolid(svg_rasterizer *R, svg_fill_rule_ Rule, s32 Backdrop, u32 Color,
+                 svg_image *Image, s32 OriginX, s32 OriginY)
+{
+    b32 Inside = (Rule == SvgFillRule_EvenOdd) ? (Backdrop & 1) : (Backdrop != 0);
+    if (!Inside) {
+        return;
+    }
+
+    memset(R->Coverage.Data, 0xff, R->Width);
+
+    for (s32 y=0; y<R->Height; ++y) {
+        u8 *Dest = Image->Pixels + (OriginY + y) * Image->Pitch + OriginX * 4;
+        SvgBlendRow(Dest, R->Coverage.Data, R->Width, Color);
+    }
+}
+
+internal void
+SvgTileJob(void *Data, u32 Index, u32 Worker)
+{
+    svg_tiler *Tiler = (svg_tiler *)Data;
+    svg_image *Image = Tiler->Image;
+    u32 TileIndex = Tiler->Jobs.Data[Index];
+
+    s32 OriginX = (TileIndex % Tiler->TilesX) * SVG_TILE_SIZE;
+    s32 OriginY = (TileIndex / Tiler->TilesX) * SVG_TILE_SIZE;
+    svg_v2 Origin = {(r32)OriginX, (r32)OriginY};
+
+    s32 Width = (s32)Image->Width - OriginX;
+    s32 Height = (s32)Image->Height - OriginY;
+
+    svg_rasterizer *R = Tiler->Rasterizers + Worker;
+    SvgRasterizerBegin(R, (Width < SVG_TILE_SIZE) ? Width : SVG_TILE_SIZE,
+                       (Height < SVG_TILE_SIZE) ? Height : SVG_TILE_SIZE);
+
+    b32 Touched = false;
+    svg_tile *Tile = Tiler->Tiles.Data + TileIndex;
+    svg_tile_entry *Entries = Tiler->Sorted.Data + Tile->First;
+
+    for (u32 i=0; i<Tile->Count; ++i) {
+        svg_tile_entry *Entry = Entries + i;
+
+        switch (Entry->Type) {
+            case SvgTileEntry_Edge: {
+                SvgAccumulateTileLine(R, Entry->Edge.P0 - Origin, Entry->Edge.P1 - Origin);
+                Touched = true;
+            } break;
+
+            case SvgTileEntry_Crossing: {
+                svg_v2 A = {0.0f, Entry->Crossing.Y};
+                svg_v2 B = {0.0f, (r32)R->Height};
+                if (Entry->Crossing.Sign > 0) {
+                    SvgAccumulateClippedLine(R, A, B);
+                } else {
+                    SvgAccumulateClippedLine(R, B, A);
+                }
+                Touched = true;
+            } break;
+
+            case SvgTileEntry_Fill: {
+                svg_element *E = Tiler->Svg->Elements.Data + Entry->Fill.Element;
+                s32 Backdrop = Entry->Fill.Backdrop;
+
+                if (!Touched) {
+                    SvgTileFillSolid(R, E->FillRule, Backdrop, E->Fill, Image, OriginX, OriginY);
+                    break;
+                }
+
+                if (Backdrop) {
+                    s32 Stride = R->Width + 2;
+                    for (s32 y=0; y<R->Height; ++y) {
+                        R->Cells.Data[y * Stride] += (r32)Backdrop;
+                        svg_row_extent *Extent = R->Rows.Data + y;
+                        Extent->MinX = 0;
+                        if (Extent->MaxX < 1) Extent->MaxX = 1;
+                    }
+                    R->MinRow = 0;
+                    R->MaxRow = R->Height;
+                }
+
+                SvgRasterResolve(R, E->FillRule, E->Fill, Image, OriginX, OriginY, true);
+                Touched = false;
+            } break;
+        }
+    }
+}
+
+// note: composites over whatever is in Image, same as SvgRasterize. Pool may be null.
+void
+SvgRasterizeTiled(svg_tiler *Tiler, svg *Svg, svg_image *Image, svg_transform T, svg_job_pool *Pool)
+{
+    SvgTilerBin(Tiler, Svg, T, Image->Width, Image->Height);
+
+    Tiler->Svg = Svg;
+    Tiler->Image = Image;
+
+    SvgParallelFor(Pool, Tiler->Jobs.Count, SvgTileJob, Tiler);
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_TILES
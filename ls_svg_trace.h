@@ -0,0 +1,175 @@
+#ifndef INCLUDE_GUARD_LS_SVG_TRACE
+#define INCLUDE_GUARD_LS_SVG_TRACE
+
+/*  Timing zones for finding out where a slow document spends its time.
+
+    Define LS_SVG_TRACE and include this before ls_svg.h. The parser's zones (SvgParse,
+    SvgParseProperty, SvgParsePath and svg_array growth) then record their rdtsc begin and end into
+    a ring buffer of the thread they ran on, the last SVG_TRACE_EVENTS zones per thread are kept.
+    Off x86 the ticks are steady_clock nanoseconds instead.
+    Without LS_SVG_TRACE LS_SVG_ZONE expands to nothing and the trace stays empty, the functions
+    below still exist so callers don't need their own #ifdefs.
+
+    SvgTraceWrite dumps the buffers as Chrome trace_event JSON (complete "X" events, microseconds),
+    which chrome://tracing, Perfetto and speedscope load. Ticks are converted with a rate measured
+    between SvgTraceReset and the dump. Neither may run while zones are open on other threads. */
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LS_SVG_RDTSC
+#endif
+
+#ifdef LS_SVG_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+#include <atomic>
+#include <chrono>
+
+// note: per thread, a power of two
+#define SVG_TRACE_EVENTS (1 << 16)
+
+struct svg_trace_event {
+    const char *Name; // a literal, only the pointer is stored
+    u64 Begin;
+    u64 End;
+};
+
+struct svg_trace_buffer {
+    svg_trace_event Events[SVG_TRACE_EVENTS];
+    u64 Count; // events ever recorded, the ring holds the last SVG_TRACE_EVENTS
+    u32 Thread;
+    svg_trace_buffer *Next;
+};
+
+struct svg_trace {
+    std::atomic<svg_trace_buffer *> Buffers; // every thread that recorded, newest first
+    std::atomic<u32> ThreadCount;
+
+    // note: clock pair taken by SvgTraceReset, the dump takes another for the tick rate
+    u64 StartTicks;
+    r64 StartSeconds;
+};
+
+static svg_trace SvgTrace;
+static thread_local svg_trace_buffer *SvgTraceThreadBuffer;
+
+inline r64
+SvgTraceSeconds()
+{
+    auto Now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<r64>(Now).count();
+}
+
+// note: the time stamp counter, steady_clock nanoseconds where there is none
+inline u64
+SvgTraceTicks()
+{
+#ifdef LS_SVG_RDTSC
+    return __rdtsc();
+#else
+    auto Now = std::chrono::steady_clock::now().time_since_epoch();
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(Now).count();
+#endif
+}
+
+// note: the calling thread's buffer, made on its first zone. Buffers live until the process ends
+internal svg_trace_buffer *
+SvgTraceBuffer()
+{
+    svg_trace_buffer *Buffer = SvgTraceThreadBuffer;
+
+    if (!Buffer) {
+        Buffer = (svg_trace_buffer *)calloc(1, sizeof(svg_trace_buffer));
+        Buffer->Thread = SvgTrace.ThreadCount++;
+        Buffer->Next = SvgTrace.Buffers.load(std::memory_order_relaxed);
+        while (!SvgTrace.Buffers.compare_exchange_weak(Buffer->Next, Buffer, std::memory_order_release)) {
+        }
+        SvgTraceThreadBuffer = Buffer;
+    }
+
+    return Buffer;
+}
+
+// note: records one event from its construction to the end of the scope
+struct svg_trace_zone {
+    const char *Name;
+    u64 Begin;
+
+    svg_trace_zone(const char *ZoneName) {
+        this->Name = ZoneName;
+        this->Begin = SvgTraceTicks();
+    }
+
+    ~svg_trace_zone() {
+        u64 End = SvgTraceTicks();
+        svg_trace_buffer *Buffer = SvgTraceBuffer();
+        Buffer->Events[Buffer->Count & (SVG_TRACE_EVENTS - 1)] = {this->Name, this->Begin, End};
+        Buffer->Count++;
+    }
+};
+
+#ifdef LS_SVG_TRACE
+#define LS_SVG_ZONE_JOIN2(A, B) A##B
+#define LS_SVG_ZONE_JOIN(A, B) LS_SVG_ZONE_JOIN2(A, B)
+#define LS_SVG_ZONE(Name) svg_trace_zone LS_SVG_ZONE_JOIN(SvgZone, __LINE__)(Name)
+#else
+#define LS_SVG_ZONE(Name)
+#endif
+
+// note: forgets every recorded event and restarts the clock, for one timeline per document
+void
+SvgTraceReset()
+{
+    for (svg_trace_buffer *B = SvgTrace.Buffers.load(std::memory_order_acquire); B; B = B->Next) {
+        B->Count = 0;
+    }
+
+    SvgTrace.StartTicks = SvgTraceTicks();
+    SvgTrace.StartSeconds = SvgTraceSeconds();
+}
+
+// note: the Chrome trace of everything since SvgTraceReset, false if the file can't be written
+b32
+SvgTraceWrite(char *FileName)
+{
+    FILE *F = fopen(FileName, "wb");
+    if (!F) {
+        return false;
+    }
+
+    // note: ticks per microsecond, measured over the traced time itself
+    u64 Ticks = SvgTraceTicks() - SvgTrace.StartTicks;
+    r64 Seconds = SvgTraceSeconds() - SvgTrace.StartSeconds;
+    r64 TicksPerUs = (Seconds > 0.0 && Ticks) ? Ticks / (Seconds * 1e6) : 1.0;
+
+    fprintf(F, "{\"traceEvents\": [\n");
+    b32 First = true;
+
+    for (svg_trace_buffer *B = SvgTrace.Buffers.load(std::memory_order_acquire); B; B = B->Next) {
+        u64 Begin = (B->Count > SVG_TRACE_EVENTS) ? B->Count - SVG_TRACE_EVENTS : 0;
+
+        for (u64 i=Begin; i<B->Count; ++i) {
+            svg_trace_event *E = B->Events + (i & (SVG_TRACE_EVENTS - 1));
+
+            // note: the ticks can come from other cores, a zone that started before the reset is left out
+            if (E->Begin < SvgTrace.StartTicks) {
+                continue;
+            }
+
+            fprintf(F, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                    First ? "" : ",\n", E->Name, B->Thread, (E->Begin - SvgTrace.StartTicks) / TicksPerUs,
+                    (E->End - E->Begin) / TicksPerUs);
+            First = false;
+        }
+    }
+
+    fprintf(F, "\n]}\n");
+    fclose(F);
+
+    return true;
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_TRACE
@@ -0,0 +1,935 @@
+#ifndef INCLUDE_GUARD_LS_SVG_WRITE
+#define INCLUDE_GUARD_LS_SVG_WRITE
+
+/*  SVG writer, the svg back to text.
+
+    Numbers are written in fixed notation (the tokenizer has no exponents) with the fewest digits
+    that still read back as the same float through TokenToReal32, which rounds them correctly, or
+    rounded to Precision decimals. The digits come from the bounds of the float's rounding interval,
+    scaled in u64 with powers of five (a float mantissa has 24 bits, so 64 bit multipliers are
+    enough, Ryu needs 128 bits for doubles). The few bounds that don't fit go through doubles and
+    the result is checked. printf is only used for floats outside 1e-14 .. 1e22.
+
+    Path data is made short: every command is written both absolute and relative and the shorter
+    text wins, repeated command letters are left out, separators are only written where the next
+    number would otherwise run into the previous one, lines that only move along one axis become
+    H and V, curves whose first control point is the reflection of the previous one become S and T,
+    and the closing line of a closed subpath is left to Z. With the shortest numbers a relative
+    command is only used where the reader adds it up to exactly the original point, so written
+    paths read back bit for bit. With a Precision the writer follows the point the reader ends up
+    at, so rounding doesn't add up along a path.
+
+    The output only depends on the svg and the options, it's the same on every run. */
+
+#define SVG_WRITE_SHORTEST -1
+
+// note: longest number, the fallbacks for floats outside 1e-14 .. 1e22 write every digit
+#define SVG_WRITE_REAL_MAX 64
+#define SVG_WRITE_COMMAND_MAX (8 * SVG_WRITE_REAL_MAX)
+
+struct svg_writer {
+    ls_stringbuf *Out;
+    s32 Precision; // decimals, SVG_WRITE_SHORTEST for the shortest round trip
+    b32 Absolute; // only absolute commands, a little faster
+
+    // note: where the reader is after the text written so far
+    svg_v2 Current;
+    svg_v2 Start;
+    char Command; // letter that a bare number continues, 0 if the next command needs one
+    b32 Number; // the text ends in a number
+    b32 Dot; // and that number has a dot
+};
+
+// note: text of one command, with the state the writer has after it
+struct svg_write_command {
+    char Text[SVG_WRITE_COMMAND_MAX];
+    u32 Size;
+    char Command;
+    b32 Number;
+    b32 Dot;
+    b32 Exact; // every point reads back as the original
+    svg_v2 Current;
+};
+
+static const r64 SvgWritePowers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// note: the float the reader gets for Mantissa / 10^Decimals
+inline r32
+SvgWriteDecimalToFloat(u64 Mantissa, s32 Decimals)
+{
+    return ls_string_DecimalToReal32(Mantissa, -Decimals);
+}
+
+// note: the next float up, same as nextafterf(X, HUGE_VALF) for finite X
+inline r32
+SvgWriteNextUp(r32 X)
+{
+    if (X == 0.0f) {
+        return 1e-45f;
+    }
+
+    u32 Bits;
+    memcpy(&Bits, &X, sizeof(Bits));
+    Bits = (X > 0.0f) ? Bits + 1 : Bits - 1;
+    memcpy(&X, &Bits, sizeof(Bits));
+    return X;
+}
+
+// note: X * 10^K with the exact powers
+inline r64
+SvgWriteScale(r64 X, s32 K)
+{
+    return (K >= 0) ? X * SvgWritePowers[K] : X / SvgWritePowers[-K];
+}
+
+static const u64 SvgWritePowers5[] = {
+    1ull, 5ull, 25ull, 125ull, 625ull, 3125ull, 15625ull, 78125ull, 390625ull, 1953125ull, 9765625ull,
+    48828125ull, 244140625ull, 1220703125ull, 6103515625ull, 30517578125ull, 152587890625ull,
+    762939453125ull, 3814697265625ull, 19073486328125ull, 95367431640625ull, 476837158203125ull,
+    2384185791015625ull,
+};
+
+// note: X = Mantissa * 2^Exponent for a positive finite float
+inline void
+SvgWriteFloatBits(r32 X, u32 *Mantissa, s32 *Exponent)
+{
+    u32 Bits;
+    memcpy(&Bits, &X, sizeof(Bits));
+    u32 Biased = (Bits >> 23) & 0xff;
+    *Mantissa = Biased ? (Bits & 0x7fffff) | 0x800000 : (Bits & 0x7fffff);
+    *Exponent = (s32)(Biased ? Biased : 1) - 150;
+}
+
+/*  floor(X * 2^E * 10^K) in Result and whether nothing was cut off, X below 2^30. It is
+    X * 5^K * 2^(E + K), or X * 2^(E + K) / 5^-K for negative K. False if that doesn't fit a u64. */
+internal b32
+SvgWriteScaleExact(u64 X, s32 E, s32 K, u64 *Result, b32 *Exact)
+{
+    s32 Shift = E + K;
+    u64 Scaled = X;
+
+    if (K >= 0) {
+        // note: 5^14 is under 2^33, the product stays under 2^63
+        if (K > 14) {
+            return false;
+        }
+        Scaled = X * SvgWritePowers5[K];
+    }
+
+    if (Shift >= 0) {
+        if (Shift > 62 || (Scaled >> (63 - Shift))) {
+            return false;
+        }
+        Scaled <<= Shift;
+        *Exact = true;
+    } else if (Shift > -64) {
+        *Exact = !(Scaled & ((1ull << -Shift) - 1));
+        Scaled >>= -Shift;
+    } else {
+        *Exact = !Scaled;
+        Scaled = 0;
+    }
+
+    if (K < 0) {
+        if (K < -22) {
+            return false;
+        }
+        u64 Power = SvgWritePowers5[-K];
+        *Exact = *Exact && !(Scaled % Power);
+        Scaled /= Power;
+    }
+
+    *Result = Scaled;
+    return true;
+}
+
+/*  SvgWriteShortest in integers, for the numbers that fit 64 bits, which are nearly all of them.
+    Decided says whether the result is the answer, if not the double path has to find it.
+
+    The floats d with From + d == Value form a range Low .. High, for an absolute number that is
+    Value itself. The reals the reader rounds into that range are the bounds, both sides are exact
+    multiples of a small power of two, as in Ryu. Scaled by 10^K with a power of five and a shift
+    they give the integers in between exactly, so whatever is picked reads back right and nothing
+    is checked afterwards. */
+internal b32
+SvgWriteShortestExact(r32 From, r32 Value, s32 MaxDecimals, u64 *Mantissa, s32 *Decimals, r32 *Read,
+                      b32 *Decided)
+{
+    *Decided = false;
+
+    r32 Low = Value;
+    r32 High = Value;
+    r64 Target = (r64)Value;
+    r32 Sign = 1.0f;
+
+    if (From != 0.0f) {
+        // note: the reals that round to Value, minus From, both exact unless the exponents are far apart
+        r64 Mid = 0.5 * ((r64)Value - (r64)SvgWriteNextUp(-Value));
+        r64 Below = Mid - (r64)From;
+        if (Below + (r64)From != Mid || Mid - Below != (r64)From) {
+            return false;
+        }
+        Mid = 0.5 * ((r64)Value + (r64)SvgWriteNextUp(Value));
+        r64 Above = Mid - (r64)From;
+        if (Above + (r64)From != Mid || Mid - Above != (r64)From) {
+            return false;
+        }
+
+        Target = (r64)Value - (r64)From;
+        if (Target < 0.0) {
+            r64 Swap = Below;
+            Below = -Above;
+            Above = -Swap;
+            Target = -Target;
+            Sign = -1.0f;
+        }
+        if (Below <= 0.0) {
+            return false;
+        }
+
+        // note: a sum exactly halfway rounds to Value if its mantissa is even
+        u32 Bits;
+        memcpy(&Bits, &Value, sizeof(Bits));
+        b32 Ties = !(Bits & 1);
+
+        Low = (r32)Below;
+        if ((r64)Low < Below || ((r64)Low == Below && !Ties)) {
+            Low = SvgWriteNextUp(Low);
+        }
+        High = (r32)Above;
+        if ((r64)High > Above || ((r64)High == Above && !Ties)) {
+            High = -SvgWriteNextUp(-High);
+        }
+
+        if (Low > High) {
+            *Decided = true;
+            return false;
+        }
+    } else if (Value < 0.0f) {
+        Low = High = -Value;
+        Target = -Target;
+        Sign = -1.0f;
+    }
+
+    // note: the gap below a power of two is half the one above
+    u32 MantissaLow;
+    u32 MantissaHigh;
+    s32 ExponentLow;
+    s32 ExponentHigh;
+    SvgWriteFloatBits(Low, &MantissaLow, &ExponentLow);
+    SvgWriteFloatBits(High, &MantissaHigh, &ExponentHigh);
+
+    s32 E = ((ExponentLow < ExponentHigh) ? ExponentLow : ExponentHigh) - 2;
+    if (ExponentLow - 2 - E > 4 || ExponentHigh - 2 - E > 4) {
+        return false;
+    }
+    u64 A = (4 * (u64)MantissaLow - ((MantissaLow == 0x800000 && ExponentLow > -149) ? 1 : 2)) << (ExponentLow - 2 - E);
+    u64 B = (4 * (u64)MantissaHigh + 2) << (ExponentHigh - 2 - E);
+    b32 LowInside = !(MantissaLow & 1);
+    b32 HighInside = !(MantissaHigh & 1);
+
+    // note: as in SvgWriteShortest, the interval is at least 2^(E2 - 1) wide
+    r64 Width = (r64)(B - A);
+    u64 WidthBits;
+    memcpy(&WidthBits, &Width, sizeof(WidthBits));
+    s32 E2 = (s32)((WidthBits >> 52) & 0x7ff) - 1022 + E;
+    s32 K = (((1 - E2) * 78913) >> 18) + 1;
+    K = (K < MaxDecimals) ? K : MaxDecimals;
+    K = (K > -22) ? K : -22;
+
+    u64 L;
+    u64 H;
+    for (;; ++K) {
+        if (K > MaxDecimals) {
+            *Decided = true;
+            return false;
+        }
+
+        b32 ExactLow;
+        b32 ExactHigh;
+        if (!SvgWriteScaleExact(A, E, K, &L, &ExactLow) || !SvgWriteScaleExact(B, E, K, &H, &ExactHigh)) {
+            return false;
+        }
+
+        // note: a bound that is hit exactly only counts where it rounds to the float inside
+        L += (!ExactLow || !LowInside) ? 1 : 0;
+        if (ExactHigh && !HighInside) {
+            if (!H) {
+                continue;
+            }
+            --H;
+        }
+
+        if (L <= H) {
+            break;
+        }
+    }
+
+    while (K > -22) {
+        u64 L10 = (L + 9) / 10;
+        u64 H10 = H / 10;
+        if (!L10 || L10 > H10) {
+            break;
+        }
+        L = L10;
+        H = H10;
+        --K;
+    }
+
+    // note: any of L .. H reads back right, the one nearest to the value looks best
+    r64 Scaled = SvgWriteScale(Target, K);
+    u64 Nearest = (Scaled < 1e15) ? (u64)(Scaled + 0.5) : H;
+    Nearest = (Nearest < L) ? L : (Nearest > H) ? H : Nearest;
+
+    *Mantissa = Nearest;
+    *Decimals = K;
+    *Read = Sign * Low;
+    *Decided = true;
+    return true;
+}
+
+/*  Shortest decimal D with From + D == Value in floats, the way a reader adds up a relative
+    coordinate, From 0 for an absolute one, Read gets D as the reader's float. Decimals stays within
+    MaxDecimals. False if there is none inside the power table, or the bounds were too rough to
+    find it.
+
+    The reals that round to Value, minus From, bound D (give or take the rounding of D itself).
+    The width of the bounds says how many decimals are sure to put a multiple of 10^-K between
+    them, dropping trailing digits while the bounds still hold a multiple of ten then gives the
+    shortest one, the same as Ryu does. Only the result is checked exactly. */
+internal b32
+SvgWriteShortest(r32 From, r32 Value, s32 MaxDecimals, u64 *Mantissa, s32 *Decimals, r32 *Read)
+{
+    b32 Decided;
+    b32 Found = SvgWriteShortestExact(From, Value, MaxDecimals, Mantissa, Decimals, Read, &Decided);
+    if (Decided) {
+        return Found;
+    }
+
+    r64 Below = 0.5 * ((r64)Value - (r64)SvgWriteNextUp(-Value)) - (r64)From;
+    r64 Above = 0.5 * ((r64)Value + (r64)SvgWriteNextUp(Value)) - (r64)From;
+    r64 Target = (r64)Value - (r64)From;
+
+    r32 Sign = 1.0f;
+    if (Target < 0.0) {
+        r64 Swap = Below;
+        Below = -Above;
+        Above = -Swap;
+        Target = -Target;
+        Sign = -1.0f;
+    }
+
+    // note: a relative decimal only has to round to a float the sum rounds right from
+    if (From != 0.0f) {
+        r32 Nearby = (r32)Target;
+        r64 Slack = 0.5 * ((r64)SvgWriteNextUp(Nearby) - (r64)Nearby);
+        Below = (Below - Slack > 0.0) ? Below - Slack : 0.0;
+        Above += Slack;
+    }
+
+    // note: the width is at least 2^(E2 - 1), 78913 / 2^18 is a bit under log10(2)
+    r64 Width = Above - Below;
+    u64 WidthBits;
+    memcpy(&WidthBits, &Width, sizeof(WidthBits));
+    s32 E2 = (s32)((WidthBits >> 52) & 0x7ff) - 1022;
+    s32 Start = (((1 - E2) * 78913) >> 18) + 1;
+    Start = (Start < MaxDecimals) ? Start : MaxDecimals;
+
+    // note: Least goes up when the rough bounds let a decimal through that reads back wrong, a
+    // relative coordinate may have no decimal at all, so it gives up after a few
+    s32 Least = -22;
+    for (u32 Try=0; Try<3; ++Try) {
+        s32 K = (Start > Least) ? Start : Least;
+        u64 L;
+        u64 H;
+
+        for (;; ++K) {
+            if (K > MaxDecimals || K > 22) {
+                return false;
+            }
+
+            r64 ScaledBelow = SvgWriteScale(Below, K);
+            r64 ScaledAbove = SvgWriteScale(Above, K);
+            if (ScaledAbove >= 1e15) {
+                return false;
+            }
+
+            // note: both are positive, truncation is floor
+            L = (u64)ScaledBelow;
+            L += ((r64)L < ScaledBelow) ? 1 : 0;
+            H = (u64)ScaledAbove;
+            if (L <= H) {
+                break;
+            }
+        }
+
+        L = (L > 1) ? L : 1;
+        while (K > Least) {
+            u64 L10 = (L + 9) / 10;
+            u64 H10 = H / 10;
+            if (!L10 || L10 > H10) {
+                break;
+            }
+            L = L10;
+            H = H10;
+            --K;
+        }
+
+        if (L <= H) {
+            // note: the one nearest to the value first
+            r64 Scaled = SvgWriteScale(Target, K);
+            u64 Nearest = (Scaled < 1e15) ? (u64)(Scaled + 0.5) : H;
+            Nearest = (Nearest < L) ? L : (Nearest > H) ? H : Nearest;
+            u64 Candidates[] = {Nearest, L, H};
+
+            for (u32 c=0; c<3; ++c) {
+                r32 Candidate = Sign * SvgWriteDecimalToFloat(Candidates[c], K);
+                if (From + Candidate == Value) {
+                    *Mantissa = Candidates[c];
+                    *Decimals = K;
+                    *Read = Candidate;
+                    return true;
+                }
+            }
+        }
+
+        Least = K + 1;
+    }
+
+    return false;
+}
+
+static const char SvgWriteDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// note: digits of Mantissa with the dot Decimals from the right, no leading 0 before the dot
+internal u32
+SvgWriteDecimal(char *Out, b32 Negative, u64 Mantissa, s32 Decimals)
+{
+    while (Mantissa && Decimals > 0 && Mantissa % 10 == 0) {
+        Mantissa /= 10;
+        --Decimals;
+    }
+
+    if (!Mantissa) {
+        Out[0] = '0';
+        return 1;
+    }
+
+    // note: from the back, two digits at a time
+    char Digits[24];
+    char *First = Digits + sizeof(Digits);
+    while (Mantissa >= 100) {
+        First -= 2;
+        memcpy(First, SvgWriteDigitPairs + 2 * (Mantissa % 100), 2);
+        Mantissa /= 100;
+    }
+    if (Mantissa >= 10) {
+        First -= 2;
+        memcpy(First, SvgWriteDigitPairs + 2 * Mantissa, 2);
+    } else {
+        *--First = (char)('0' + Mantissa);
+    }
+    s32 Count = (s32)(Digits + sizeof(Digits) - First);
+
+    u32 Size = 0;
+    if (Negative) {
+        Out[Size++] = '-';
+    }
+
+    if (Decimals <= 0) {
+        memcpy(Out + Size, First, Count);
+        memset(Out + Size + Count, '0', -Decimals);
+        Size += Count - Decimals;
+    } else if (Decimals >= Count) {
+        Out[Size++] = '.';
+        memset(Out + Size, '0', Decimals - Count);
+        memcpy(Out + Size + Decimals - Count, First, Count);
+        Size += Decimals;
+    } else {
+        s32 Whole = Count - Decimals;
+        memcpy(Out + Size, First, Whole);
+        Out[Size + Whole] = '.';
+        memcpy(Out + Size + Whole + 1, First + Whole, Decimals);
+        Size += Count + 1;
+    }
+
+    return Size;
+}
+
+// note: every digit of a float too large or too small for the power table, these are exact
+internal u32
+SvgWriteAllDigits(char *Out, r32 Value)
+{
+    char Buffer[SVG_WRITE_REAL_MAX];
+    int Size = snprintf(Buffer, sizeof(Buffer), "%.*f", (fabsf(Value) < 1.0f) ? 50 : (fabsf(Value) < 16777216.0f) ? 23 : 0, (r64)Value);
+    Size = (Size < (int)sizeof(Buffer)) ? Size : (int)sizeof(Buffer) - 1;
+
+    char *At = Buffer;
+    char *End = Buffer + Size;
+    if (memchr(Buffer, '.', Size)) {
+        while (End[-1] == '0') {
+            --End;
+        }
+    }
+
+    u32 Result = 0;
+    if (*At == '-') {
+        Out[Result++] = *At++;
+    }
+    if (At[0] == '0' && At[1] == '.') {
+        ++At;
+    }
+
+    memcpy(Out + Result, At, End - At);
+    return Result + (u32)(End - At);
+}
+
+/*  Writes Value - From to Out (at least SVG_WRITE_REAL_MAX bytes) and returns the size. Read
+    receives the float the text reads back as, From + Read is Value unless Precision rounded it.
+    Without Precision a relative value that no decimal adds up to exactly writes nothing. */
+internal u32
+SvgWriteReal(char *Out, r32 From, r32 Value, s32 Precision, r32 *Read)
+{
+    *Read = 0.0f;
+
+    // note: NaN and infinity have no path syntax
+    if (Value == From || !(Value - Value == 0.0f) || !(From - From == 0.0f)) {
+        Out[0] = '0';
+        return 1;
+    }
+
+    r64 Target = (r64)Value - (r64)From;
+    b32 Negative = Target < 0.0;
+    r32 Sign = Negative ? -1.0f : 1.0f;
+    u64 Mantissa;
+    s32 Decimals;
+
+    if (SvgWriteShortest(From, Value, (Precision >= 0) ? Precision : 22, &Mantissa, &Decimals, Read)) {
+        return SvgWriteDecimal(Out, Negative, Mantissa, Decimals);
+    }
+
+    // note: no relative decimal adds up to Value, the caller writes it absolute instead
+    if (Precision < 0 && From != 0.0f) {
+        return 0;
+    }
+
+    r64 Magnitude = fabs(Target);
+    if (Precision >= 0) {
+        s32 P = (Precision < 22) ? Precision : 22;
+
+        if (Magnitude * SvgWritePowers[P] < 9e18) {
+            Mantissa = (u64)floor(Magnitude * SvgWritePowers[P] + 0.5);
+            *Read = Sign * SvgWriteDecimalToFloat(Mantissa, P);
+            return SvgWriteDecimal(Out, Negative && Mantissa, Mantissa, P);
+        }
+    }
+
+    // note: no short decimal, every digit of the nearest float
+    *Read = (r32)Target;
+    return SvgWriteAllDigits(Out, *Read);
+}
+
+// note: Value as svg text, Out needs SVG_WRITE_REAL_MAX bytes. Precision as in svg_writer
+u32
+SvgFormatReal(char *Out, r32 Value, s32 Precision)
+{
+    r32 Read;
+    return SvgWriteReal(Out, 0.0f, Value, Precision, &Read);
+}
+
+void
+SvgWriterInit(svg_writer *W, ls_stringbuf *Out, s32 Precision, b32 Absolute)
+{
+    *W = {};
+    W->Out = Out;
+    W->Precision = Precision;
+    W->Absolute = Absolute;
+}
+
+internal void
+SvgWriteBytes(svg_writer *W, const char *Bytes, u32 Size)
+{
+    ls_stringbuf *Out = W->Out;
+    Out->FitSize(Size + 1);
+    memcpy(Out->Data + Out->Size, Bytes, Size);
+    Out->Size += Size;
+    Out->Data[Out->Size] = 0;
+}
+
+internal void
+SvgWriteText(svg_writer *W, const char *String)
+{
+    SvgWriteBytes(W, String, ls_string_Strlen((char *)String));
+}
+
+internal void
+SvgWriteBegin(svg_writer *W, svg_write_command *C, char Letter)
+{
+    C->Size = 0;
+    C->Number = W->Number;
+    C->Dot = W->Dot;
+    C->Exact = true;
+    C->Current = W->Current;
+
+    if (Letter != W->Command) {
+        C->Text[C->Size++] = Letter;
+        C->Number = false;
+    }
+    C->Command = Letter;
+}
+
+// note: appends a number, with a space only where it would run into the previous one
+internal r32
+SvgWriteNumber(svg_writer *W, svg_write_command *C, r32 From, r32 Value)
+{
+    char Buffer[SVG_WRITE_REAL_MAX];
+    r32 Read;
+    u32 Size = SvgWriteReal(Buffer, From, Value, W->Precision, &Read);
+    if (!Size) {
+        C->Exact = false;
+        return Value - From;
+    }
+
+    if (C->Number && Buffer[0] != '-' && !(Buffer[0] == '.' && C->Dot)) {
+        C->Text[C->Size++] = ' ';
+    }
+
+    memcpy(C->Text + C->Size, Buffer, Size);
+    C->Size += Size;
+    C->Number = true;
+    C->Dot = memchr(Buffer, '.', Size) != 0;
+
+    return Read;
+}
+
+/*  One way of writing a command: Values in order, Axes says which are x (0) and y (1) coordinates,
+    the ones a relative command takes from the current point, 2 for the rest. EndX and EndY are the
+    values that become the current point, -1 keeps that coordinate. False once the text reaches
+    Limit bytes or a shortest relative coordinate can't be read back exactly, it lost then. */
+internal b32
+SvgWriteCandidate(svg_writer *W, svg_write_command *C, char Letter, r32 *Values, u8 *Axes, u32 Count,
+                  s32 EndX, s32 EndY, b32 Relative, u32 Limit)
+{
+    SvgWriteBegin(W, C, Relative ? (char)(Letter | 0x20) : Letter);
+    r32 Base[2] = {W->Current.x, W->Current.y};
+
+    for (u32 i=0; i<Count; ++i) {
+        r32 Point;
+
+        if (Axes[i] < 2) {
+            r32 From = Relative ? Base[Axes[i]] : 0.0f;
+            Point = From + SvgWriteNumber(W, C, From, Values[i]);
+            C->Exact = C->Exact && Point == Values[i];
+
+            if (!C->Exact && W->Precision < 0) {
+                return false;
+            }
+        } else {
+            // note: radii, angles and flags are written as they are
+            Point = SvgWriteNumber(W, C, 0.0f, Values[i]);
+        }
+
+        if ((s32)i == EndX) {
+            C->Current.x = Point;
+        }
+        if ((s32)i == EndY) {
+            C->Current.y = Point;
+        }
+
+        if (C->Size >= Limit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// note: writes the shorter of the absolute and the relative form of a command, Letter is upper case
+internal void
+SvgWriteCommand(svg_writer *W, char Letter, r32 *Values, u8 *Axes, u32 Count, s32 EndX, s32 EndY)
+{
+    svg_write_command Absolute;
+    svg_write_command Relative;
+    svg_write_command *Chosen = &Absolute;
+
+    // note: rounded text never reads back exactly, the reader's point is followed instead. Relative
+    // usually wins, so it goes first and the absolute form stops as soon as it is longer
+    b32 RelativeDone = !W->Absolute &&
+        SvgWriteCandidate(W, &Relative, Letter, Values, Axes, Count, EndX, EndY, true, SVG_WRITE_COMMAND_MAX);
+    u32 Limit = RelativeDone ? Relative.Size + 1 : SVG_WRITE_COMMAND_MAX;
+
+    if (!SvgWriteCandidate(W, &Absolute, Letter, Values, Axes, Count, EndX, EndY, false, Limit) && RelativeDone) {
+        Chosen = &Relative;
+    }
+
+    SvgWriteBytes(W, Chosen->Text, Chosen->Size);
+    W->Command = Chosen->Command;
+    W->Number = Chosen->Number;
+    W->Dot = Chosen->Dot;
+    W->Current = Chosen->Current;
+}
+
+// note: the control point a reader reflects for S and T
+inline svg_v2
+SvgWriteReflect(svg_v2 Current, svg_v2 Control)
+{
+    return {Current.x + -(Control.x - Current.x), Current.y + -(Control.y - Current.y)};
+}
+
+internal void
+SvgWriteSegment(svg_writer *W, svg_path_segement *S, svg_path_segement *Previous)
+{
+    r32 Values[7];
+    u8 Axes[7] = {0, 1, 0, 1, 0, 1};
+
+    switch (S->Type) {
+        case SvgSegment_Line: {
+            if (S->P1.y == S->P2.y) {
+                Values[0] = S->P2.x;
+                SvgWriteCommand(W, 'H', Values, Axes, 1, 0, -1);
+            } else if (S->P1.x == S->P2.x) {
+                Values[0] = S->P2.y;
+                Axes[0] = 1;
+                SvgWriteCommand(W, 'V', Values, Axes, 1, -1, 0);
+            } else {
+                Values[0] = S->P2.x;
+                Values[1] = S->P2.y;
+                SvgWriteCommand(W, 'L', Values, Axes, 2, 0, 1);
+            }
+        } break;
+        case SvgSegment_CubicBezier: {
+            b32 AfterCubic = Previous && Previous->Type == SvgSegment_CubicBezier;
+            svg_v2 Reflected = AfterCubic ? SvgWriteReflect(S->P1, Previous->C2) : S->P1;
+
+            if (S->C1 == Reflected) {
+                svg_v2 Points[] = {S->C2, S->P2};
+                memcpy(Values, Points, sizeof(Points));
+                SvgWriteCommand(W, 'S', Values, Axes, 4, 2, 3);
+            } else {
+                svg_v2 Points[] = {S->C1, S->C2, S->P2};
+                memcpy(Values, Points, sizeof(Points));
+                SvgWriteCommand(W, 'C', Values, Axes, 6, 4, 5);
+            }
+        } break;
+        case SvgSegment_QuadraticBezier: {
+            b32 AfterQuadratic = Previous && Previous->Type == SvgSegment_QuadraticBezier;
+            svg_v2 Reflected = AfterQuadratic ? SvgWriteReflect(S->P1, Previous->C1) : S->P1;
+
+            if (S->C1 == Reflected) {
+                svg_v2 Points[] = {S->P2};
+                memcpy(Values, Points, sizeof(Points));
+                SvgWriteCommand(W, 'T', Values, Axes, 2, 0, 1);
+            } else {
+                svg_v2 Points[] = {S->C1, S->P2};
+                memcpy(Values, Points, sizeof(Points));
+                SvgWriteCommand(W, 'Q', Values, Axes, 4, 2, 3);
+            }
+        } break;
+        case SvgSegment_Elliptical: {
+            r32 Arc[] = {S->Rx, S->Ry, S->Angle, S->UseLargeArc ? 1.0f : 0.0f, S->Clockwise ? 1.0f : 0.0f,
+                         S->P2.x, S->P2.y};
+            u8 ArcAxes[] = {2, 2, 2, 2, 2, 0, 1};
+            SvgWriteCommand(W, 'A', Arc, ArcAxes, 7, 5, 6);
+        } break;
+    }
+}
+
+// note: appends the d attribute text of Path, without the quotes
+void
+SvgWritePathData(svg_writer *W, svg_path *Path)
+{
+    W->Current = {};
+    W->Start = {};
+    W->Command = 0;
+    W->Number = false;
+    W->Dot = false;
+
+    u32 At = 0;
+    svg_contour Contour;
+    while (SvgNextContour(Path, &At, &Contour)) {
+        r32 Move[] = {Contour.Segments[0].P1.x, Contour.Segments[0].P1.y};
+        u8 Axes[] = {0, 1};
+
+        // note: a bare number after a move is a line
+        W->Command = 0;
+        SvgWriteCommand(W, 'M', Move, Axes, 2, 0, 1);
+        W->Start = W->Current;
+        W->Command = (W->Command == 'm') ? 'l' : 'L';
+
+        u32 Count = Contour.Count;
+        svg_path_segement *Last = Contour.Segments + Count - 1;
+        svg_v2 Start = Contour.Segments[0].P1;
+
+        // note: Z draws the closing line itself
+        if (Contour.Closed && Count > 1 && Last->Type == SvgSegment_Line && Last->P2 == Start && Last->P1 != Start) {
+            --Count;
+        }
+
+        for (u32 i=0; i<Count; ++i) {
+            SvgWriteSegment(W, Contour.Segments + i, i ? Contour.Segments + i - 1 : 0);
+        }
+
+        if (Contour.Closed) {
+            SvgWriteBytes(W, "Z", 1);
+            W->Command = 0;
+            W->Number = false;
+            W->Current = W->Start;
+        }
+    }
+}
+
+internal void
+SvgWriteAttribute(svg_writer *W, const char *Name, r32 Value)
+{
+    char Buffer[SVG_WRITE_REAL_MAX];
+    u32 Size = SvgFormatReal(Buffer, Value, SVG_WRITE_SHORTEST);
+
+    SvgWriteText(W, Name);
+    SvgWriteBytes(W, "=\"", 2);
+    SvgWriteBytes(W, Buffer, Size);
+    SvgWriteBytes(W, "\"", 1);
+}
+
+// note: "none" or #rrggbb, #rgb where that's the same color. Alpha other than opaque goes to Opacity
+internal void
+SvgWriteColor(svg_writer *W, const char *Name, const char *Opacity, u32 Color)
+{
+    static const char Hex[] = "0123456789abcdef";
+
+    SvgWriteText(W, Name);
+
+    if (!Color) {
+        SvgWriteText(W, "=\"none\"");
+        return;
+    }
+
+    char Buffer[10] = "=\"#";
+    u32 Size = 3;
+    b32 Short = true;
+    for (u32 i=0; i<3; ++i) {
+        u32 Byte = (Color >> (24 - i * 8)) & 0xff;
+        Short = Short && (Byte >> 4) == (Byte & 0xf);
+    }
+
+    for (u32 i=0; i<(Short ? 3u : 6u); ++i) {
+        u32 Shift = Short ? 28 - i * 8 : 28 - i * 4;
+        Buffer[Size++] = Hex[(Color >> Shift) & 0xf];
+    }
+    Buffer[Size++] = '"';
+    SvgWriteBytes(W, Buffer, Size);
+
+    if ((Color & 0xff) != 0xff) {
+        SvgWriteAttribute(W, Opacity, (Color & 0xff) / 255.0f);
+    }
+}
+
+/*  Style attributes of a tag that differ from what it inherits. Each one starts with a space. Dash
+    patterns are compared by value. */
+internal void
+SvgWriteStyle(svg_writer *W, svg *Svg, svg_fill_rule_ FillRule, u32 Fill, u32 Stroke, svg_stroke_style *Style,
+              svg_fill_rule_ InheritedFillRule, u32 InheritedFill, u32 InheritedStroke, svg_stroke_style *Inherited)
+{
+    static const char *Joins[] = {"miter", "round", "bevel"};
+    static const char *Caps[] = {"butt", "round", "square"};
+
+    if (Fill != InheritedFill) {
+        SvgWriteColor(W, " fill", " fill-opacity", Fill);
+    }
+    if (FillRule != InheritedFillRule) {
+        SvgWriteText(W, (FillRule == SvgFillRule_EvenOdd) ? " fill-rule=\"evenodd\"" : " fill-rule=\"nonzero\"");
+    }
+    if (Stroke != InheritedStroke) {
+        SvgWriteColor(W, " stroke", " stroke-opacity", Stroke);
+    }
+    if (Style->Width != Inherited->Width) {
+        SvgWriteAttribute(W, " stroke-width", Style->Width);
+    }
+    if (Style->Join != Inherited->Join) {
+        SvgWriteText(W, " stroke-linejoin=\"");
+        SvgWriteText(W, Joins[Style->Join]);
+        SvgWriteText(W, "\"");
+    }
+    if (Style->Cap != Inherited->Cap) {
+        SvgWriteText(W, " stroke-linecap=\"");
+        SvgWriteText(W, Caps[Style->Cap]);
+        SvgWriteText(W, "\"");
+    }
+    if (Style->MiterLimit != Inherited->MiterLimit) {
+        SvgWriteAttribute(W, " stroke-miterlimit", Style->MiterLimit);
+    }
+
+    b32 SameDashes = Style->DashCount == Inherited->DashCount;
+    for (u32 i=0; SameDashes && i<Style->DashCount; ++i) {
+        SameDashes = Svg->Dashes.Data[Style->DashFirst + i] == Svg->Dashes.Data[Inherited->DashFirst + i];
+    }
+
+    if (!SameDashes) {
+        SvgWriteText(W, " stroke-dasharray=\"");
+        if (!Style->DashCount) {
+            SvgWriteText(W, "none");
+        }
+        for (u32 i=0; i<Style->DashCount; ++i) {
+            char Buffer[SVG_WRITE_REAL_MAX];
+            u32 Size = SvgFormatReal(Buffer, Svg->Dashes.Data[Style->DashFirst + i], SVG_WRITE_SHORTEST);
+            if (i) {
+                SvgWriteBytes(W, " ", 1);
+            }
+            SvgWriteBytes(W, Buffer, Size);
+        }
+        SvgWriteText(W, "\"");
+    }
+    if (Style->DashOffset != Inherited->DashOffset) {
+        SvgWriteAttribute(W, " stroke-dashoffset", Style->DashOffset);
+    }
+}
+
+/*  Appends Svg as a document: the svg tag with the document style, then a tag per element with the
+    attributes that differ from it. The parser keeps no size or view box, so none is written. */
+void
+SvgWrite(svg_writer *W, svg *Svg)
+{
+    // note: the defaults SvgParse starts from
+    svg_stroke_style Default = {1.0f, SvgLineJoin_Miter, SvgLineCap_Butt, 4.0f, 0, 0, 0.0f};
+
+    SvgWriteText(W, "<svg xmlns=\"http://www.w3.org/2000/svg\"");
+    SvgWriteStyle(W, Svg, Svg->FillRule, Svg->Fill, Svg->Stroke, &Svg->StrokeStyle,
+                  SvgFillRule_NonZero, 0x000000ff, 0, &Default);
+    SvgWriteText(W, ">\n");
+
+    for (u32 i=0; i<Svg->Elements.Count; ++i) {
+        svg_element *E = Svg->Elements.Data + i;
+
+        if (E->Type == SvgElement_Path) {
+            SvgWriteText(W, "<path d=\"");
+            SvgWritePathData(W, SvgElementPath(Svg, E));
+            SvgWriteText(W, "\"");
+        } else if (E->Type == SvgElement_Rect) {
+            SvgWriteText(W, "<rect");
+            SvgWriteAttribute(W, " x", E->Rect.P.x);
+            SvgWriteAttribute(W, " y", E->Rect.P.y);
+            SvgWriteAttribute(W, " width", E->Rect.Dim.x);
+            SvgWriteAttribute(W, " height", E->Rect.Dim.y);
+        } else if (E->Type == SvgElement_Circle) {
+            SvgWriteText(W, "<circle");
+            SvgWriteAttribute(W, " cx", E->Circle.Center.x);
+            SvgWriteAttribute(W, " cy", E->Circle.Center.y);
+            SvgWriteAttribute(W, " r", E->Circle.R);
+        } else {
+            continue; // note: the other types have no geometry stored
+        }
+
+        SvgWriteStyle(W, Svg, E->FillRule, E->Fill, E->Stroke, &E->StrokeStyle,
+                      Svg->FillRule, Svg->Fill, Svg->Stroke, &Svg->StrokeStyle);
+        SvgWriteText(W, "/>\n");
+    }
+
+    SvgWriteText(W, "</svg>\n");
+}
+
+#endif // INCLUDE_GUARD_LS_SVG_WRITE
@@ -3,6 +3,8 @@
 #include "malloc.h"
 #include "assert.h"
 #include "stdarg.h"
+#include "math.h"
+#include "string.h"
 
 #define global_variable static
 #define internal static
@@ -22,9 +24,11 @@ typedef s32 b32;
 typedef float r32;
 typedef double r64;
 
+#define LS_SVG_LOG printf
 #define LS_STRING_IMPLEMENTATION
 #include "ls_string.h"
 #include "ls_svg.h"
+#include "ls_svg_hit.h"
 
 struct file {
     u8 *Data;
@@ -66,7 +70,8 @@ Svg()
     // svg Svg = ParseSvg("filename")
     svg Svg = SvgParse(SvgFile.Data, SvgFile.Size);
 
-    u32 a =4;
+    svg_element *Picked = SvgHitTest(&Svg, {32.0f, 4.0f});
+    printf("picked element %d\n", Picked ? (int)(Picked - Svg.Elements.Data) : -1);
 }
 
 // void